@@ -7,27 +7,38 @@
 #include "lwip/ip4_addr.h"
 #include "hardware/spi.h"
 #include "hardware/rtc.h"
+#include "hardware/sync.h"
 #include "hardware/clocks.h"
 
 #include "pico_display_gfx.hpp"
 #include "st73xx_font.hpp"
 #include "gfx_colors.hpp"
 #include "spi_config.hpp"
+#include "st73xx_fixed_trig.hpp"
+#include "st73xx_layer.hpp"
+#include "sntp_client.hpp"
+#include "civil_time.hpp"
 #include <cstdio>
 #include <cstring>
 #include <cmath>
-#include <time.h>
+
+// 显存静态分配，不占用堆（所在段可用 ST73XX_FRAMEBUFFER_SECTION 指定）
+ST73XX_DEFINE_FRAMEBUFFER(g_lcd_buffer, st7306::ST7306Driver);
+// 表盘背景缓存：表盘、装饰和状态文字只在这里绘制一次，每帧只恢复指针覆盖过的区域
+ST73XX_DEFINE_FRAMEBUFFER(g_dial_background, st7306::ST7306Driver);
 
 // WiFi配置
 #define WIFI_SSID "YANGTANG"
 #define WIFI_PASSWORD "1q2w3e4r!Q@W#E$R"
 
 // NTP配置
-#define NTP_SERVER "182.92.12.11" // 网易NTP服务器
-#define NTP_MSG_LEN 48
-#define NTP_PORT 123
-#define NTP_DELTA 2208988800 // 从1900年到1970年的秒数
-#define BEIJING_TIMEZONE_OFFSET (8 * 3600) // UTC+8
+// NTP服务器列表：每轮同时查询，采用延迟最小且最稳定的回复，单个服务器失效不影响对时
+static const char* const NTP_SERVERS[] = {
+    "182.92.12.11",      // 网易NTP服务器
+    "ntp.aliyun.com",
+    "ntp.tencent.com",
+    "cn.pool.ntp.org",
+};
 
 // 调试开关
 #define DEBUG_WIFI 1
@@ -73,15 +84,25 @@ namespace vintage_clock_config {
     constexpr uint8_t COLOR_DIAL_DARK = st7306::ST7306Driver::COLOR_BLACK;     // 0x03 - 最深色表盘
     constexpr uint8_t COLOR_DIAL_MEDIUM = st7306::ST7306Driver::COLOR_GRAY2;   // 0x02 - 中等灰度
     constexpr uint8_t COLOR_DIAL_LIGHT = st7306::ST7306Driver::COLOR_GRAY1;    // 0x01 - 浅灰色
-    constexpr uint8_t COLOR_HOUR_HAND = st7306::ST7306Driver::COLOR_BLACK;     // 0x03 - 时针黑色
-    constexpr uint8_t COLOR_MINUTE_HAND = st7306::ST7306Driver::COLOR_BLACK;   // 0x03 - 分针黑色
     constexpr uint8_t COLOR_SECOND_HAND = st7306::ST7306Driver::COLOR_GRAY2;   // 0x02 - 秒针中灰
     constexpr uint8_t COLOR_TEXT = st7306::ST7306Driver::COLOR_BLACK;          // 0x03 - 文字黑色
     
     // 数字标记位置（12, 3, 6, 9）
     constexpr int NUMBER_RADIUS = 90;      // 数字距离中心的半径
+
+    // 黑色的小时刻度、时针和分针为填充多边形：以原点为中心、指向 +x 定义，
+    // 绘制时用 Transform2D 旋转到对应角度并平移到表盘中心。
+    // 宽度与原来的粗线一致（扫描线填充上端含、下端不含，[-1,2) 覆盖3行）
+    constexpr int16_t HOUR_MARK_X[4] = {HOUR_MARK_INNER, HOUR_MARK_OUTER, HOUR_MARK_OUTER, HOUR_MARK_INNER};
+    constexpr int16_t HOUR_MARK_Y[4] = {-1, -1, 2, 2};    // 3像素
+    constexpr int16_t HOUR_HAND_X[4] = {0, HOUR_HAND_LENGTH, HOUR_HAND_LENGTH, 0};
+    constexpr int16_t HOUR_HAND_Y[4] = {-3, -3, 4, 4};    // 7像素
+    constexpr int16_t MINUTE_HAND_X[4] = {0, MINUTE_HAND_LENGTH, MINUTE_HAND_LENGTH, 0};
+    constexpr int16_t MINUTE_HAND_Y[4] = {-2, -2, 3, 3};  // 5像素
 }
 
+using ClockGfx = pico_gfx::PicoDisplayGFX<st7306::ST7306Driver>;
+
 // 时间结构体
 struct ClockTime {
     int hours;
@@ -105,8 +126,17 @@ const char* month_short[12] = {
 };
 
 // 全局变量
-static volatile bool ntp_response_received = false;
-static volatile time_t ntp_time = 0;
+// 本地时钟（UTC，带频率修正）与非阻塞SNTP客户端
+// 未同步时从模拟时间 2024-01-01 12:00:00（北京时间，星期一）开始走
+static constexpr const net::TimeZone& LOCAL_TIME_ZONE = net::TZ_ASIA_SHANGHAI;  // UTC+8，无夏令时
+static constexpr int64_t SIM_START_EPOCH = 1704110400 - LOCAL_TIME_ZONE.std_offset_s;
+static net::DisciplinedClock g_clock;
+static net::SntpClient g_sntp(g_clock);
+// 本地日历时间：每秒增量进位，不调用 localtime()
+static net::CivilClock g_civil(LOCAL_TIME_ZONE);
+static bool ntp_round_active = false;
+// 秒边界闹钟：定时器中断置位，主循环消费
+static volatile bool second_tick = false;
 static bool time_synced = false;
 static bool wifi_connected = false;
 static int wifi_connect_attempts = 0;
@@ -143,157 +173,68 @@ void led_update() {
     }
 }
 
-// NTP回调函数
-static void ntp_recv(void *arg, struct udp_pcb *pcb, struct pbuf *p, const ip_addr_t *addr, u16_t port) {
-    NTP_DEBUG("收到NTP回复，长度: %d", p->len);
-    
-    if (p->len < NTP_MSG_LEN) {
-        NTP_DEBUG("NTP包长度不足: %d < %d", p->len, NTP_MSG_LEN);
-        pbuf_free(p);
-        return;
-    }
-    
-    uint8_t mode = pbuf_get_at(p, 0) & 0x7;
-    uint8_t stratum = pbuf_get_at(p, 1);
-    
-    NTP_DEBUG("NTP模式: %d, 层级: %d", mode, stratum);
-    
-    if (mode == 4 && stratum > 0) { // 服务器回复
-        uint32_t seconds_buf[4];
-        pbuf_copy_partial(p, seconds_buf, 16, 40);
-        uint32_t seconds_since_1900 = lwip_ntohl(seconds_buf[0]);
-        ntp_time = seconds_since_1900 - NTP_DELTA + BEIJING_TIMEZONE_OFFSET;
-        ntp_response_received = true;
-        NTP_DEBUG("NTP时间同步成功: %lu (原始: %lu)", (unsigned long)ntp_time, (unsigned long)seconds_since_1900);
-        
-        // 显示时间信息
-        time_t local_time = ntp_time;  // 复制到非volatile变量
-        struct tm *tm_info = localtime(&local_time);
-        printf("同步时间: %04d-%02d-%02d %02d:%02d:%02d (北京时间)\n", 
-               tm_info->tm_year + 1900, tm_info->tm_mon + 1, tm_info->tm_mday,
-               tm_info->tm_hour, tm_info->tm_min, tm_info->tm_sec);
-    } else {
-        NTP_DEBUG("无效的NTP回复: mode=%d, stratum=%d", mode, stratum);
-    }
-    
-    pbuf_free(p);
-}
-
-// DNS回调函数
-static void ntp_dns_found(const char *hostname, const ip_addr_t *ipaddr, void *arg) {
-    if (ipaddr) {
-        NTP_DEBUG("DNS解析成功: %s -> %s", hostname, ip4addr_ntoa(ipaddr));
-        
-        struct udp_pcb *pcb = udp_new_ip_type(IPADDR_TYPE_ANY);
-        if (pcb != NULL) {
-            NTP_DEBUG("创建UDP PCB成功");
-            udp_recv(pcb, ntp_recv, NULL);
-            
-            struct pbuf *p = pbuf_alloc(PBUF_TRANSPORT, NTP_MSG_LEN, PBUF_RAM);
-            if (p != NULL) {
-                uint8_t *req = (uint8_t*)p->payload;
-                memset(req, 0, NTP_MSG_LEN);
-                req[0] = 0x1b; // LI, VN, Mode
-                
-                NTP_DEBUG("发送NTP请求到 %s:%d", ip4addr_ntoa(ipaddr), NTP_PORT);
-                err_t err = udp_sendto(pcb, p, ipaddr, NTP_PORT);
-                if (err == ERR_OK) {
-                    NTP_DEBUG("NTP请求发送成功");
-                } else {
-                    NTP_DEBUG("NTP请求发送失败: 错误码 %d", err);
-                }
-                pbuf_free(p);
-            } else {
-                NTP_DEBUG("分配NTP请求缓冲区失败");
-            }
-        } else {
-            NTP_DEBUG("创建UDP PCB失败");
-        }
-    } else {
-        NTP_DEBUG("DNS解析失败: %s", hostname);
-    }
-}
-
-// 同步NTP时间 - 简化版本，参考AsyncDNSServer_RP2040W
-bool sync_ntp_time() {
+// 发起一轮NTP对时（立即返回，结果由 poll_ntp_sync() 取得）
+bool start_ntp_sync() {
     ntp_sync_attempts++;
     printf("\n=== 开始NTP时间同步 (尝试 %d) ===\n", ntp_sync_attempts);
-    NTP_DEBUG("目标NTP服务器: %s", NTP_SERVER);
-    
-    // 开始LED闪烁指示NTP同步
-    led_set_blinking(true);
+    NTP_DEBUG("查询 %d 个NTP服务器", g_sntp.serverCount());
     
     if (!wifi_connected) {
         printf("❌ WiFi未连接，无法同步NTP\n");
         return false;
     }
     
-    ntp_response_received = false;
-    
     // 确保网络栈就绪
-    printf("检查网络连接状态...\n");
     if (!netif_list || netif_list->ip_addr.addr == 0) {
         printf("❌ 网络接口未就绪\n");
         return false;
     }
     
-    // 检查是否是IP地址，如果是则直接使用，否则进行DNS解析
-    ip_addr_t ntp_server_addr;
-    if (ip4addr_aton(NTP_SERVER, &ntp_server_addr)) {
-        // 是IP地址，直接使用
-        printf("使用IP地址直接连接NTP服务器: %s\n", NTP_SERVER);
-        NTP_DEBUG("直接使用IP地址: %s", NTP_SERVER);
-        ntp_dns_found(NTP_SERVER, &ntp_server_addr, NULL);
-    } else {
-        // 不是IP地址，需要DNS解析
-        printf("需要DNS解析，查询域名: %s\n", NTP_SERVER);
-        err_t err = dns_gethostbyname(NTP_SERVER, NULL, ntp_dns_found, NULL);
-        NTP_DEBUG("DNS查询返回: %d", err);
-        
-        if (err == ERR_OK) {
-            NTP_DEBUG("DNS缓存命中，立即获取结果");
-        } else if (err == ERR_INPROGRESS) {
-            NTP_DEBUG("DNS查询进行中，等待结果...");
-        } else {
-            NTP_DEBUG("DNS查询立即失败: %d", err);
-            printf("❌ DNS查询失败\n");
-            return false;
-        }
+    if (!g_sntp.start()) {
+        printf("❌ NTP请求发起失败\n");
+        return false;
     }
     
-    // 等待NTP响应
-    printf("等待NTP服务器响应（15秒超时）...\n");
-    uint32_t start_wait = to_ms_since_boot(get_absolute_time());
-    uint32_t last_status_print = start_wait;
-    
-    while (!ntp_response_received && (to_ms_since_boot(get_absolute_time()) - start_wait) < 15000) {
-        cyw43_arch_poll();
-        led_update(); // 更新LED闪烁
-        
-        // 每2秒打印一次状态
-        uint32_t current_time = to_ms_since_boot(get_absolute_time());
-        if (current_time - last_status_print >= 2000) {
-            uint32_t elapsed = (current_time - start_wait) / 1000;
-            printf("等待NTP响应... %lu/15秒\n", elapsed);
-            last_status_print = current_time;
-        }
-        
-        sleep_ms(50);
-    }
+    // 开始LED闪烁指示NTP同步
+    led_set_blinking(true);
+    ntp_round_active = true;
+    return true;
+}
+
+// 推进NTP状态机（不阻塞）；本轮刚结束时返回 true，结果见 g_sntp.state()
+bool poll_ntp_sync() {
+    if (!ntp_round_active) return false;
+    g_sntp.poll();
+    led_update();
+    if (g_sntp.busy()) return false;
     
-    if (ntp_response_received) {
-        printf("✅ NTP时间同步成功\n");
-        NTP_DEBUG("NTP同步成功");
-        // NTP同步成功，停止LED闪烁
-        led_set_blinking(false);
-        return true;
+    ntp_round_active = false;
+    led_set_blinking(false);
+    if (g_sntp.state() == net::SntpClient::State::Done) {
+        const net::SntpSample& sample = g_sntp.lastSample();
+        printf("✅ NTP时间同步成功: 采用 %s, 偏移 %lld us, 往返延迟 %lld us, 层级 %d, 频率修正 %ld ppb\n",
+               g_sntp.server(g_sntp.selectedServer()).host,
+               (long long)sample.offset_us, (long long)sample.delay_us, sample.stratum,
+               (long)g_clock.driftPpb());
     } else {
-        printf("❌ NTP同步超时（15秒）\n");
-        NTP_DEBUG("NTP同步超时");
-        // NTP同步失败，停止LED闪烁
-        led_set_blinking(false);
-        return false;
+        printf("❌ NTP同步失败（所有服务器均无有效回复）\n");
     }
+    for (uint8_t i = 0; i < g_sntp.serverCount(); i++) {
+        const net::SntpServerStats& st = g_sntp.server(i);
+        NTP_DEBUG("  %-16s 可达 0x%02x, 平均延迟 %lld us, 抖动 %lld us", st.host, st.reach,
+                  (long long)st.delay_avg_us, (long long)st.jitter_us);
+    }
+    return true;
+}
+
+// 启动阶段的首次对时：此时还没有表盘可刷新，等待本轮结束（期间照常处理网络事件）
+bool sync_ntp_time_at_startup() {
+    if (!start_ntp_sync()) return false;
+    while (!poll_ntp_sync()) {
+        cyw43_arch_poll();
+        cyw43_arch_wait_for_work_until(make_timeout_time_ms(50));
+    }
+    return g_sntp.state() == net::SntpClient::State::Done;
 }
 
 // 显示WiFi状态
@@ -449,57 +390,55 @@ bool connect_wifi() {
     return false;
 }
 
-// 获取当前时间
+// 获取当前时间（NTP同步后为北京时间，否则为模拟时间）
 ClockTime getCurrentTime() {
-    ClockTime time = {12, 0, 0, 1, 1, 2024, 1}; // 默认时间
-    
-    if (time_synced && ntp_time > 0) {
-        // 使用同步的NTP时间
-        time_t current_time = ntp_time + (to_ms_since_boot(get_absolute_time()) / 1000);
-        struct tm *tm_info = localtime(&current_time);
-        
-        time.hours = tm_info->tm_hour;
-        time.minutes = tm_info->tm_min;
-        time.seconds = tm_info->tm_sec;
-        time.day = tm_info->tm_mday;
-        time.month = tm_info->tm_mon + 1;
-        time.year = tm_info->tm_year + 1900;
-        time.weekday = tm_info->tm_wday;
-    } else {
-        // 使用模拟时间（向前移动）
-        static uint32_t last_update = 0;
-        static ClockTime sim_time = {12, 0, 0, 1, 1, 2024, 1};
-        
-        uint32_t current_ms = to_ms_since_boot(get_absolute_time());
-        if (current_ms - last_update >= 1000) {
-            sim_time.seconds++;
-            if (sim_time.seconds >= 60) {
-                sim_time.seconds = 0;
-                sim_time.minutes++;
-                if (sim_time.minutes >= 60) {
-                    sim_time.minutes = 0;
-                    sim_time.hours++;
-                    if (sim_time.hours >= 24) {
-                        sim_time.hours = 0;
-                        sim_time.day++;
-                        sim_time.weekday = (sim_time.weekday + 1) % 7;
-                        if (sim_time.day > 31) {
-                            sim_time.day = 1;
-                            sim_time.month++;
-                            if (sim_time.month > 12) {
-                                sim_time.month = 1;
-                                sim_time.year++;
-                            }
-                        }
-                    }
-                }
+    int64_t now_us = g_clock.nowUs();
+    g_civil.advanceTo(now_us >= 0 ? now_us / 1000000 : (now_us - 999999) / 1000000);
+    const net::CivilTime& local = g_civil.local();
+    
+    ClockTime time;
+    time.hours = local.hour;
+    time.minutes = local.minute;
+    time.seconds = local.second;
+    time.day = local.day;
+    time.month = local.month;
+    time.year = local.year;
+    time.weekday = local.weekday;
+    return time;
+}
+
+// 下一个整秒对应的开机时间
+absolute_time_t nextSecondBoundary() {
+    int64_t next = (g_clock.nowUs() / 1000000 + 1) * 1000000;
+    return from_us_since_boot(g_clock.toBootUs(next));
+}
+
+// 定时器闹钟回调（中断上下文）：只置位标志，单次触发
+static int64_t on_second_alarm(alarm_id_t id, void *user_data) {
+    second_tick = true;
+    return 0;
+}
+
+// 休眠直到秒边界闹钟触发
+// 无WiFi时直接 __wfi；关中断后再检查标志，避免标志在检查与 __wfi 之间置位导致睡过头
+// （PRIMASK 置位时挂起的中断仍能唤醒 __wfi）。
+// 有WiFi时（poll模式）需要处理CYW43的事件，用 cyw43_arch_wait_for_work_until 休眠到有事件或闹钟。
+void waitForSecondTick(absolute_time_t deadline) {
+    while (!second_tick) {
+        if (wifi_connected) {
+            cyw43_arch_poll();
+            if (!second_tick) {
+                cyw43_arch_wait_for_work_until(deadline);
+            }
+        } else {
+            uint32_t irq_state = save_and_disable_interrupts();
+            if (!second_tick) {
+                __wfi();
             }
-            last_update = current_ms;
+            restore_interrupts(irq_state);
         }
-        time = sim_time;
     }
-    
-    return time;
+    second_tick = false;
 }
 
 // 绘制线条（简化版）
@@ -529,17 +468,16 @@ void drawLine(st7306::ST7306Driver& display, int x0, int y0, int x1, int y1, uin
     }
 }
 
-// 绘制厚线条（用于指针）
-void drawThickLine(st7306::ST7306Driver& display, int x0, int y0, int x1, int y1, int thickness, uint8_t color) {
-    // 绘制中心线
-    drawLine(display, x0, y0, x1, y1, color);
-    
-    // 绘制周围的线条来增加厚度
-    for (int t = 1; t <= thickness/2; t++) {
-        drawLine(display, x0 + t, y0, x1 + t, y1, color);
-        drawLine(display, x0 - t, y0, x1 - t, y1, color);
-        drawLine(display, x0, y0 + t, x1, y1 + t, color);
-        drawLine(display, x0, y0 - t, x1, y1 - t, color);
+// 把以原点为中心的多边形旋转到 angle 并移到表盘中心后填充，覆盖区域并入 dirty
+void drawRotatedShape(ClockGfx& gfx, const int16_t* x, const int16_t* y, uint8_t count,
+                      st73xx::Angle angle, st73xx::DirtyRect* dirty = nullptr) {
+    using namespace vintage_clock_config;
+    if (count > 4) return;
+    int16_t px[4], py[4];
+    st73xx::Transform2D(angle, CLOCK_CENTER_X, CLOCK_CENTER_Y).apply(x, y, px, py, count);
+    gfx.drawFilledPolygon(px, py, count, BLACK);
+    if (dirty) {
+        for (uint8_t i = 0; i < count; i++) dirty->addPoint(px[i], py[i], 1);
     }
 }
 
@@ -582,7 +520,7 @@ void drawFilledCircle(st7306::ST7306Driver& display, int cx, int cy, int radius,
 }
 
 // 绘制复古表盘
-void drawVintageDial(st7306::ST7306Driver& display) {
+void drawVintageDial(st7306::ST7306Driver& display, ClockGfx& gfx) {
     using namespace vintage_clock_config;
     
     // 绘制外圈
@@ -592,41 +530,30 @@ void drawVintageDial(st7306::ST7306Driver& display) {
     // 绘制内圈
     drawCircle(display, CLOCK_CENTER_X, CLOCK_CENTER_Y, INNER_RADIUS, COLOR_DIAL_MEDIUM);
     
-    // 绘制小时刻度（12个）
+    // 绘制小时刻度（12个），角度为定点单位，12点方向为 -90°
     for (int i = 0; i < 12; i++) {
-        float angle = i * M_PI / 6.0f - M_PI / 2.0f; // 从12点开始
-        
-        // 小时刻度线（粗线）
-        int x1 = CLOCK_CENTER_X + HOUR_MARK_INNER * cos(angle);
-        int y1 = CLOCK_CENTER_Y + HOUR_MARK_INNER * sin(angle);
-        int x2 = CLOCK_CENTER_X + HOUR_MARK_OUTER * cos(angle);
-        int y2 = CLOCK_CENTER_Y + HOUR_MARK_OUTER * sin(angle);
-        
-        // 绘制粗小时刻度
-        drawThickLine(display, x1, y1, x2, y2, 3, COLOR_DIAL_DARK);
+        st73xx::Angle angle = st73xx::angleFromTurns(i, 12) - st73xx::ANGLE_QUARTER;
+        drawRotatedShape(gfx, HOUR_MARK_X, HOUR_MARK_Y, 4, angle);
     }
     
     // 绘制分钟刻度（60个，跳过小时位置）
     for (int i = 0; i < 60; i++) {
         if (i % 5 != 0) { // 跳过小时刻度位置
-            float angle = i * M_PI / 30.0f - M_PI / 2.0f;
-            
-            int x1 = CLOCK_CENTER_X + MINUTE_MARK_INNER * cos(angle);
-            int y1 = CLOCK_CENTER_Y + MINUTE_MARK_INNER * sin(angle);
-            int x2 = CLOCK_CENTER_X + MINUTE_MARK_OUTER * cos(angle);
-            int y2 = CLOCK_CENTER_Y + MINUTE_MARK_OUTER * sin(angle);
-            
-            drawLine(display, x1, y1, x2, y2, COLOR_DIAL_LIGHT);
+            st73xx::Angle angle = st73xx::angleFromTurns(i, 60) - st73xx::ANGLE_QUARTER;
+            gfx.drawRadialLineGray(CLOCK_CENTER_X, CLOCK_CENTER_Y, MINUTE_MARK_INNER, MINUTE_MARK_OUTER, angle,
+                                   COLOR_DIAL_LIGHT);
         }
     }
     
     // 绘制数字标记（12, 3, 6, 9）
     const char* numbers[4] = {"12", "3", "6", "9"};
-    const float number_angles[4] = {-M_PI/2, 0, M_PI/2, M_PI}; // 12, 3, 6, 9点位置
+    const st73xx::Angle number_angles[4] = {
+        st73xx::angleFromDegrees(-90), 0, st73xx::angleFromDegrees(90), st73xx::angleFromDegrees(180)
+    }; // 12, 3, 6, 9点位置
     
     for (int i = 0; i < 4; i++) {
-        int x = CLOCK_CENTER_X + NUMBER_RADIUS * cos(number_angles[i]);
-        int y = CLOCK_CENTER_Y + NUMBER_RADIUS * sin(number_angles[i]);
+        int32_t x, y;
+        st73xx::polarToCartesian(CLOCK_CENTER_X, CLOCK_CENTER_Y, NUMBER_RADIUS, number_angles[i], x, y);
         
         // 调整数字位置以居中
         int str_width = strlen(numbers[i]) * 8; // 8是字符宽度
@@ -640,36 +567,35 @@ void drawVintageDial(st7306::ST7306Driver& display) {
     }
 }
 
-// 绘制时钟指针
-void drawClockHands(st7306::ST7306Driver& display, const ClockTime& time) {
+// 绘制时钟指针，返回本次绘制覆盖的区域（下一帧从背景恢复）
+st73xx::DirtyRect drawClockHands(st7306::ST7306Driver& display, ClockGfx& gfx, const ClockTime& time) {
     using namespace vintage_clock_config;
     
-    // 计算角度（从12点开始，顺时针）
-    float hour_angle = ((time.hours % 12) + time.minutes / 60.0f) * M_PI / 6.0f - M_PI / 2.0f;
-    float minute_angle = time.minutes * M_PI / 30.0f - M_PI / 2.0f;
-    float second_angle = time.seconds * M_PI / 30.0f - M_PI / 2.0f;
-    
-    // 计算指针终点
-    int hour_x = CLOCK_CENTER_X + HOUR_HAND_LENGTH * cos(hour_angle);
-    int hour_y = CLOCK_CENTER_Y + HOUR_HAND_LENGTH * sin(hour_angle);
-    
-    int minute_x = CLOCK_CENTER_X + MINUTE_HAND_LENGTH * cos(minute_angle);
-    int minute_y = CLOCK_CENTER_Y + MINUTE_HAND_LENGTH * sin(minute_angle);
-    
-    int second_x = CLOCK_CENTER_X + SECOND_HAND_LENGTH * cos(second_angle);
-    int second_y = CLOCK_CENTER_Y + SECOND_HAND_LENGTH * sin(second_angle);
-    
-    // 绘制时针（最粗）
-    drawThickLine(display, CLOCK_CENTER_X, CLOCK_CENTER_Y, hour_x, hour_y, 6, COLOR_HOUR_HAND);
-    
-    // 绘制分针（中等粗细）
-    drawThickLine(display, CLOCK_CENTER_X, CLOCK_CENTER_Y, minute_x, minute_y, 4, COLOR_MINUTE_HAND);
-    
-    // 绘制秒针（最细）
-    drawThickLine(display, CLOCK_CENTER_X, CLOCK_CENTER_Y, second_x, second_y, 2, COLOR_SECOND_HAND);
+    // 计算角度（从12点开始，顺时针），定点角度单位，不使用软浮点
+    st73xx::Angle hour_angle = st73xx::angleFromTurns((time.hours % 12) * 60 + time.minutes, 12 * 60) - st73xx::ANGLE_QUARTER;
+    st73xx::Angle minute_angle = st73xx::angleFromTurns(time.minutes, 60) - st73xx::ANGLE_QUARTER;
+    st73xx::Angle second_angle = st73xx::angleFromTurns(time.seconds, 60) - st73xx::ANGLE_QUARTER;
     
+    st73xx::DirtyRect dirty;
+    dirty.addPoint(CLOCK_CENTER_X, CLOCK_CENTER_Y, CENTER_DOT_RADIUS);
+
+    // 时针、分针为填充多边形
+    drawRotatedShape(gfx, HOUR_HAND_X, HOUR_HAND_Y, 4, hour_angle, &dirty);
+    drawRotatedShape(gfx, MINUTE_HAND_X, MINUTE_HAND_Y, 4, minute_angle, &dirty);
+
+    // 秒针为灰色：中心线加上下左右各偏移1像素的四条线，与原来2像素粗线相同
+    static constexpr int8_t SECOND_OFFSETS[5][2] = {{0, 0}, {1, 0}, {-1, 0}, {0, 1}, {0, -1}};
+    for (const auto& o : SECOND_OFFSETS) {
+        gfx.drawRadialLineGray(CLOCK_CENTER_X + o[0], CLOCK_CENTER_Y + o[1], 0, SECOND_HAND_LENGTH, second_angle,
+                               COLOR_SECOND_HAND);
+    }
+    int32_t tip_x, tip_y;
+    st73xx::polarToCartesian(CLOCK_CENTER_X, CLOCK_CENTER_Y, SECOND_HAND_LENGTH, second_angle, tip_x, tip_y);
+    dirty.addPoint(tip_x, tip_y, 1);
+
     // 绘制中心圆点
     drawFilledCircle(display, CLOCK_CENTER_X, CLOCK_CENTER_Y, CENTER_DOT_RADIUS, COLOR_DIAL_DARK);
+    return dirty;
 }
 
 // 绘制状态信息
@@ -711,8 +637,39 @@ void drawDecorations(st7306::ST7306Driver& display) {
     drawLine(display, CLOCK_CENTER_X - 40, line_y + 3, CLOCK_CENTER_X + 40, line_y + 3, COLOR_DIAL_LIGHT);
 }
 
+// 背景内容随日期、星期和连接/同步状态变化，变化时重新绘制背景
+struct BackgroundKey {
+    int year;
+    int month;
+    int day;
+    int weekday;
+    bool wifi;
+    bool synced;
+
+    bool operator==(const BackgroundKey& other) const {
+        return year == other.year && month == other.month && day == other.day &&
+               weekday == other.weekday && wifi == other.wifi && synced == other.synced;
+    }
+};
+
+BackgroundKey backgroundKeyFor(const ClockTime& time) {
+    return BackgroundKey{time.year, time.month, time.day, time.weekday, wifi_connected, time_synced};
+}
+
+// 绘制整个静态背景并保存到背景缓存
+void renderBackground(st7306::ST7306Driver& display, ClockGfx& gfx, const ClockTime& time,
+                      st73xx::BackgroundLayer<st7306::ST7306Driver::Packing>& background) {
+    display.clearDisplay();
+    display.fill(vintage_clock_config::COLOR_BACKGROUND);
+    drawVintageDial(display, gfx);
+    drawDecorations(display);
+    drawStatusInfo(display, time);
+    background.capture(display.framebuffer(), g_dial_background);
+}
+
 int main() {
     stdio_init_all();
+    g_clock.setUnixUs(SIM_START_EPOCH * 1000000);
     
     // 首先确保串口输出正常
     printf("\n");
@@ -721,8 +678,10 @@ int main() {
     printf("=====================================\n");
     printf("编译时间: %s %s\n", __DATE__, __TIME__);
     printf("WiFi网络: %s\n", WIFI_SSID);
-    printf("NTP服务器: %s\n", NTP_SERVER);
-    printf("时区设置: UTC+8 (北京时间)\n");
+    for (const char* server : NTP_SERVERS) {
+        printf("NTP服务器: %s\n", server);
+    }
+    printf("时区设置: %s (UTC%+ld)\n", LOCAL_TIME_ZONE.name, (long)(LOCAL_TIME_ZONE.std_offset_s / 3600));
     printf("=====================================\n\n");
 
     // 添加启动延时，确保串口稳定
@@ -737,8 +696,8 @@ int main() {
     
     // 初始化显示器
     printf("- 初始化ST7306显示器...\n");
-    st7306::ST7306Driver display(PIN_DC, PIN_RST, PIN_CS, PIN_SCLK, PIN_SDIN);
-    pico_gfx::PicoDisplayGFX<st7306::ST7306Driver> gfx(display, st7306::ST7306Driver::LCD_WIDTH, st7306::ST7306Driver::LCD_HEIGHT);
+    st7306::ST7306Driver display(PIN_DC, PIN_RST, PIN_CS, PIN_SCLK, PIN_SDIN, g_lcd_buffer);
+    ClockGfx gfx(display, st7306::ST7306Driver::LCD_WIDTH, st7306::ST7306Driver::LCD_HEIGHT);
 
     display.initialize();
     printf("  ✅ 显示器初始化完成\n");
@@ -789,9 +748,13 @@ int main() {
         display.drawString(60, 200, "Syncing Time...", true);
         display.display();
         
-        // 同步NTP时间（也添加超时保护）
-        printf("开始NTP同步（最多等待30秒）...\n");
-        bool ntp_success = sync_ntp_time();
+        // 同步NTP时间（每次请求2秒超时，最多4次）
+        printf("开始NTP同步...\n");
+        g_sntp.begin();
+        for (const char* server : NTP_SERVERS) {
+            g_sntp.addServer(server);
+        }
+        bool ntp_success = sync_ntp_time_at_startup();
         
         if (ntp_success) {
             time_synced = true;
@@ -829,41 +792,66 @@ int main() {
     printf("时间同步: %s\n", time_synced ? "NTP同步" : "模拟时间");
     printf("==============================\n\n");
 
-    // 主时钟循环
-    uint32_t last_display_update = 0;
+    // 主时钟循环：事件驱动
+    // 定时器闹钟在每个整秒唤醒CPU，重绘并刷新一次后继续休眠，内容每秒只变化一次
+    // NTP对时在后台进行：发起请求后立即返回，回复在休眠等待时由 cyw43_arch_poll() 处理
     uint32_t last_ntp_sync = 0;
-    uint32_t last_status_print = 0;
+    uint32_t last_ntp_attempt = to_ms_since_boot(get_absolute_time());
     
     // 如果首次NTP同步成功，记录当前时间作为上次同步时间
     if (time_synced) {
-        last_ntp_sync = to_ms_since_boot(get_absolute_time());
+        last_ntp_sync = last_ntp_attempt;
         printf("📝 记录首次NTP同步时间: %lu ms\n", last_ntp_sync);
     }
-    const uint32_t DISPLAY_UPDATE_INTERVAL = 100; // 10 FPS刷新率
     const uint32_t NTP_SYNC_INTERVAL = 43200000; // 每12小时同步一次（43200秒）
-    const uint32_t STATUS_PRINT_INTERVAL = 5000; // 每5秒打印一次状态
-    
+    const uint32_t NTP_RETRY_INTERVAL = 300000;  // 失败或尚未同步时每5分钟重试
+    const int STATUS_PRINT_INTERVAL = 5;         // 每5秒打印一次状态
+    
+    // 表盘背景缓存（屏幕方向为0，逻辑坐标即显存物理坐标）
+    st73xx::BackgroundLayer<st7306::ST7306Driver::Packing> background;
+    BackgroundKey background_key{};
+    st73xx::DirtyRect hands_dirty;
+
+    // CPU占用统计：唤醒后到再次休眠之间的时间
+    uint64_t busy_us = 0;
+    uint64_t window_start_us = time_us_64();
+
+    // 绘制一帧：背景变化时重绘整个背景，否则只恢复上一帧指针覆盖过的区域
+    auto render_frame = [&](const ClockTime& time) {
+        BackgroundKey key = backgroundKeyFor(time);
+        if (!background.valid() || !(key == background_key)) {
+            // 日期或状态变化：重新绘制整个背景（每天约一次）
+            renderBackground(display, gfx, time, background);
+            background_key = key;
+        } else {
+            background.restore(display.framebuffer(), hands_dirty);
+        }
+        
+        // 绘制指针并记录覆盖区域，刷新一次
+        hands_dirty = drawClockHands(display, gfx, time);
+        display.display();
+    };
+
     printf("进入主循环...\n");
-    int loop_count = 0;
+    // 进入循环前立即绘制第一帧，之后每一帧都由秒边界闹钟驱动
+    render_frame(getCurrentTime());
     
     while (true) {
+        absolute_time_t next_tick = nextSecondBoundary();
+        add_alarm_at(next_tick, on_second_alarm, NULL, true);
+        waitForSecondTick(next_tick);
+        uint64_t wake_us = time_us_64();
         uint32_t current_ms = to_ms_since_boot(get_absolute_time());
-        loop_count++;
-        
-        // 每1000次循环打印一次心跳
-        if (loop_count % 1000 == 0) {
-            printf("主循环心跳: %d (运行时间: %lu ms)\n", loop_count, current_ms);
-        }
         
-        // 处理WiFi轮询（poll模式）
-        if (wifi_connected) {
-            cyw43_arch_poll();
-        }
+        ClockTime current_time = getCurrentTime();
+        render_frame(current_time);
         
         // 定期打印状态
-        if (current_ms - last_status_print >= STATUS_PRINT_INTERVAL) {
-            last_status_print = current_ms;
-            ClockTime current_time = getCurrentTime();
+        if (current_time.seconds % STATUS_PRINT_INTERVAL == 0) {
+            uint64_t window_us = wake_us - window_start_us;
+            uint32_t duty_permille = window_us ? static_cast<uint32_t>(busy_us * 1000 / window_us) : 0;
+            busy_us = 0;
+            window_start_us = wake_us;
             
             // 计算距离下次NTP同步的时间
             if (time_synced && last_ntp_sync > 0) {
@@ -872,59 +860,42 @@ int main() {
                 uint32_t remaining_hours = remaining_ms / (1000 * 3600);
                 uint32_t remaining_minutes = (remaining_ms % (1000 * 3600)) / (1000 * 60);
                 
-                printf("时钟状态: %02d:%02d:%02d, WiFi: %s, 同步: %s, 下次NTP同步: %lu小时%lu分钟后\n", 
+                printf("时钟状态: %02d:%02d:%02d, WiFi: %s, 同步: %s, CPU: %lu.%lu%%, 下次NTP同步: %lu小时%lu分钟后\n", 
                        current_time.hours, current_time.minutes, current_time.seconds,
                        wifi_connected ? "连接" : "断开",
                        time_synced ? "NTP" : "模拟",
+                       duty_permille / 10, duty_permille % 10,
                        remaining_hours, remaining_minutes);
             } else {
-                printf("时钟状态: %02d:%02d:%02d, WiFi: %s, 同步: %s\n", 
+                printf("时钟状态: %02d:%02d:%02d, WiFi: %s, 同步: %s, CPU: %lu.%lu%%\n", 
                        current_time.hours, current_time.minutes, current_time.seconds,
                        wifi_connected ? "连接" : "断开",
-                       time_synced ? "NTP" : "模拟");
+                       time_synced ? "NTP" : "模拟",
+                       duty_permille / 10, duty_permille % 10);
             }
         }
         
-        // 定期重新同步NTP时间
-        if (wifi_connected && time_synced && (current_ms - last_ntp_sync >= NTP_SYNC_INTERVAL)) {
-            uint32_t elapsed_hours = (current_ms - last_ntp_sync) / (1000 * 3600);
-            printf("\n⏰ 到达定期同步时间 (已过 %lu 小时)，重新同步NTP时间...\n", elapsed_hours);
-            if (sync_ntp_time()) {
-                last_ntp_sync = current_ms;
-                printf("✅ NTP时间重新同步成功，下次同步将在12小时后\n\n");
-            } else {
-                printf("❌ NTP重新同步失败，将在下个周期重试\n\n");
+        // 定期重新同步NTP时间（只推进状态机，不等待网络）
+        if (wifi_connected) {
+            if (poll_ntp_sync()) {
+                if (g_sntp.state() == net::SntpClient::State::Done) {
+                    time_synced = true;
+                    last_ntp_sync = current_ms;
+                    printf("下次同步将在12小时后\n\n");
+                } else {
+                    printf("将在5分钟后重试\n\n");
+                }
+            }
+            bool due = time_synced ? (current_ms - last_ntp_sync >= NTP_SYNC_INTERVAL)
+                                   : (current_ms - last_ntp_attempt >= NTP_RETRY_INTERVAL);
+            if (!ntp_round_active && due && current_ms - last_ntp_attempt >= NTP_RETRY_INTERVAL) {
+                last_ntp_attempt = current_ms;
+                printf("\n⏰ 到达同步时间，后台重新同步NTP时间...\n");
+                start_ntp_sync();
             }
         }
         
-        // 控制显示刷新率
-        if (current_ms - last_display_update >= DISPLAY_UPDATE_INTERVAL) {
-            last_display_update = current_ms;
-            
-            ClockTime current_time = getCurrentTime();
-            
-            // 清屏
-            display.clearDisplay();
-            display.fill(vintage_clock_config::COLOR_BACKGROUND);
-            
-            // 绘制表盘
-            drawVintageDial(display);
-            
-            // 绘制装饰元素
-            drawDecorations(display);
-            
-            // 绘制指针
-            drawClockHands(display, current_time);
-            
-            // 绘制状态和日期信息
-            drawStatusInfo(display, current_time);
-            
-            // 更新显示
-            display.display();
-        }
-        
-        // 短暂延时
-        sleep_ms(50);
+        busy_us += time_us_64() - wake_us;
     }
     
     return 0;
@@ -0,0 +1,84 @@
+// 帧缓冲服务器示例：主机通过WiFi把ST7306原生打包的整帧、矩形或差分帧推到屏上；
+// 同时监听USB串口（stdio），开发时也可以直接从USB推屏
+// 主机端：tools/fb_stream_client.cpp（实测帧率）、tools/fb_stream_sim.cpp（仿真网络）
+#include "st7306_driver.hpp"
+#include "spi_config.hpp"
+#include "framebuffer_server.hpp"
+#include "fb_stream_stdio.hpp"
+#include "st73xx_trace.hpp"
+#include "pico/stdlib.h"
+#include "pico/cyw43_arch.h"
+#include "lwip/netif.h"
+#include <cstdio>
+
+#define WIFI_SSID "YANGTANG"
+#define WIFI_PASSWORD "1q2w3e4r!Q@W#E$R"
+
+// 1: TCP（可靠，消息可跨分段）；0: UDP（每个数据报一条行带消息，延迟更低）
+#define FB_SERVER_USE_TCP 0
+
+ST73XX_DEFINE_FRAMEBUFFER(g_lcd_buffer, st7306::ST7306Driver);
+
+int main() {
+    stdio_init_all();
+
+    st7306::ST7306Driver display(PIN_DC, PIN_RST, PIN_CS, PIN_SCLK, PIN_SDIN, g_lcd_buffer);
+    display.initialize();
+    display.clear();
+    display.drawString(10, 10, "Connecting WiFi...", true);
+    display.display();
+
+    if (cyw43_arch_init() != 0) {
+        printf("cyw43_arch_init 失败\n");
+        return 1;
+    }
+    cyw43_arch_enable_sta_mode();
+    while (cyw43_arch_wifi_connect_timeout_ms(WIFI_SSID, WIFI_PASSWORD, CYW43_AUTH_WPA2_MIXED_PSK, 30000) != 0) {
+        printf("WiFi连接失败，重试...\n");
+    }
+    const char* ip = ip4addr_ntoa(netif_ip4_addr(netif_list));
+    printf("WiFi已连接，IP: %s，端口 %u\n", ip, net::FB_STREAM_PORT);
+
+    display.clear();
+    display.drawString(10, 10, ip, true);
+    display.display();
+
+    net::DisplayFrameSink<st7306::ST7306Driver> sink(display);
+    net::FramebufferServer server(sink);
+    if (!server.begin(FB_SERVER_USE_TCP ? net::FramebufferServer::Mode::Tcp : net::FramebufferServer::Mode::Udp)) {
+        printf("服务器启动失败\n");
+        return 1;
+    }
+    net::StdioFrameReceiver usb(sink);
+
+    uint64_t next_report_us = time_us_64() + 5000000;
+    uint32_t last_frames = 0;
+    uint32_t last_bytes = 0;
+    while (true) {
+        // 收包回调在 cyw43_arch_poll() 里把负载直接写进显存，poll() 只刷新脏行并回复Ack
+        ST73XX_TRACE_BEGIN(st73xx::TraceEvent::NetPoll);
+        cyw43_arch_poll();
+        ST73XX_TRACE_END(st73xx::TraceEvent::NetPoll);
+        server.poll();
+        usb.poll();
+        // USB CDC 收包不会唤醒 cyw43 的等待，等待时间要短
+        cyw43_arch_wait_for_work_until(make_timeout_time_ms(1));
+
+        uint64_t now = time_us_64();
+        if (now >= next_report_us) {
+            const auto& s = server.stats();
+            uint32_t frames = s.frames - last_frames;
+            uint32_t bytes = s.payload_bytes - last_bytes;
+            printf("[FB] %.1f fps, %lu B/update, flush avg %lu us, errors %lu, rejected %lu, usb frames %lu\n",
+                   frames / 5.0f,
+                   static_cast<unsigned long>(frames ? bytes / frames : 0),
+                   static_cast<unsigned long>(s.frames ? s.flush_us / s.frames : 0),
+                   static_cast<unsigned long>(s.errors),
+                   static_cast<unsigned long>(s.rejected),
+                   static_cast<unsigned long>(usb.stats().frames));
+            last_frames = s.frames;
+            last_bytes = s.payload_bytes;
+            next_report_us = now + 5000000;
+        }
+    }
+}
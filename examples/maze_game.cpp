@@ -11,6 +11,10 @@
 #include "joystick.hpp"
 #include "joystick/joystick_config.hpp"
 #include "spi_config.hpp"
+#include "fb_stream_capture.hpp"
+
+// 显存静态分配，不占用堆（所在段可用 ST73XX_FRAMEBUFFER_SECTION 指定）
+ST73XX_DEFINE_FRAMEBUFFER(g_lcd_buffer, st7306::ST7306Driver);
 
 // ==================== 游戏难度设置 ====================
 // 难度级别定义（1-5级）
@@ -1168,13 +1172,10 @@ public:
     }
     
     // 处理joystick输入
-    int getJoystickDirection() {
-        uint16_t adc_x, adc_y;
-        joystick.get_joy_adc_16bits_value_xy(&adc_x, &adc_y);
-        
+    int getJoystickDirection(const joystick_sample_t& input) {
         // 使用偏移值获取更准确的方向检测
-        int16_t offset_x = joystick.get_joy_adc_12bits_offset_value_x();
-        int16_t offset_y = joystick.get_joy_adc_12bits_offset_value_y();
+        int16_t offset_x = input.x;
+        int16_t offset_y = input.y;
         
         int16_t abs_x = abs(offset_x);
         int16_t abs_y = abs(offset_y);
@@ -1199,8 +1200,15 @@ public:
         // 首先更新LED闪烁状态
         updateLedFlash();
         
-        uint8_t button_state = joystick.get_button_value();
-        int current_direction = getJoystickDirection();
+        // 后台采样模式下直接取最近一次读数，不占用I2C总线
+        joystick_sample_t input;
+        if (!joystick.sample(&input)) {
+            input.x = 0;
+            input.y = 0;
+            input.button = 1;
+        }
+        uint8_t button_state = input.button;
+        int current_direction = getJoystickDirection(input);
         absolute_time_t current_time = get_absolute_time();
         
         // 操作检测变量
@@ -1956,7 +1964,7 @@ int main() {
     printf("Maze Game Starting...\n");
     
     // 初始化显示屏
-    st7306::ST7306Driver display(PIN_DC, PIN_RST, PIN_CS, PIN_SCLK, PIN_SDIN);
+    st7306::ST7306Driver display(PIN_DC, PIN_RST, PIN_CS, PIN_SCLK, PIN_SDIN, g_lcd_buffer);
     pico_gfx::PicoDisplayGFX<st7306::ST7306Driver> gfx(
         display, 
         st7306::ST7306Driver::LCD_WIDTH, 
@@ -1979,6 +1987,9 @@ int main() {
         joystick.set_rgb_color(JOYSTICK_LED_GREEN);
         sleep_ms(1000);
         joystick.set_rgb_color(JOYSTICK_LED_OFF);
+        if (!joystick.start_background(JOYSTICK_SAMPLE_PERIOD_MS)) {
+            printf("Joystick background sampling unavailable, polling instead\n");
+        }
     } else {
         printf("Joystick initialization failed!\n");
         return -1;
@@ -1987,10 +1998,16 @@ int main() {
     // 创建游戏实例
     MazeGame game(display, gfx, joystick);
     game.init();
+
+    // 截屏：主机运行 tools/fb_capture 时把当前画面经USB发回，不打断游戏循环
+    net::StdioFrameCapture capture;
+    capture.listen(net::captureSource<st7306::ST7306Driver::Packing>(display.framebuffer().data(),
+                                                                     gfx.getRotation()));
     
     // 游戏主循环
     while (true) {
         game.update();
+        capture.poll();
         sleep_ms(20);
     }
     
@@ -9,6 +9,8 @@
 #include "js16tmr_joystick/js16tmr_joystick_direct.hpp"
 #include "js16tmr_joystick/js16tmr_joystick_handler.hpp"
 #include "spi_config.hpp"
+#include "st73xx_metrics.hpp"
+#include "st73xx_trace.hpp"
 
 // ==================== 游戏设置 ====================
 // 屏幕尺寸
@@ -52,8 +54,15 @@ struct Position {
     }
 };
 
+// 追踪事件（需用 -DST73XX_TRACE=ON 编译）：每帧的调试信息记入追踪缓冲，不再 printf
+constexpr st73xx::TraceEvent TRACE_DIRECTION = st73xx::traceUserEvent(0);     // 摇杆方向改变，参数为方向
+constexpr st73xx::TraceEvent TRACE_SNAKE_LENGTH = st73xx::traceUserEvent(1);  // 蛇长度计数器
+constexpr st73xx::TraceEvent TRACE_FOOD = st73xx::traceUserEvent(2);          // 食物位置，参数为 x | (y << 8)
+
 // ==================== 全局变量 ====================
-st7306::ST7306Driver display(TFT_PIN_DC, TFT_PIN_RST, TFT_PIN_CS, TFT_PIN_SCK, TFT_PIN_MOSI);
+// 显存静态分配，不占用堆（所在段可用 ST73XX_FRAMEBUFFER_SECTION 指定）
+ST73XX_DEFINE_FRAMEBUFFER(g_lcd_buffer, st7306::ST7306Driver);
+st7306::ST7306Driver display(TFT_PIN_DC, TFT_PIN_RST, TFT_PIN_CS, TFT_PIN_SCK, TFT_PIN_MOSI, g_lcd_buffer);
 pico_gfx::PicoDisplayGFX<st7306::ST7306Driver> gfx(display, SCREEN_WIDTH, SCREEN_HEIGHT);
 
 // JS16TMR摇杆
@@ -124,11 +133,10 @@ void generateFood() {
 Direction getJoystickDirection() {
     js16tmr::JoystickDirection direction = joystick_handler.getCurrentDirection();
     
-    // 调试信息（只在方向改变时输出）
+    // 调试信息（只在方向改变时记录）
     static js16tmr::JoystickDirection last_direction = js16tmr::JoystickDirection::CENTER;
     if (direction != last_direction) {
-        const char* dir_names[] = {"CENTER", "UP", "DOWN", "LEFT", "RIGHT"};
-        printf("摇杆方向: %s\n", dir_names[(int)direction]);
+        ST73XX_TRACE_INSTANT(TRACE_DIRECTION, direction);
         last_direction = direction;
     }
     
@@ -236,7 +244,7 @@ void drawSnake() {
     }
     
     // 调试信息
-    printf("绘制蛇: 长度=%d, 头部位置(%d,%d)\n", (int)snake.size(), snake[0].x, snake[0].y);
+    ST73XX_TRACE_COUNTER(TRACE_SNAKE_LENGTH, snake.size());
 }
 
 // 绘制食物
@@ -248,11 +256,12 @@ void drawFood() {
     gfx.fillRect(screen_x + 2, screen_y + 2, GRID_SIZE - 4, GRID_SIZE - 4, st7306::ST7306Driver::COLOR_BLACK);
     
     // 调试信息
-    printf("绘制食物: 位置(%d,%d), 屏幕坐标(%d,%d)\n", food.x, food.y, screen_x, screen_y);
+    ST73XX_TRACE_INSTANT(TRACE_FOOD, food.x | (food.y << 8));
 }
 
 // 绘制UI
 void drawUI() {
+    ST73XX_TRACE_BEGIN(st73xx::TraceEvent::Render);
     // 清屏
     display.clearDisplay();
     
@@ -295,6 +304,7 @@ void drawUI() {
             display.drawString(10, 365, "Press MID to Restart", true);
             break;
     }
+    ST73XX_TRACE_END(st73xx::TraceEvent::Render);
     
     display.display();
 }
@@ -366,6 +376,14 @@ void gameLoop() {
     while (true) {
         updateGame();
         drawUI();
+        // 串口输入 'm' 打印每帧性能统计（需用 -DST73XX_METRICS=ON 编译），
+        // 't' 导出追踪缓冲（需用 -DST73XX_TRACE=ON 编译，主机端用 tools/trace_decode.cpp 接收）
+        int c = getchar_timeout_us(0);
+        if (c == 'm') {
+            st73xx::Metrics::print();
+        } else if (c == 't') {
+            st73xx::Trace::dump();
+        }
         sleep_ms(16);  // 约60FPS
     }
 }
@@ -373,6 +391,9 @@ void gameLoop() {
 // ==================== 主函数 ====================
 int main() {
     stdio_init_all();
+    st73xx::Trace::nameEvent(TRACE_DIRECTION, "joystick direction");
+    st73xx::Trace::nameEvent(TRACE_SNAKE_LENGTH, "snake length");
+    st73xx::Trace::nameEvent(TRACE_FOOD, "food");
     
     printf("JS16TMR贪吃蛇游戏启动...\n");
     
@@ -5,12 +5,16 @@
 #include "st73xx_font.hpp"
 #include "gfx_colors.hpp"
 #include "spi_config.hpp"
+#include "st73xx_fixed_trig.hpp"
 #include <cstdio>
 #include <vector>
 #include <string>
 #include <cmath>
 #include <algorithm>
 
+// 显存静态分配，不占用堆（所在段可用 ST73XX_FRAMEBUFFER_SECTION 指定）
+ST73XX_DEFINE_FRAMEBUFFER(g_lcd_buffer, st7306::ST7306Driver);
+
 // 风车动画参数配置
 namespace windmill_config {
     // 风车外观配置
@@ -39,74 +43,49 @@ namespace windmill_config {
 }
 
 // 用圆弧和直线组合的水滴状叶片，并填充内部为黑色
-void drawFanBlade(pico_gfx::PicoDisplayGFX<st7306::ST7306Driver>& gfx, int cx, int cy, float angle, int length, int width, uint16_t color) {
-    float root_radius = width * 0.6f; // 根部圆弧半径
-    float tip_radius = width * 1.2f;  // 外缘圆弧半径
-    float blade_span = M_PI / 2.2;    // 叶片张开角度
-    int arc_steps = 24;
-    std::vector<std::pair<int, int>> outline;
+// 角度为定点单位（见 st73xx_fixed_trig.hpp），顶点计算只用整数运算
+void drawFanBlade(pico_gfx::PicoDisplayGFX<st7306::ST7306Driver>& gfx, int cx, int cy, st73xx::Angle angle, int length, int width, uint16_t color) {
+    // 半径以1/16像素为单位，避免小半径取整后叶片变形
+    constexpr int SUBPIXEL = 16;
+    int32_t root_radius = width * SUBPIXEL * 6 / 10; // 根部圆弧半径
+    int32_t tip_radius = width * SUBPIXEL * 12 / 10; // 外缘圆弧半径
+    constexpr int32_t blade_span = 65536 * 10 / 44;  // 叶片张开角度（pi/2.2）
+    constexpr int arc_steps = 24;
+    constexpr int outline_points = 2 * (arc_steps + 1);
+    int16_t outline_x[outline_points];
+    int16_t outline_y[outline_points];
+    int n = 0;
     // 根部圆弧
-    float root_start = angle - blade_span/2;
-    float root_end   = angle + blade_span/2;
+    int32_t root_start = angle - blade_span / 2;
     for (int i = 0; i <= arc_steps; ++i) {
-        float t = (float)i / arc_steps;
-        float a = root_start + t * (root_end - root_start);
-        int x = cx + root_radius * cos(a);
-        int y = cy + root_radius * sin(a);
-        outline.push_back({x, y});
+        st73xx::Angle a = static_cast<st73xx::Angle>(root_start + blade_span * i / arc_steps);
+        int32_t x, y;
+        st73xx::polarToCartesian(cx * SUBPIXEL, cy * SUBPIXEL, root_radius, a, x, y);
+        outline_x[n] = static_cast<int16_t>((x + SUBPIXEL / 2) / SUBPIXEL);
+        outline_y[n] = static_cast<int16_t>((y + SUBPIXEL / 2) / SUBPIXEL);
+        n++;
     }
     // 外缘圆弧（反向）
-    float tip_start = root_end;
-    float tip_end   = root_start;
-    float tip_cx = cx + length * cos(angle);
-    float tip_cy = cy + length * sin(angle);
+    int32_t tip_cx, tip_cy;
+    st73xx::polarToCartesian(cx * SUBPIXEL, cy * SUBPIXEL, length * SUBPIXEL, angle, tip_cx, tip_cy);
+    int32_t tip_start = root_start + blade_span;
     for (int i = 0; i <= arc_steps; ++i) {
-        float t = (float)i / arc_steps;
-        float a = tip_start + t * (tip_end - tip_start);
-        int x = tip_cx + tip_radius * cos(a);
-        int y = tip_cy + tip_radius * sin(a);
-        outline.push_back({x, y});
-    }
-    // 闭合轮廓
-    outline.push_back(outline.front());
-    // 填充叶片内部
-    // 简单扫描线填充法：遍历outline包围的最小矩形区域
-    int min_x = outline[0].first, max_x = outline[0].first;
-    int min_y = outline[0].second, max_y = outline[0].second;
-    for (const auto& p : outline) {
-        if (p.first < min_x) min_x = p.first;
-        if (p.first > max_x) max_x = p.first;
-        if (p.second < min_y) min_y = p.second;
-        if (p.second > max_y) max_y = p.second;
-    }
-    for (int y = min_y; y <= max_y; ++y) {
-        std::vector<int> nodes;
-        size_t n = outline.size();
-        for (size_t i = 0, j = n - 1; i < n; j = i++) {
-            int x0 = outline[i].first, y0 = outline[i].second;
-            int x1 = outline[j].first, y1 = outline[j].second;
-            if ((y0 < y && y1 >= y) || (y1 < y && y0 >= y)) {
-                int x = x0 + (y - y0) * (x1 - x0) / (y1 - y0);
-                nodes.push_back(x);
-            }
-        }
-        std::sort(nodes.begin(), nodes.end());
-        for (size_t k = 1; k < nodes.size(); k += 2) {
-            if (nodes[k-1] < nodes[k]) {
-                gfx.drawLine(nodes[k-1], y, nodes[k], y, color);
-            }
-        }
-    }
-    // 画轮廓
-    for (size_t i = 1; i < outline.size(); ++i) {
-        gfx.drawLine(outline[i-1].first, outline[i-1].second, outline[i].first, outline[i].second, color);
+        st73xx::Angle a = static_cast<st73xx::Angle>(tip_start - blade_span * i / arc_steps);
+        int32_t x, y;
+        st73xx::polarToCartesian(tip_cx, tip_cy, tip_radius, a, x, y);
+        outline_x[n] = static_cast<int16_t>((x + SUBPIXEL / 2) / SUBPIXEL);
+        outline_y[n] = static_cast<int16_t>((y + SUBPIXEL / 2) / SUBPIXEL);
+        n++;
     }
+    // 填充叶片内部（活动边表扫描线填充），再画闭合轮廓
+    gfx.drawFilledPolygon(outline_x, outline_y, outline_points, color);
+    gfx.drawPolygon(outline_x, outline_y, outline_points, color);
 }
 
 int main() {
     stdio_init_all();
 
-    st7306::ST7306Driver RF_lcd(PIN_DC, PIN_RST, PIN_CS, PIN_SCLK, PIN_SDIN);
+    st7306::ST7306Driver RF_lcd(PIN_DC, PIN_RST, PIN_CS, PIN_SCLK, PIN_SDIN, g_lcd_buffer);
     pico_gfx::PicoDisplayGFX<st7306::ST7306Driver> gfx(RF_lcd, st7306::ST7306Driver::LCD_WIDTH, st7306::ST7306Driver::LCD_HEIGHT);
 
     printf("Initializing ST7306 display...\n");
@@ -167,26 +146,27 @@ int main() {
         // 绘制已完成的进度部分（带有滚动灰度条纹，使用抖动技术）
         for (int y = bar_y + 3; y < bar_y + bar_height - 3; y++) {
             for (int x = bar_x + 3; x < bar_x + 3 + fill_width; x++) {
-                // 使用余弦函数生成更平滑的渐变
-                float position = (float)((x + offset) % pattern_width) / pattern_width;
-                // 生成一个0到1的平滑波浪值
-                float wave = (1.0f + cosf(position * 2.0f * M_PI)) / 2.0f;
+                // 使用余弦函数生成更平滑的渐变（定点余弦，Q15）
+                st73xx::Angle phase = st73xx::angleFromTurns((x + offset) % pattern_width, pattern_width);
+                // 生成一个0到1的平滑波浪值（Q15，0 ~ 32768）
+                int32_t wave = (st73xx::Q15_ONE + st73xx::cosQ15(phase)) / 2;
                 
                 // 获取主灰度级别 (0-3)
-                uint8_t base_level = (uint8_t)(wave * 3.0f);
+                int32_t scaled = wave * 3;
+                uint8_t base_level = static_cast<uint8_t>(scaled >> 15);
                 
-                // 获取误差，用于抖动
-                float error = (wave * 3.0f) - base_level;
+                // 获取误差，用于抖动（Q15）
+                int32_t error = scaled & 0x7FFF;
                 
                 // 应用抖动模式 - 使用2x2的Bayer矩阵
                 int bayer_x = x % 2;
                 int bayer_y = y % 2;
                 int bayer_index = bayer_y * 2 + bayer_x;
                 
-                // 阈值矩阵
-                const float bayer_threshold[4] = {
-                    0.0f,  0.5f,
-                    0.75f, 0.25f
+                // 阈值矩阵（Q15：0, 0.5, 0.75, 0.25）
+                constexpr int32_t bayer_threshold[4] = {
+                    0,     16384,
+                    24576, 8192
                 };
                 
                 // 根据抖动阈值决定是否提升灰度级别
@@ -234,7 +214,7 @@ int main() {
     const int center_y = gfx.height() / 2;
     
     // 动画循环
-    float current_angle = 0.0f;
+    uint32_t current_angle = 0; // 定点角度累加，低16位即当前角度
     for (int frame = 0; frame < windmill_config::TOTAL_FRAMES / 5; frame++) { // 减少帧数以缩短演示时间
         RF_lcd.clearDisplay();
         // 匀速加速
@@ -248,13 +228,13 @@ int main() {
         snprintf(frame_text, sizeof(frame_text), "Frame: %d/%d", frame + 1, windmill_config::TOTAL_FRAMES / 5);
         RF_lcd.drawString(5, 5, rpm_text, true);
         RF_lcd.drawString(5, 5 + font::FONT_HEIGHT + 2, frame_text, true);
-        // 计算本帧角度增量
-        float delta_angle = rpm * 360.0f * (1.0f / windmill_config::FPS) / 60.0f;
+        // 计算本帧角度增量（每帧转过 rpm / 60 / FPS 圈）
+        uint32_t delta_angle = static_cast<uint32_t>(rpm) * st73xx::ANGLE_TURN / (60 * windmill_config::FPS);
         current_angle += delta_angle;
         // 绘制风车
         gfx.drawFilledCircle(center_x, center_y, windmill_config::HUB_RADIUS, true);
         for (int i = 0; i < windmill_config::NUM_BLADES; i++) {
-            float angle = (current_angle + i * (360.0f / windmill_config::NUM_BLADES)) * M_PI / 180.0f;
+            st73xx::Angle angle = static_cast<st73xx::Angle>(current_angle + st73xx::angleFromTurns(i, windmill_config::NUM_BLADES));
             drawFanBlade(gfx, center_x, center_y, angle, windmill_config::BLADE_LENGTH, windmill_config::BLADE_WIDTH, true);
         }
         RF_lcd.display();
@@ -10,6 +10,9 @@
 #include <string>
 #include <algorithm>
 
+// 显存静态分配，不占用堆（所在段可用 ST73XX_FRAMEBUFFER_SECTION 指定）
+ST73XX_DEFINE_FRAMEBUFFER(g_lcd_buffer, st7306::ST7306Driver);
+
 // 满屏文字显示配置
 namespace fullscreen_config {
     constexpr int MARGIN = 5;                    // 屏幕边距
@@ -211,7 +214,7 @@ void displayGrayTextEffect(st7306::ST7306Driver& lcd) {
 int main() {
     stdio_init_all();
 
-    st7306::ST7306Driver RF_lcd(PIN_DC, PIN_RST, PIN_CS, PIN_SCLK, PIN_SDIN);
+    st7306::ST7306Driver RF_lcd(PIN_DC, PIN_RST, PIN_CS, PIN_SCLK, PIN_SDIN, g_lcd_buffer);
     pico_gfx::PicoDisplayGFX<st7306::ST7306Driver> gfx(RF_lcd, st7306::ST7306Driver::LCD_WIDTH, st7306::ST7306Driver::LCD_HEIGHT);
 
     printf("Initializing ST7306 display for fullscreen text demo...\n");
@@ -22,6 +22,18 @@
 
 typedef enum { ADC_8BIT_RESULT = 0, ADC_16BIT_RESULT } adc_mode_t;
 
+/**
+ * @brief One joystick reading
+ * x/y are the 12bits mapped values (same as get_joy_adc_12bits_offset_value_x/y),
+ * button is 0 press, 1 no press
+ */
+typedef struct {
+    int16_t x;
+    int16_t y;
+    uint8_t button;
+    uint32_t time_us;  // time_us_32() when the reading completed
+} joystick_sample_t;
+
 /**
  * @brief Joystick control API
  */
@@ -162,12 +174,80 @@ public:
      */
     void get_joy_adc_8bits_value_xy(uint8_t *adc_x, uint8_t *adc_y);
 
+    /**
+     * @brief Read X, Y and button together
+     * The mapped XY register and the button register are not adjacent, so this takes two
+     * I2C transactions, queued back to back in the controller FIFO (no CPU gap between them).
+     * In background mode no bus access is made: the latest background reading is returned.
+     * @param sample pointer of the reading
+     * @return 1 success, 0 false (I2C error, or no background reading yet)
+     */
+    bool sample(joystick_sample_t *sample);
+
+    /**
+     * @brief Start background sampling
+     * A repeating timer queues the sample() transactions every period_ms; the I2C interrupt
+     * collects the bytes into a double-buffered reading, so sample() never waits for the bus.
+     * The other API calls stay usable: they pause the background sampling for their transaction.
+     * The timer and the I2C interrupt run on the calling core: off the default alarm pool's core
+     * a private pool is created on a spare hardware alarm (released by stop_background()).
+     * Call from the core that uses the joystick; one background joystick per I2C port.
+     * @param period_ms sampling period
+     * @return 1 success, 0 false
+     */
+    bool start_background(uint32_t period_ms = 10);
+
+    /**
+     * @brief Stop background sampling
+     */
+    void stop_background(void);
+
+    /**
+     * @brief Background sampling state
+     * @return 1 running, 0 stopped
+     */
+    bool background_active(void) const { return _bg_active; }
+
+    /**
+     * @brief Get background sampling counters
+     * @param samples pointer of completed readings
+     * @param errors pointer of failed transactions (NACK, timeout)
+     */
+    void get_background_stats(uint32_t *samples, uint32_t *errors) const;
+
 private:
+    static constexpr uint8_t SAMPLE_RX_BYTES = 5;  // mapped X(2) Y(2) + button(1)
+
+    static void i2c0_irq_handler(void);
+    static void i2c1_irq_handler(void);
+    static bool background_timer_callback(struct repeating_timer *t);
+
+    int read_reg(uint8_t reg, uint8_t *buf, uint8_t nbytes);
+    int write_reg(uint8_t reg, const uint8_t *buf, uint8_t nbytes);
+    void queue_sample(void);
+    bool finish_sample(joystick_sample_t *sample);
+    void reset_transfer(void);
+    void disable_controller(void);
+    void service_background(void);
+    void pause_background(void);
+    void resume_background(void);
+
     i2c_inst_t *_i2c_port;
     uint8_t _addr;
     uint _scl_pin;
     uint _sda_pin;
     uint32_t _speed;
+
+    // Background sampling: the timer and the I2C interrupt write, readers take _bg_buffer[_bg_seq & 1]
+    struct repeating_timer _bg_timer;
+    alarm_pool_t *_bg_pool = nullptr;  // own pool when not started on the default pool's core
+    joystick_sample_t _bg_buffer[2];
+    volatile uint32_t _bg_seq = 0;
+    volatile uint32_t _bg_errors = 0;
+    volatile uint32_t _bg_queued_us = 0;
+    volatile bool _bg_busy = false;
+    volatile bool _bg_paused = false;
+    bool _bg_active = false;
 };
 
 #endif 
\ No newline at end of file
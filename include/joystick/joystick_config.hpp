@@ -16,5 +16,6 @@
 // Operation detection thresholds
 #define JOYSTICK_THRESHOLD 1800       // Increased joystick threshold to reduce false triggers
 #define JOYSTICK_LOOP_DELAY_MS 20     // Loop delay time (milliseconds)
+#define JOYSTICK_SAMPLE_PERIOD_MS 10  // Background sampling period (milliseconds)
 #define JOYSTICK_PRINT_INTERVAL_MS 250 // Repeat print interval (milliseconds)
 #define JOYSTICK_DIRECTION_RATIO 1.5  // Direction determination ratio 
\ No newline at end of file
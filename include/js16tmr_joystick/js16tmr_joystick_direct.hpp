@@ -16,6 +16,10 @@
 #define JS16TMR_JOYSTICK_ADC_X_CHANNEL  0      // ADC通道0 (GP26)
 #define JS16TMR_JOYSTICK_ADC_Y_CHANNEL  1      // ADC通道1 (GP27)
 
+// 自由运行采样：ADC在X/Y通道间轮转连续转换，DMA写入环形缓冲区
+#define JS16TMR_JOYSTICK_SAMPLE_RATE_HZ 4000   // 两个通道合计的转换速率（每轴一半）
+#define JS16TMR_JOYSTICK_RING_SAMPLES   32     // 环形缓冲区样本数（2的幂，X/Y交替；每轴16个样本即8ms窗口）
+
 // JS16TMR摇杆操作参数配置
 #define JS16TMR_JOYSTICK_THRESHOLD      1800   // 操作检测阈值
 #define JS16TMR_JOYSTICK_LOOP_DELAY_MS  20     // 循环延迟时间（毫秒）
@@ -34,6 +38,9 @@ typedef enum { ADC_8BIT_RESULT = 0, ADC_16BIT_RESULT } adc_mode_t;
  * - X轴: GP26 (ADC0)
  * - Y轴: GP27 (ADC1) 
  * - 开关: GP22 (数字输入，内部上拉)
+ * ADC在begin()后一直自由运行，两个DMA通道把结果循环写入环形缓冲区，
+ * 读取时对缓冲区中每轴的最近样本取平均，不等待ADC。ADC被本类独占，其他代码不要再调用 adc_read()；
+ * 申请不到DMA通道时退回阻塞读取。
  */
 class JS16TMRJoystickDirect {
 public:
@@ -61,11 +68,10 @@ private:
     uint16_t _center_y;
     bool _calibrated;
     
-    // TMR高频滤波器
-    uint16_t _filter_x[4];  // 减少滤波器长度，提高响应速度
-    uint16_t _filter_y[4];
-    uint8_t _filter_index;
-    bool _filter_initialized;
+    // 自由运行采样：下标为偶数的是X，奇数的是Y；按自身大小对齐以使用DMA环形写地址
+    alignas(JS16TMR_JOYSTICK_RING_SAMPLES * sizeof(uint16_t)) volatile uint16_t _ring[JS16TMR_JOYSTICK_RING_SAMPLES];
+    int _dma_data = -1;    // ADC FIFO -> 环形缓冲区
+    int _dma_reload = -1;  // 数据通道计数用完后重新装入并触发，采样永不停止
     
     // 滞回控制
     int16_t _last_stable_x;
@@ -74,8 +80,9 @@ private:
 
     // 辅助函数
     void calibrate_center(void);
+    bool start_free_running(void);
     uint16_t read_adc_channel(uint channel);
-    uint16_t apply_filter(uint16_t new_value, uint16_t* filter_buffer);
+    uint16_t read_adc_blocking(uint channel);
 };
 
 #endif
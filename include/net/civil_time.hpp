@@ -0,0 +1,130 @@
+#pragma once
+
+#include <cstdint>
+
+namespace net {
+
+// 民用历法换算（公历，proleptic Gregorian），不依赖 newlib 的 localtime/gmtime
+// days 为自 1970-01-01 起的天数，可为负。算法见 H. Hinnant "chrono-Compatible Low-Level Date Algorithms"：
+// 以3月为一年之始，闰日落在年末，按400年周期（146097天）整除，只有整数乘除，没有查表和循环。
+constexpr int32_t daysFromCivil(int32_t y, uint32_t m, uint32_t d) {
+    y -= m <= 2;
+    const int32_t era = (y >= 0 ? y : y - 399) / 400;
+    const uint32_t yoe = static_cast<uint32_t>(y - era * 400);              // [0, 399]
+    const uint32_t doy = (153 * (m > 2 ? m - 3 : m + 9) + 2) / 5 + d - 1;   // [0, 365]
+    const uint32_t doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;             // [0, 146096]
+    return era * 146097 + static_cast<int32_t>(doe) - 719468;
+}
+
+struct CivilDate {
+    int16_t year;
+    uint8_t month;  // 1..12
+    uint8_t day;    // 1..31
+};
+
+constexpr CivilDate civilFromDays(int32_t z) {
+    z += 719468;
+    const int32_t era = (z >= 0 ? z : z - 146096) / 146097;
+    const uint32_t doe = static_cast<uint32_t>(z - era * 146097);
+    const uint32_t yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    const int32_t y = static_cast<int32_t>(yoe) + era * 400;
+    const uint32_t doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    const uint32_t mp = (5 * doy + 2) / 153;
+    const uint32_t d = doy - (153 * mp + 2) / 5 + 1;
+    const uint32_t m = mp < 10 ? mp + 3 : mp - 9;
+    return CivilDate{static_cast<int16_t>(y + (m <= 2)), static_cast<uint8_t>(m), static_cast<uint8_t>(d)};
+}
+
+// 0=Sunday ... 6=Saturday（1970-01-01 为星期四）
+constexpr uint8_t weekdayFromDays(int32_t z) {
+    return static_cast<uint8_t>(z >= -4 ? (z + 4) % 7 : (z + 5) % 7 + 6);
+}
+
+constexpr bool isLeapYear(int32_t y) {
+    return (y % 4 == 0) && (y % 100 != 0 || y % 400 == 0);
+}
+
+constexpr uint8_t daysInMonth(int32_t y, uint32_t m) {
+    return m == 2 ? (isLeapYear(y) ? 29 : 28) : static_cast<uint8_t>(30 + ((m + (m >> 3)) & 1));
+}
+
+// 夏令时切换规则："month 月第 week 个 weekday 的 time_s 秒"
+// week 取 1..4，5 表示最后一个；time_s 按切换前生效的本地时间计
+struct DstRule {
+    uint8_t month;
+    uint8_t week;
+    uint8_t weekday;  // 0=Sunday
+    int32_t time_s;
+};
+
+// 时区：标准时偏移 + 可选的夏令时规则，编译期常量
+struct TimeZone {
+    const char* name;
+    int32_t std_offset_s;  // 本地标准时 - UTC
+    int32_t dst_delta_s;   // 夏令时额外偏移；0 表示不实行夏令时
+    DstRule dst_start;
+    DstRule dst_end;
+};
+
+constexpr TimeZone TZ_UTC = {"UTC", 0, 0, {}, {}};
+constexpr TimeZone TZ_ASIA_SHANGHAI = {"CST", 8 * 3600, 0, {}, {}};
+constexpr TimeZone TZ_ASIA_TOKYO = {"JST", 9 * 3600, 0, {}, {}};
+// 欧盟：3月最后一个周日 01:00 UTC 至 10月最后一个周日 01:00 UTC
+constexpr TimeZone TZ_EUROPE_BERLIN = {"CET", 3600, 3600, {3, 5, 0, 2 * 3600}, {10, 5, 0, 3 * 3600}};
+constexpr TimeZone TZ_EUROPE_LONDON = {"GMT", 0, 3600, {3, 5, 0, 1 * 3600}, {10, 5, 0, 2 * 3600}};
+// 美国：3月第二个周日 02:00 至 11月第一个周日 02:00
+constexpr TimeZone TZ_AMERICA_NEW_YORK = {"EST", -5 * 3600, 3600, {3, 2, 0, 2 * 3600}, {11, 1, 0, 2 * 3600}};
+constexpr TimeZone TZ_AMERICA_LOS_ANGELES = {"PST", -8 * 3600, 3600, {3, 2, 0, 2 * 3600}, {11, 1, 0, 2 * 3600}};
+// 南半球：10月第一个周日 02:00 至 4月第一个周日 03:00
+constexpr TimeZone TZ_AUSTRALIA_SYDNEY = {"AEST", 10 * 3600, 3600, {10, 1, 0, 2 * 3600}, {4, 1, 0, 3 * 3600}};
+
+// 本地时间
+struct CivilTime {
+    int16_t year;
+    uint8_t month;    // 1..12
+    uint8_t day;      // 1..31
+    uint8_t hour;
+    uint8_t minute;
+    uint8_t second;
+    uint8_t weekday;  // 0=Sunday
+    bool dst;
+};
+
+// 增量式本地时钟
+// set() 做一次完整换算（天数 -> 年月日、计算下一次夏令时切换的UTC时刻）；之后 advanceTo()
+// 在时间前进少量秒数时只做进位（秒 -> 分 -> 时 -> 日 -> 月 -> 年），跨过夏令时切换点、
+// 时间倒退或跳变过大时才重新完整换算。每秒调用一次时，绝大多数情况下只有一次加法和一次比较。
+class CivilClock {
+public:
+    static constexpr int64_t MAX_INCREMENTAL_STEP_S = 120;  // 超过此步长直接重新换算
+
+    explicit CivilClock(const TimeZone& zone = TZ_UTC);
+
+    void setZone(const TimeZone& zone);
+    const TimeZone& zone() const { return *zone_; }
+
+    // 完整换算
+    void set(int64_t unix_seconds);
+
+    // 前进到 unix_seconds（通常为上次 +1）
+    void advanceTo(int64_t unix_seconds);
+
+    const CivilTime& local() const { return local_; }
+    int64_t unixSeconds() const { return unix_; }
+    int32_t utcOffset() const { return offset_s_; }
+
+    // 某一UTC时刻的本地偏移（完整计算，不影响增量状态）
+    static int32_t offsetAt(const TimeZone& zone, int64_t unix_seconds, bool* dst = nullptr,
+                            int64_t* next_transition = nullptr);
+
+private:
+    void tickSecond();
+
+    const TimeZone* zone_;
+    int64_t unix_;
+    int64_t next_transition_;  // 下一次夏令时切换（UTC秒）；无切换时为 INT64_MAX
+    int32_t offset_s_;
+    CivilTime local_;
+};
+
+} // namespace net
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include "fb_stream_protocol.hpp"
+
+namespace net {
+
+// 截屏的显存描述
+struct CaptureSource {
+    const uint8_t* buffer;
+    uint16_t stride;    // 每字节行的字节数
+    uint16_t rows;      // 字节行数
+    uint16_t width;     // 物理像素
+    uint16_t height;
+    uint8_t bits;       // 每像素位数
+    uint8_t rotation;   // 与 ST73XX_UI::setRotation 相同
+};
+
+// 按面板打包格式描述显存，例如
+//   captureSource<st7306::ST7306Driver::Packing>(display.framebuffer().data(), gfx.getRotation())
+//   captureSource<st7306::ST7306Driver::MonoPacking>(display.monoFramebuffer().data())
+template <class Packing>
+CaptureSource captureSource(const uint8_t* buffer, uint8_t rotation = 0) {
+    return CaptureSource{buffer, Packing::STRIDE, Packing::ROWS, Packing::WIDTH, Packing::HEIGHT,
+                         Packing::BITS, static_cast<uint8_t>(rotation & 3)};
+}
+
+// 通过 stdio（USB CDC）截屏，主机端 tools/fb_capture.cpp 还原为PNG
+// 显存按行带做行程编码，以 Delta 关键行带发出（协议见 fb_stream_protocol.hpp 的 Capture）。
+// poll() 只在发送缓冲区放得下一整条消息时才写出，从不等待USB；消息不会被 printf 输出从中间打断，
+// 主机端按魔数把截屏数据从日志中分离。一次截屏跨越多次 poll()，绘制照常进行：
+// 没有快照缓冲区时各行带取自编码那一刻的显存，画面可能撕裂。
+class StdioFrameCapture {
+public:
+    struct Stats {
+        uint32_t captures;    // 完成的截屏
+        uint32_t messages;
+        uint32_t raw_bytes;   // 编码前的显存字节
+        uint32_t wire_bytes;  // 实际发送的字节
+    };
+
+    // 单条消息上限：pico_stdio_usb 的CDC发送缓冲区为256字节
+    static constexpr size_t DEFAULT_MAX_MESSAGE = 256;
+    static constexpr size_t MAX_MESSAGE = 512;
+    static constexpr uint32_t DEFAULT_BYTE_BUDGET = 2048;
+
+    explicit StdioFrameCapture(size_t max_message = DEFAULT_MAX_MESSAGE);
+
+    // 开始一次截屏；已有截屏在进行、或一条消息放不下一个字节行时返回 false。
+    // snapshot 非空时先把显存拷进去（stride × rows 字节），之后从快照编码，画面不撕裂
+    bool request(const CaptureSource& source, uint8_t* snapshot = nullptr);
+
+    // 响应主机发来的截屏请求：poll() 从 stdin 读取请求消息，收到时截取 source。
+    // 应用自己读取 stdin（如 StdioFrameReceiver）时不要打开
+    void listen(const CaptureSource& source, uint8_t* snapshot = nullptr);
+
+    // 每次最多写出 byte_budget 字节；在主循环中调用
+    void poll(uint32_t byte_budget = DEFAULT_BYTE_BUDGET);
+
+    bool busy() const { return phase_ != Phase::Idle; }
+    const Stats& stats() const { return stats_; }
+
+private:
+    enum class Phase : uint8_t { Idle, Info, Bands };
+
+    void pollRequests();
+    void prepareMessage();
+    bool hostConnected() const;
+    size_t writable() const;
+
+    size_t max_message_;
+    CaptureSource source_;
+    const uint8_t* frame_;  // 编码来源：快照或显存
+    Phase phase_;
+    uint16_t seq_;
+    uint16_t band_rows_;
+    uint16_t next_row_;
+    uint8_t part_;
+    uint8_t parts_;
+    size_t message_len_;  // 已编码、等待写出的消息长度（0 表示没有）
+
+    bool listening_;
+    CaptureSource listen_source_;
+    uint8_t* listen_snapshot_;
+    uint8_t request_buf_[FB_STREAM_HEADER_LENGTH];
+    uint8_t request_fill_;
+
+    Stats stats_;
+    uint8_t message_[MAX_MESSAGE];
+};
+
+} // namespace net
@@ -0,0 +1,769 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace net {
+
+// 帧缓冲流协议（设备端服务器与主机端工具共用，不依赖lwIP）
+//
+// 每条消息 = 14字节消息头 + 负载，多字节字段为小端：
+//   magic u16 | type u8 | flags u8 | seq u16 | col u16 | row u16 | width u16 | rows u16
+// 坐标与尺寸都以面板原生打包的"字节"为单位（col/width 为字节列，row/rows 为字节行）。
+//
+// Rect：负载是 rows 行、每行 width 字节，逐字节等同于显存中的对应区域，设备端直接拷入显存。
+// 整帧就是 col=0、width=STRIDE 的矩形；UDP下按行带拆成多条消息，每个数据报一条。
+// 一次更新的最后一条消息带 FLAG_FRAME_END：设备端此时才刷新累积的脏行，
+// 并回一条 Ack（seq 为该条消息的 seq，row/rows 为本次刷新的行区间）。
+//
+// Delta：负载 = 6字节前缀 + 行程编码数据
+//   base_seq u16 | part u8 | parts u8 | length u16
+// 解码结果是 width × rows 的字节块。不带 FLAG_KEY 时与显存对应区域按位异或，
+// 基准是设备最近一次提交的帧 base_seq（即发送端最近一次收到 Ack 的帧）；
+// 带 FLAG_KEY 时直接覆盖（关键行带，不需要基准）。
+// 一帧拆成 parts 条消息（每条一个行带，未变化的行带不发送），全部到齐才提交为设备当前帧，
+// Ack 的 seq 总是设备当前提交的帧。设备只在显存上原地异或，不保存参考帧。
+//
+// 丢失恢复：一条消息就是一个数据报，丢失时对应行带保持原样，到达的行带已经更新。
+// 发送端没有收到本帧的确认时，把本帧发过的行带记为"不确定"，下一帧对这些行带发关键行带，
+// 其余行带照常对已确认帧做差分；不需要重发整帧。基准不符（设备停在发送端不知道的帧上）
+// 的差分行带被丢弃；设备上电后或被 Rect 消息改写过显存时 Ack 带 FLAG_NEED_KEY，
+// 发送端下一帧全部发关键行带。
+//
+// Capture：截屏（设备把显存发给主机，复用 Delta 关键行带）。主机发一条 width=rows=0、不带负载的
+// Capture 消息请求截屏；设备先回一条 Capture 消息描述画面（seq 为截屏编号，width/rows 为显存的
+// stride 与字节行数），负载为 FB_CAPTURE_INFO_LENGTH 字节：
+//   pixel_width u16 | pixel_height u16 | bits u8 | rotation u8 | reserved u16
+// 随后是同一 seq 的 Delta 关键行带（base_seq 为0），最后一条带 FLAG_FRAME_END。
+// rotation 的含义与 ST73XX_UI::setRotation 相同（逻辑坐标 -> 物理坐标），由主机端转回逻辑方向。
+//
+// 行程编码（PackBits变体），控制字节 c：
+//   0x00..0x7F  其后 c+1 个字节原样输出
+//   0x80..0xFF  其后1个字节重复 (c & 0x7F) + 2 次
+// 输出可以短于 width × rows（异或数据末尾的0省略）。
+constexpr uint16_t FB_STREAM_MAGIC = 0x4246;  // "FB"
+constexpr uint16_t FB_STREAM_PORT = 7306;
+constexpr size_t FB_STREAM_HEADER_LENGTH = 14;
+constexpr size_t FB_STREAM_DELTA_PREFIX_LENGTH = 6;
+constexpr size_t FB_CAPTURE_INFO_LENGTH = 8;
+// 单个UDP数据报建议的最大长度（以太网MTU 1500 - IP头20 - UDP头8）
+constexpr size_t FB_STREAM_MAX_DATAGRAM = 1472;
+
+enum class FbStreamType : uint8_t {
+    Rect = 1,   // 矩形更新（主机 -> 设备）
+    Ack = 2,    // 刷新确认（设备 -> 主机）
+    Delta = 3,  // 差分/关键帧行带（主机 -> 设备）
+    Capture = 4,  // 截屏请求（主机 -> 设备）/ 画面描述（设备 -> 主机）
+};
+
+constexpr uint8_t FB_STREAM_FLAG_FRAME_END = 0x01;
+constexpr uint8_t FB_STREAM_FLAG_KEY = 0x02;       // Delta：关键行带，直接覆盖
+constexpr uint8_t FB_STREAM_FLAG_NEED_KEY = 0x04;  // Ack：显存内容未知，需要整帧关键行带
+
+struct FbStreamHeader {
+    FbStreamType type;
+    uint8_t flags;
+    uint16_t seq;
+    uint16_t col;
+    uint16_t row;
+    uint16_t width;
+    uint16_t rows;
+
+    uint32_t payloadLength() const {
+        return type == FbStreamType::Rect ? static_cast<uint32_t>(width) * rows : 0;
+    }
+};
+
+struct FbDeltaPrefix {
+    uint16_t base_seq;
+    uint8_t part;
+    uint8_t parts;
+    uint16_t length;  // 行程编码数据的字节数
+};
+
+// 截屏画面描述（Capture 消息的负载）
+struct FbCaptureInfo {
+    uint16_t width;   // 物理像素
+    uint16_t height;
+    uint8_t bits;     // 每像素位数（1 或 2）
+    uint8_t rotation;
+};
+
+inline void fbStreamPut16(uint8_t* p, uint16_t v) {
+    p[0] = static_cast<uint8_t>(v);
+    p[1] = static_cast<uint8_t>(v >> 8);
+}
+
+inline uint16_t fbStreamGet16(const uint8_t* p) {
+    return static_cast<uint16_t>(p[0] | (p[1] << 8));
+}
+
+inline void fbStreamEncodeHeader(uint8_t* out, const FbStreamHeader& h) {
+    fbStreamPut16(out, FB_STREAM_MAGIC);
+    out[2] = static_cast<uint8_t>(h.type);
+    out[3] = h.flags;
+    fbStreamPut16(out + 4, h.seq);
+    fbStreamPut16(out + 6, h.col);
+    fbStreamPut16(out + 8, h.row);
+    fbStreamPut16(out + 10, h.width);
+    fbStreamPut16(out + 12, h.rows);
+}
+
+// 魔数不符时返回 false
+inline bool fbStreamDecodeHeader(const uint8_t* in, FbStreamHeader& h) {
+    if (fbStreamGet16(in) != FB_STREAM_MAGIC) return false;
+    h.type = static_cast<FbStreamType>(in[2]);
+    h.flags = in[3];
+    h.seq = fbStreamGet16(in + 4);
+    h.col = fbStreamGet16(in + 6);
+    h.row = fbStreamGet16(in + 8);
+    h.width = fbStreamGet16(in + 10);
+    h.rows = fbStreamGet16(in + 12);
+    return true;
+}
+
+inline void fbStreamEncodeAck(uint8_t* out, uint16_t seq, uint8_t flags, uint16_t first_row, uint16_t row_count) {
+    fbStreamEncodeHeader(out, FbStreamHeader{FbStreamType::Ack, flags, seq, 0, first_row, 0, row_count});
+}
+
+inline void fbCaptureEncodeInfo(uint8_t* out, const FbCaptureInfo& info) {
+    fbStreamPut16(out, info.width);
+    fbStreamPut16(out + 2, info.height);
+    out[4] = info.bits;
+    out[5] = info.rotation;
+    fbStreamPut16(out + 6, 0);
+}
+
+inline FbCaptureInfo fbCaptureDecodeInfo(const uint8_t* in) {
+    return FbCaptureInfo{fbStreamGet16(in), fbStreamGet16(in + 2), in[4], in[5]};
+}
+
+// 一个数据报能容纳的最多行数（至少1行）
+inline uint16_t fbStreamRowsPerDatagram(uint16_t width, size_t max_datagram = FB_STREAM_MAX_DATAGRAM) {
+    size_t rows = (max_datagram - FB_STREAM_HEADER_LENGTH) / width;
+    return static_cast<uint16_t>(rows ? rows : 1);
+}
+
+// 从显存（stride 字节/行）中取出矩形，组成一条 Rect 消息；返回消息总长度，缓冲区不足时返回0
+inline size_t fbStreamBuildRect(uint8_t* out, size_t capacity, const uint8_t* framebuffer, uint16_t stride,
+                                uint16_t col, uint16_t row, uint16_t width, uint16_t rows,
+                                uint16_t seq, uint8_t flags) {
+    const size_t total = FB_STREAM_HEADER_LENGTH + static_cast<size_t>(width) * rows;
+    if (total > capacity) return 0;
+    fbStreamEncodeHeader(out, FbStreamHeader{FbStreamType::Rect, flags, seq, col, row, width, rows});
+    uint8_t* dst = out + FB_STREAM_HEADER_LENGTH;
+    const uint8_t* src = framebuffer + static_cast<size_t>(row) * stride + col;
+    for (uint16_t r = 0; r < rows; r++) {
+        memcpy(dst, src, width);
+        dst += width;
+        src += stride;
+    }
+    return total;
+}
+
+// n 字节数据行程编码后的最大长度（全是字面量时每128字节多1个控制字节）
+constexpr size_t fbRleWorstCase(size_t n) {
+    return n + (n + 127) / 128;
+}
+
+// 行程编码 cur[i] ^ ref[i]（ref 为空时编码 cur 本身）；返回编码长度，超出 capacity 时返回 SIZE_MAX。
+// 异或数据末尾的0不输出。
+inline size_t fbRleEncode(const uint8_t* cur, const uint8_t* ref, size_t n, uint8_t* out, size_t capacity) {
+    auto value = [cur, ref](size_t i) -> uint8_t {
+        return ref ? static_cast<uint8_t>(cur[i] ^ ref[i]) : cur[i];
+    };
+    if (ref) {
+        while (n > 0 && cur[n - 1] == ref[n - 1]) n--;
+    }
+
+    size_t o = 0;
+    size_t literal_start = 0;
+    size_t literal_len = 0;
+    auto flushLiteral = [&]() -> bool {
+        while (literal_len > 0) {
+            size_t chunk = literal_len < 128 ? literal_len : 128;
+            if (o + 1 + chunk > capacity) return false;
+            out[o++] = static_cast<uint8_t>(chunk - 1);
+            for (size_t k = 0; k < chunk; k++) {
+                out[o++] = value(literal_start + k);
+            }
+            literal_start += chunk;
+            literal_len -= chunk;
+        }
+        return true;
+    };
+
+    size_t i = 0;
+    while (i < n) {
+        const uint8_t v = value(i);
+        size_t run = 1;
+        while (i + run < n && run < 129 && value(i + run) == v) run++;
+        // 重复3次以上才值得打断字面量；字面量为空时2次即可
+        if (run >= 3 || (run == 2 && literal_len == 0)) {
+            if (!flushLiteral() || o + 2 > capacity) return SIZE_MAX;
+            out[o++] = static_cast<uint8_t>(0x80 | (run - 2));
+            out[o++] = v;
+            i += run;
+            literal_start = i;
+        } else {
+            if (literal_len == 0) literal_start = i;
+            literal_len++;
+            i++;
+        }
+    }
+    if (!flushLiteral()) return SIZE_MAX;
+    return o;
+}
+
+// 流式解析器
+// 输入可以在任意位置切开（TCP分段、pbuf链、串口），负载按所在行直接写入显存目标位置，
+// 没有整条消息的暂存区；只有不足14字节的消息头和6字节的 Delta 前缀会先攒在内部。
+// 消息完整收到后才计入脏行区间；Rect 帧带 FLAG_FRAME_END 的消息完成、或 Delta 帧结束时置 frameReady()。
+class FbStreamParser {
+public:
+    enum class Error : uint8_t {
+        None,
+        BadMagic,
+        BadType,
+        BadGeometry,  // 矩形超出显存
+        BadEncoding,  // 行程编码输出超出矩形
+    };
+
+    FbStreamParser(uint8_t* framebuffer, uint16_t stride, uint16_t rows) :
+        framebuffer_(framebuffer), stride_(stride), rows_(rows)
+    {
+        reset();
+    }
+
+    // 字节流可能夹杂无关数据（串口）时打开：魔数不符不报错，逐字节向后寻找下一个魔数
+    void setResync(bool enabled) { resync_ = enabled; }
+
+    // 丢弃未完成的消息与累积的脏行；显存内容（已提交的帧号、是否需要关键帧）保留
+    void reset() {
+        abortMessage();
+        abortFrame();
+        error_ = Error::None;
+        dirty_first_ = UINT16_MAX;
+        dirty_end_ = 0;
+        frame_ready_ = false;
+        frame_seq_ = committed_seq_;
+    }
+
+    // 只丢弃未完成的消息（UDP数据报被截断时使用）；已完成消息的脏行保留。
+    // 写了一半的行带不会被确认，发送端下一帧会对它发关键行带
+    void abortMessage() {
+        header_fill_ = 0;
+        prefix_fill_ = 0;
+        phase_ = Phase::Header;
+        rle_count_ = 0;
+        rle_pending_value_ = false;
+    }
+
+    // 处理一段输入；出现协议错误时返回 false，之后的输入被忽略直到 reset()
+    bool consume(const uint8_t* data, size_t len) {
+        while (len > 0 && error_ == Error::None) {
+            size_t n = 0;
+            switch (phase_) {
+            case Phase::Header:
+                n = FB_STREAM_HEADER_LENGTH - header_fill_;
+                if (n > len) n = len;
+                memcpy(header_buf_ + header_fill_, data, n);
+                header_fill_ += static_cast<uint8_t>(n);
+                if (header_fill_ == FB_STREAM_HEADER_LENGTH) {
+                    header_fill_ = 0;
+                    beginMessage();
+                }
+                break;
+            case Phase::Prefix:
+                n = FB_STREAM_DELTA_PREFIX_LENGTH - prefix_fill_;
+                if (n > len) n = len;
+                memcpy(prefix_buf_ + prefix_fill_, data, n);
+                prefix_fill_ += static_cast<uint8_t>(n);
+                if (prefix_fill_ == FB_STREAM_DELTA_PREFIX_LENGTH) {
+                    prefix_fill_ = 0;
+                    beginDelta();
+                }
+                break;
+            case Phase::Payload:
+                n = header_.type == FbStreamType::Rect ? consumeRaw(data, len) : consumeRle(data, len);
+                break;
+            }
+            data += n;
+            len -= n;
+        }
+        return error_ == Error::None;
+    }
+
+    // 是否停在消息边界（数据报结束时用于判断截断）
+    bool atMessageBoundary() const { return phase_ == Phase::Header && header_fill_ == 0; }
+    Error error() const { return error_; }
+
+    bool hasDirtyRows() const { return dirty_end_ > dirty_first_; }
+    bool frameReady() const { return frame_ready_; }
+    // 应在 Ack 中回复的帧号：Rect 为带帧结束标志的消息 seq，Delta 为设备当前提交的帧
+    uint16_t frameSeq() const { return frame_seq_; }
+    // 显存内容未知（上电、被 Rect 改写），需要整帧关键行带
+    bool needKeyFrame() const { return need_key_; }
+    uint8_t ackFlags() const { return need_key_ ? FB_STREAM_FLAG_NEED_KEY : 0; }
+
+    // 取出并清空脏行区间；没有脏行时返回 false
+    bool takeDirtyRows(uint16_t& first_row, uint16_t& row_count) {
+        frame_ready_ = false;
+        if (!hasDirtyRows()) return false;
+        first_row = dirty_first_;
+        row_count = static_cast<uint16_t>(dirty_end_ - dirty_first_);
+        dirty_first_ = UINT16_MAX;
+        dirty_end_ = 0;
+        return true;
+    }
+
+    uint32_t messages() const { return messages_; }
+    uint32_t payloadBytes() const { return payload_bytes_; }
+    uint32_t encodedBytes() const { return encoded_bytes_; }
+    uint32_t rejectedFrames() const { return rejected_frames_; }
+    uint32_t resyncBytes() const { return resync_bytes_; }
+
+private:
+    enum class Phase : uint8_t { Header, Prefix, Payload };
+
+    void beginMessage() {
+        if (!fbStreamDecodeHeader(header_buf_, header_)) {
+            if (resync_) {
+                resyncHeader();
+                return;
+            }
+            error_ = Error::BadMagic;
+            return;
+        }
+        if (header_.type != FbStreamType::Rect && header_.type != FbStreamType::Delta) {
+            error_ = Error::BadType;
+            return;
+        }
+        if (header_.width == 0 || header_.col + header_.width > stride_ ||
+            header_.row + header_.rows > rows_) {
+            error_ = Error::BadGeometry;
+            return;
+        }
+        dst_ = framebuffer_ + static_cast<uint32_t>(header_.row) * stride_ + header_.col;
+        col_offset_ = 0;
+        out_remaining_ = static_cast<uint32_t>(header_.width) * header_.rows;
+
+        if (header_.type == FbStreamType::Delta) {
+            phase_ = Phase::Prefix;
+            return;
+        }
+        write_ = true;
+        xor_ = false;
+        phase_ = Phase::Payload;
+        if (out_remaining_ == 0) {
+            completeMessage();
+        }
+    }
+
+    // 消息头魔数不符：丢掉第一个字节，从下一个可能的魔数处继续
+    void resyncHeader() {
+        uint8_t k = 1;
+        while (k < FB_STREAM_HEADER_LENGTH) {
+            if (header_buf_[k] == static_cast<uint8_t>(FB_STREAM_MAGIC) &&
+                (k + 1 == FB_STREAM_HEADER_LENGTH || header_buf_[k + 1] == static_cast<uint8_t>(FB_STREAM_MAGIC >> 8))) {
+                break;
+            }
+            k++;
+        }
+        memmove(header_buf_, header_buf_ + k, FB_STREAM_HEADER_LENGTH - k);
+        header_fill_ = static_cast<uint8_t>(FB_STREAM_HEADER_LENGTH - k);
+        resync_bytes_ += k;
+    }
+
+    void beginDelta() {
+        prefix_.base_seq = fbStreamGet16(prefix_buf_);
+        prefix_.part = prefix_buf_[2];
+        prefix_.parts = prefix_buf_[3];
+        prefix_.length = fbStreamGet16(prefix_buf_ + 4);
+        const bool key = (header_.flags & FB_STREAM_FLAG_KEY) != 0;
+
+        if (frame_active_ && header_.seq != frame_seq_in_progress_) {
+            // 上一帧缺了消息，不提交
+            finishFrame(false);
+        }
+        if (!frame_active_) {
+            frame_active_ = true;
+            frame_seq_in_progress_ = header_.seq;
+            frame_all_key_ = true;
+            frame_rejected_ = false;
+            frame_parts_ = prefix_.parts;
+            frame_received_ = 0;
+        }
+        if (!key) {
+            frame_all_key_ = false;
+            if (!frame_rejected_ && (need_key_ || prefix_.base_seq != committed_seq_)) {
+                frame_rejected_ = true;
+                rejected_frames_++;
+            }
+        }
+
+        // 关键行带与基准无关，总是写入；差分行带只在基准相符时写入
+        write_ = key || !frame_rejected_;
+        xor_ = !key;
+        encoded_remaining_ = prefix_.length;
+        rle_count_ = 0;
+        rle_pending_value_ = false;
+        phase_ = Phase::Payload;
+        if (encoded_remaining_ == 0) {
+            completeMessage();
+        }
+    }
+
+    // 把 n 个输出字节写到矩形的当前位置：src 为空时是重复 value
+    void emit(const uint8_t* src, uint8_t value, uint32_t n) {
+        out_remaining_ -= n;
+        while (n > 0) {
+            uint32_t seg = header_.width - col_offset_;
+            if (seg > n) seg = n;
+            uint8_t* p = dst_ + col_offset_;
+            if (write_) {
+                if (src) {
+                    if (xor_) {
+                        for (uint32_t i = 0; i < seg; i++) p[i] ^= src[i];
+                    } else {
+                        memcpy(p, src, seg);
+                    }
+                } else if (!xor_) {
+                    memset(p, value, seg);
+                } else if (value != 0) {
+                    for (uint32_t i = 0; i < seg; i++) p[i] ^= value;
+                }
+            }
+            if (src) src += seg;
+            col_offset_ += static_cast<uint16_t>(seg);
+            if (col_offset_ == header_.width) {
+                col_offset_ = 0;
+                dst_ += stride_;
+            }
+            n -= seg;
+        }
+    }
+
+    size_t consumeRaw(const uint8_t* data, size_t len) {
+        uint32_t n = out_remaining_;
+        if (n > len) n = static_cast<uint32_t>(len);
+        emit(data, 0, n);
+        if (out_remaining_ == 0) {
+            completeMessage();
+        }
+        return n;
+    }
+
+    size_t consumeRle(const uint8_t* data, size_t len) {
+        size_t used = 0;
+        while (used < len && encoded_remaining_ > 0) {
+            if (rle_pending_value_) {
+                // 重复段的值
+                rle_pending_value_ = false;
+                emit(nullptr, data[used], rle_count_);
+                rle_count_ = 0;
+                used++;
+                encoded_remaining_--;
+            } else if (rle_count_ > 0) {
+                // 字面量段
+                uint32_t n = rle_count_;
+                if (n > len - used) n = static_cast<uint32_t>(len - used);
+                if (n > encoded_remaining_) n = encoded_remaining_;
+                emit(data + used, 0, n);
+                rle_count_ -= n;
+                used += n;
+                encoded_remaining_ -= static_cast<uint16_t>(n);
+            } else {
+                const uint8_t c = data[used++];
+                encoded_remaining_--;
+                if (c & 0x80) {
+                    rle_count_ = (c & 0x7F) + 2u;
+                    rle_pending_value_ = true;
+                } else {
+                    rle_count_ = c + 1u;
+                }
+                if (rle_count_ > out_remaining_) {
+                    error_ = Error::BadEncoding;
+                    return used;
+                }
+            }
+        }
+        if (encoded_remaining_ == 0) {
+            if (rle_count_ > 0) {
+                error_ = Error::BadEncoding;  // 段的数据被截断
+                return used;
+            }
+            completeMessage();
+        }
+        return used;
+    }
+
+    void addDirty(uint16_t row, uint16_t rows) {
+        if (rows == 0) return;
+        if (row < dirty_first_) dirty_first_ = row;
+        if (row + rows > dirty_end_) dirty_end_ = row + rows;
+    }
+
+    void completeMessage() {
+        phase_ = Phase::Header;
+        messages_++;
+
+        if (header_.type == FbStreamType::Rect) {
+            payload_bytes_ += header_.payloadLength();
+            addDirty(header_.row, header_.rows);
+            need_key_ = true;  // 显存不再等于差分发送端的参考帧
+            if (header_.flags & FB_STREAM_FLAG_FRAME_END) {
+                frame_ready_ = true;
+                frame_seq_ = header_.seq;
+            }
+            return;
+        }
+
+        encoded_bytes_ += prefix_.length;
+        if (write_) {
+            payload_bytes_ += static_cast<uint32_t>(header_.width) * header_.rows;
+            addDirty(header_.row, header_.rows);
+        }
+        frame_received_++;
+        if (frame_received_ >= frame_parts_) {
+            finishFrame(true);
+        } else if (header_.flags & FB_STREAM_FLAG_FRAME_END) {
+            finishFrame(false);
+        }
+    }
+
+    // 结束当前 Delta 帧：complete 为 false 表示有消息丢失，不提交
+    void finishFrame(bool complete) {
+        if (complete && !frame_rejected_) {
+            committed_seq_ = frame_seq_in_progress_;
+            if (frame_all_key_) need_key_ = false;
+        }
+        frame_active_ = false;
+        frame_ready_ = true;
+        frame_seq_ = committed_seq_;
+    }
+
+    void abortFrame() {
+        frame_active_ = false;
+    }
+
+    uint8_t* framebuffer_;
+    uint16_t stride_;
+    uint16_t rows_;
+    bool resync_ = false;
+
+    Phase phase_ = Phase::Header;
+    uint8_t header_buf_[FB_STREAM_HEADER_LENGTH];
+    uint8_t header_fill_ = 0;
+    uint8_t prefix_buf_[FB_STREAM_DELTA_PREFIX_LENGTH];
+    uint8_t prefix_fill_ = 0;
+    FbStreamHeader header_{};
+    FbDeltaPrefix prefix_{};
+    uint8_t* dst_ = nullptr;       // 当前行在显存中的起点
+    uint16_t col_offset_ = 0;      // 当前行已写入的字节数
+    uint32_t out_remaining_ = 0;   // 本条消息矩形内尚未输出的字节
+    bool write_ = false;           // false: 只消耗输入（被拒绝的差分帧）
+    bool xor_ = false;
+    uint16_t encoded_remaining_ = 0;
+    uint32_t rle_count_ = 0;       // 当前段剩余的输出字节
+    bool rle_pending_value_ = false;
+
+    // 差分帧状态（描述显存内容，reset() 不清除）
+    uint16_t committed_seq_ = 0;
+    bool need_key_ = true;         // 上电时显存内容未知
+    bool frame_active_ = false;
+    uint16_t frame_seq_in_progress_ = 0;
+    bool frame_all_key_ = false;
+    bool frame_rejected_ = false;
+    uint8_t frame_parts_ = 0;
+    uint8_t frame_received_ = 0;
+
+    Error error_ = Error::None;
+    uint16_t dirty_first_ = UINT16_MAX;
+    uint16_t dirty_end_ = 0;
+    bool frame_ready_ = false;
+    uint16_t frame_seq_ = 0;
+
+    uint32_t messages_ = 0;
+    uint32_t payload_bytes_ = 0;
+    uint32_t encoded_bytes_ = 0;
+    uint32_t rejected_frames_ = 0;
+    uint32_t resync_bytes_ = 0;
+};
+
+// 差分编码器（主机端工具与设备端共用，不分配内存）
+// reference 保存设备已确认的帧，pending 保存已发出、等待确认的帧，均为 stride × rows 字节，由调用者提供。
+// 每帧按整行宽的行带切分（行带大小保证最坏情况也放得进一个数据报），和参考帧逐带比较，
+// 只发送有变化的行带。一次只允许一帧在途：收到该帧的 Ack 后它才成为新的参考帧；
+// 没有确认（Ack 超时或 Ack 仍是旧帧）时本帧发过的行带记为不确定，下一帧对它们发关键行带。
+class FbDeltaEncoder {
+public:
+    static constexpr uint16_t MAX_BANDS = 255;  // parts 字段只有8位
+
+    struct FrameStats {
+        uint16_t seq;
+        uint8_t messages;
+        uint8_t key_bands;
+        uint16_t changed_rows;  // 发送的字节行
+        uint32_t raw_bytes;     // 发送行带的原始字节数
+        uint32_t wire_bytes;    // 实际消息字节数（含消息头与前缀）
+    };
+
+    FbDeltaEncoder(uint8_t* reference, uint8_t* pending, uint16_t stride, uint16_t rows,
+                   size_t max_message = FB_STREAM_MAX_DATAGRAM) :
+        reference_(reference), pending_(pending), stride_(stride), rows_(rows)
+    {
+        if (max_message > FB_STREAM_MAX_DATAGRAM) max_message = FB_STREAM_MAX_DATAGRAM;
+        max_message_ = max_message;
+        // 最坏情况：全部是字面量
+        size_t budget = (max_message - FB_STREAM_HEADER_LENGTH - FB_STREAM_DELTA_PREFIX_LENGTH) * 128 / 129;
+        size_t band = budget / stride;
+        if (band == 0) band = 1;
+        const size_t min_band = (rows + MAX_BANDS - 1) / MAX_BANDS;
+        band_rows_ = static_cast<uint16_t>(band > min_band ? band : min_band);
+        band_count_ = static_cast<uint16_t>((rows + band_rows_ - 1) / band_rows_);
+    }
+
+    // 编码一帧（stride × rows 字节）；每条消息调用一次 emit(const uint8_t* data, size_t len)
+    template <class Emit>
+    const FrameStats& encode(const uint8_t* frame, Emit&& emit) {
+        memcpy(pending_, frame, static_cast<size_t>(stride_) * rows_);
+        const bool all_key = key_requested_ || !has_reference_;
+        key_requested_ = false;
+        seq_++;
+
+        uint8_t kinds[MAX_BANDS];  // 0: 不发送  1: 差分  2: 关键
+        uint8_t parts = 0;
+        for (uint16_t b = 0; b < band_count_; b++) {
+            kinds[b] = all_key || testBit(uncertain_, b) ? 2 : (bandChanged(b) ? 1 : 0);
+            if (kinds[b]) parts++;
+        }
+
+        stats_ = FrameStats{seq_, 0, 0, 0, 0, 0};
+        memset(sent_, 0, sizeof(sent_));
+        uint8_t part = 0;
+        for (uint16_t b = 0; b < band_count_; b++) {
+            if (!kinds[b]) continue;
+            emitBand(b, kinds[b] == 2, part++, parts, emit);
+            setBit(sent_, b);
+        }
+        if (parts == 0) {
+            // 没有变化也发一条空消息，设备据此回 Ack
+            emitEmpty(emit);
+        }
+        return stats_;
+    }
+
+    // 处理设备的 Ack；返回 true 表示在途的帧已被确认并成为新的参考帧
+    bool onAck(const FbStreamHeader& ack) {
+        if (ack.type != FbStreamType::Ack) return false;
+        if (ack.flags & FB_STREAM_FLAG_NEED_KEY) {
+            key_requested_ = true;
+            return false;
+        }
+        if (ack.seq == seq_) {
+            memcpy(reference_, pending_, static_cast<size_t>(stride_) * rows_);
+            memset(uncertain_, 0, sizeof(uncertain_));
+            acked_seq_ = seq_;
+            has_reference_ = true;
+            return true;
+        }
+        if (has_reference_ && ack.seq == acked_seq_) {
+            markSentUncertain();  // 本帧没有提交，到达的行带已经改写
+        } else {
+            key_requested_ = true;  // 设备停在未知的帧上
+        }
+        return false;
+    }
+
+    // 在途的帧没有收到 Ack：设备可能已提交，也可能只改写了部分行带
+    void onTimeout() { markSentUncertain(); }
+    void requestKeyFrame() { key_requested_ = true; }
+
+    bool hasReference() const { return has_reference_; }
+    uint16_t ackedSeq() const { return acked_seq_; }
+    uint16_t lastSeq() const { return seq_; }
+    uint16_t bandRows() const { return band_rows_; }
+    const FrameStats& lastFrame() const { return stats_; }
+
+private:
+    static bool testBit(const uint32_t* bits, uint16_t i) { return (bits[i / 32] >> (i % 32)) & 1u; }
+    static void setBit(uint32_t* bits, uint16_t i) { bits[i / 32] |= 1u << (i % 32); }
+
+    uint16_t bandRowCount(uint16_t band) const {
+        const uint16_t row = static_cast<uint16_t>(band * band_rows_);
+        return static_cast<uint16_t>(rows_ - row < band_rows_ ? rows_ - row : band_rows_);
+    }
+
+    bool bandChanged(uint16_t band) const {
+        const size_t offset = static_cast<size_t>(band) * band_rows_ * stride_;
+        return memcmp(pending_ + offset, reference_ + offset, static_cast<size_t>(bandRowCount(band)) * stride_) != 0;
+    }
+
+    void markSentUncertain() {
+        for (size_t i = 0; i < sizeof(uncertain_) / sizeof(uncertain_[0]); i++) {
+            uncertain_[i] |= sent_[i];
+        }
+        memset(sent_, 0, sizeof(sent_));
+    }
+
+    void writeHeader(uint8_t flags, uint16_t row, uint16_t rows, uint8_t part, uint8_t parts, size_t encoded) {
+        fbStreamEncodeHeader(message_, FbStreamHeader{FbStreamType::Delta, flags, seq_, 0, row, stride_, rows});
+        uint8_t* prefix = message_ + FB_STREAM_HEADER_LENGTH;
+        fbStreamPut16(prefix, acked_seq_);
+        prefix[2] = part;
+        prefix[3] = parts;
+        fbStreamPut16(prefix + 4, static_cast<uint16_t>(encoded));
+    }
+
+    template <class Emit>
+    void emitBand(uint16_t band, bool key, uint8_t part, uint8_t parts, Emit& emit) {
+        const uint16_t row = static_cast<uint16_t>(band * band_rows_);
+        const uint16_t rows = bandRowCount(band);
+        const size_t offset = static_cast<size_t>(row) * stride_;
+        const size_t n = static_cast<size_t>(rows) * stride_;
+        uint8_t* body = message_ + FB_STREAM_HEADER_LENGTH + FB_STREAM_DELTA_PREFIX_LENGTH;
+        const size_t capacity = max_message_ - FB_STREAM_HEADER_LENGTH - FB_STREAM_DELTA_PREFIX_LENGTH;
+        size_t encoded = fbRleEncode(pending_ + offset, key ? nullptr : reference_ + offset, n, body, capacity);
+        if (encoded == SIZE_MAX) encoded = 0;  // 行带大小保证不会发生
+
+        const uint8_t flags = static_cast<uint8_t>((key ? FB_STREAM_FLAG_KEY : 0) |
+                                                   (part + 1 == parts ? FB_STREAM_FLAG_FRAME_END : 0));
+        writeHeader(flags, row, rows, part, parts, encoded);
+        const size_t total = FB_STREAM_HEADER_LENGTH + FB_STREAM_DELTA_PREFIX_LENGTH + encoded;
+        emit(static_cast<const uint8_t*>(message_), total);
+        stats_.messages++;
+        if (key) stats_.key_bands++;
+        stats_.changed_rows += rows;
+        stats_.raw_bytes += static_cast<uint32_t>(n);
+        stats_.wire_bytes += static_cast<uint32_t>(total);
+    }
+
+    template <class Emit>
+    void emitEmpty(Emit& emit) {
+        writeHeader(FB_STREAM_FLAG_FRAME_END, 0, 0, 0, 1, 0);
+        const size_t total = FB_STREAM_HEADER_LENGTH + FB_STREAM_DELTA_PREFIX_LENGTH;
+        emit(static_cast<const uint8_t*>(message_), total);
+        stats_.messages++;
+        stats_.wire_bytes += static_cast<uint32_t>(total);
+    }
+
+    uint8_t* reference_;
+    uint8_t* pending_;
+    uint16_t stride_;
+    uint16_t rows_;
+    size_t max_message_;
+    uint16_t band_rows_;
+    uint16_t band_count_;
+    uint16_t seq_ = 0;
+    uint16_t acked_seq_ = 0;
+    bool has_reference_ = false;
+    bool key_requested_ = true;
+    uint32_t sent_[(MAX_BANDS + 31) / 32] = {};       // 在途帧发过的行带
+    uint32_t uncertain_[(MAX_BANDS + 31) / 32] = {};  // 设备上内容未知的行带
+    FrameStats stats_{};
+    uint8_t message_[FB_STREAM_MAX_DATAGRAM];
+};
+
+} // namespace net
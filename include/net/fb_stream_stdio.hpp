@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstdint>
+#include "frame_sink.hpp"
+
+namespace net {
+
+// 通过 stdio（USB CDC）接收帧缓冲流，开发时从主机推屏，不需要WiFi
+// 主机发送与TCP相同的字节流（Rect 或 Delta 消息）。poll() 非阻塞地读取已到达的字节，
+// 每次最多 byte_budget 字节，不拖慢主循环；Ack 以原始字节写回（不做换行转换），
+// 主机端按魔数把 Ack 从 printf 日志中分离出来。输入中夹杂的无关字节按魔数重新同步。
+class StdioFrameReceiver {
+public:
+    using Stats = FrameStreamStats;
+
+    static constexpr uint32_t DEFAULT_BYTE_BUDGET = 2048;
+    static constexpr uint32_t DEFAULT_IDLE_RESET_MS = 200;  // 消息中途停顿超过此时间则丢弃半条消息
+
+    explicit StdioFrameReceiver(FrameSink& sink);
+
+    void poll(uint32_t byte_budget = DEFAULT_BYTE_BUDGET);
+
+    void setIdleResetMs(uint32_t ms) { idle_reset_us_ = ms * 1000; }
+    const Stats& stats() const { return stats_; }
+
+private:
+    void sendAck(const uint8_t* msg);
+
+    FrameSink& sink_;
+    FbStreamParser parser_;
+    uint32_t idle_reset_us_;
+    uint64_t last_data_us_;
+    Stats stats_;
+};
+
+} // namespace net
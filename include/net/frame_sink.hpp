@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstdint>
+#include "pico/stdlib.h"
+#include "fb_stream_protocol.hpp"
+
+namespace net {
+
+// 帧缓冲流的显示目标：提供显存与按字节行刷新
+class FrameSink {
+public:
+    virtual ~FrameSink() = default;
+
+    virtual uint8_t* buffer() = 0;
+    virtual uint16_t stride() const = 0;  // 每字节行的字节数
+    virtual uint16_t rows() const = 0;    // 字节行数
+    virtual void flushRows(uint16_t first_row, uint16_t row_count) = 0;
+};
+
+// 驱动适配：Display 需提供 Packing、framebuffer().data() 与 displayRows()（如 ST7306Driver 灰度模式）
+template <class Display>
+class DisplayFrameSink : public FrameSink {
+public:
+    explicit DisplayFrameSink(Display& display) : display_(display) {}
+
+    uint8_t* buffer() override { return display_.framebuffer().data(); }
+    uint16_t stride() const override { return Display::Packing::STRIDE; }
+    uint16_t rows() const override { return Display::Packing::ROWS; }
+    void flushRows(uint16_t first_row, uint16_t row_count) override {
+        display_.displayRows(first_row, row_count);
+    }
+
+private:
+    Display& display_;
+};
+
+// 各种传输方式（UDP/TCP、stdio）共用的接收统计
+struct FrameStreamStats {
+    uint32_t messages;       // 完整收到的消息
+    uint32_t payload_bytes;  // 写入显存的字节（Delta 为解码后的字节）
+    uint32_t encoded_bytes;  // Delta 行程编码数据的字节
+    uint32_t frames;         // 刷新次数
+    uint32_t flushed_rows;   // 累计刷新的字节行
+    uint32_t errors;         // 协议错误、截断的消息
+    uint32_t rejected;       // 基准不符而丢弃的差分帧
+    uint64_t flush_us;       // 累计刷新耗时
+};
+
+// 刷新解析器累积的脏行、更新统计，并在 ack 中生成应回复的 Ack 消息（FB_STREAM_HEADER_LENGTH 字节）
+inline void flushStreamFrame(FbStreamParser& parser, FrameSink& sink, FrameStreamStats& stats, uint8_t* ack) {
+    const uint16_t seq = parser.frameSeq();
+    uint16_t first_row = 0;
+    uint16_t row_count = 0;
+    if (parser.takeDirtyRows(first_row, row_count)) {
+        uint64_t start = time_us_64();
+        sink.flushRows(first_row, row_count);
+        stats.flush_us += time_us_64() - start;
+        stats.frames++;
+        stats.flushed_rows += row_count;
+    }
+    stats.messages = parser.messages();
+    stats.payload_bytes = parser.payloadBytes();
+    stats.encoded_bytes = parser.encodedBytes();
+    stats.rejected = parser.rejectedFrames();
+    if (ack) {
+        fbStreamEncodeAck(ack, seq, parser.ackFlags(), first_row, row_count);
+    }
+}
+
+} // namespace net
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstdint>
+#include "lwip/err.h"
+#include "lwip/ip_addr.h"
+#include "frame_sink.hpp"
+
+struct udp_pcb;
+struct tcp_pcb;
+struct pbuf;
+
+namespace net {
+
+// 帧缓冲服务器（lwIP原始API，NO_SYS/poll模式），协议见 fb_stream_protocol.hpp（Rect 与 Delta 消息都支持）
+// UDP模式：每个数据报一条消息，截断或出错的数据报丢弃；回复发往最近一次发来数据的地址。
+// TCP模式：同一时间接受一个客户端，消息可跨分段。
+// 收到的pbuf链逐段交给解析器，负载直接写入显存目标行，没有中间拷贝。
+// poll() 在收到帧结束标志（或数据停顿超过 flush_timeout）后只刷新累积的脏行，并回复 Ack。
+class FramebufferServer {
+public:
+    enum class Mode : uint8_t { Udp, Tcp };
+
+    using Stats = FrameStreamStats;
+
+    static constexpr uint32_t DEFAULT_FLUSH_TIMEOUT_MS = 100;
+
+    explicit FramebufferServer(FrameSink& sink);
+    ~FramebufferServer();
+
+    FramebufferServer(const FramebufferServer&) = delete;
+    FramebufferServer& operator=(const FramebufferServer&) = delete;
+
+    // 创建并绑定监听的pcb；必须在网络栈初始化之后调用
+    bool begin(Mode mode, uint16_t port = FB_STREAM_PORT);
+    void end();
+
+    // 刷新已完成的更新并回复 Ack；在主循环中调用
+    void poll();
+
+    // 没有帧结束标志时（例如UDP丢了最后一个数据报），数据停顿多久后仍刷新已收到的行
+    void setFlushTimeoutMs(uint32_t ms) { flush_timeout_us_ = ms * 1000; }
+
+    Mode mode() const { return mode_; }
+    bool clientConnected() const { return client_ != nullptr; }
+    const Stats& stats() const { return stats_; }
+
+private:
+    static void udpRecv(void* arg, struct udp_pcb* pcb, struct pbuf* p, const ip_addr_t* addr, uint16_t port);
+    static err_t tcpAccept(void* arg, struct tcp_pcb* pcb, err_t err);
+    static err_t tcpRecv(void* arg, struct tcp_pcb* pcb, struct pbuf* p, err_t err);
+    static void tcpError(void* arg, err_t err);
+
+    void consumeChain(const struct pbuf* p);
+    void flush(bool ack);
+    void sendAck(const uint8_t* msg);
+    void closeClient();
+
+    FrameSink& sink_;
+    FbStreamParser parser_;
+    Mode mode_;
+    struct udp_pcb* udp_;
+    struct tcp_pcb* listener_;
+    struct tcp_pcb* client_;
+    ip_addr_t peer_addr_;  // UDP模式下回复的地址
+    uint16_t peer_port_;
+    bool have_peer_;
+    uint32_t flush_timeout_us_;
+    uint64_t last_data_us_;
+    Stats stats_;
+};
+
+} // namespace net
@@ -0,0 +1,182 @@
+#pragma once
+
+#include <cstdint>
+#include "lwip/ip_addr.h"
+
+struct udp_pcb;
+struct pbuf;
+
+namespace net {
+
+// NTP时间戳：高32位为自1900年起的秒，低32位为秒的小数
+using NtpTimestamp = uint64_t;
+
+constexpr uint16_t NTP_PORT = 123;
+constexpr uint16_t NTP_PACKET_LENGTH = 48;
+constexpr uint32_t NTP_UNIX_DELTA = 2208988800u;  // 1900-01-01 到 1970-01-01 的秒数
+
+// Unix微秒 <-> NTP时间戳（NTP第0纪元到2036年；秒字段小于 2^31 时按第1纪元处理）
+NtpTimestamp ntpFromUnixUs(int64_t unix_us);
+int64_t unixUsFromNtp(NtpTimestamp ts);
+
+// 本地时钟
+// 以 time_us_64() 为振荡源，用参考点 (ref_boot_us, ref_unix_us) 与频率修正 drift_ppb 换算UTC：
+//   unix_us = ref_unix_us + dt + dt * drift_ppb / 1e9，dt = boot_us - ref_boot_us
+// 每次对时得到一个偏移样本：参考点直接拉到正确时间（显示用途，毫秒级跳变不可见），
+// 并用"偏移 / 距上次对时的间隔"修正频率，两次对时之间由频率修正补偿晶振误差。
+class DisciplinedClock {
+public:
+    static constexpr int32_t MAX_DRIFT_PPB = 500000;        // 频率修正上限 ±500ppm
+    static constexpr uint64_t MIN_DRIFT_INTERVAL_US = 16000000;  // 间隔太短时偏移以噪声为主，不估频率
+
+    DisciplinedClock();
+
+    // 设定当前时间（未同步，例如模拟时间），频率修正保持不变
+    void setUnixUs(int64_t unix_us);
+
+    // 当前UTC时间（自1970年起的微秒）
+    int64_t nowUs() const;
+
+    // 开机时间与UTC时间互换（用于把"整秒"换算成定时器闹钟的时刻）
+    int64_t toUnixUs(uint64_t boot_us) const;
+    uint64_t toBootUs(int64_t unix_us) const;
+
+    // 应用一次对时结果：offset_us 为"服务器时间 - 本地时间"，boot_us 为测量时刻
+    void applyOffset(int64_t offset_us, uint64_t boot_us);
+
+    bool synced() const { return synced_; }
+    int32_t driftPpb() const { return drift_ppb_; }
+    uint64_t lastSyncBootUs() const { return last_sync_boot_us_; }
+
+private:
+    void reanchor(uint64_t boot_us, int64_t unix_us);
+
+    uint64_t ref_boot_us_;
+    int64_t ref_unix_us_;
+    int32_t drift_ppb_;
+    bool synced_;
+    uint64_t last_sync_boot_us_;
+};
+
+// 一次SNTP测量的结果
+struct SntpSample {
+    int64_t offset_us;   // 服务器 - 本地
+    int64_t delay_us;    // 往返延迟（扣除服务器处理时间）
+    uint64_t boot_us;    // 收到回复的开机时间
+    uint8_t stratum;
+};
+
+// 单个服务器的地址缓存与统计
+struct SntpServerStats {
+    const char* host;        // IP字符串或域名（调用者保持有效）
+    ip_addr_t addr;
+    uint64_t dns_expiry_us;  // 解析结果有效期（开机时间）；0 表示需要解析
+    uint8_t reach;           // 最近8轮是否有回复，bit0 为最近一轮
+    uint32_t samples;        // 有效回复总数
+    int64_t delay_avg_us;    // 往返延迟的指数平均（1/4）
+    int64_t jitter_us;       // 往返延迟波动的指数平均（1/4）
+    SntpSample last;         // 最近一次有效回复
+};
+
+// 非阻塞多服务器SNTP客户端（lwIP原始API，NO_SYS/poll模式）
+// 整个生命周期只创建一个 udp_pcb，一轮对时同时向所有服务器发出请求，按源地址区分回复。
+// start() 只发起请求就返回；回复在 cyw43_arch_poll() 里由lwIP回调处理，超时、重发与
+// 本轮收尾在 poll() 里处理，任何调用都不会等待网络。
+//
+// 用四个时间戳计算偏移与往返延迟：
+//   T1 本地发送  T2 服务器接收  T3 服务器发送  T4 本地接收
+//   offset = ((T2 - T1) + (T3 - T4)) / 2    delay = (T4 - T1) - (T3 - T2)
+// 回复的 originate 字段必须等于发给该服务器的 T1，过期或伪造的回复直接丢弃。
+//
+// 收到第一个有效回复后最多再等 collect_window，所有服务器都有结果时立即结束，
+// 慢速或失效的服务器不会拖慢整轮。本轮的候选样本按 delay + jitter 评分，
+// 只把得分最低的一个应用到时钟（偏移误差上限为 delay/2，延迟小且稳定的样本最可信）。
+//
+// 域名解析结果缓存 dns_ttl（lwIP的回调不提供记录的TTL，这里作为上限；lwIP自身的DNS表
+// 按记录TTL过期）；某个域名服务器整轮无回复时丢弃其缓存，下一轮重新解析（适合 pool.ntp.org 轮换）。
+class SntpClient {
+public:
+    enum class State : uint8_t {
+        Idle,     // 未开始
+        Running,  // 本轮进行中
+        Done,     // 本轮成功，结果已应用到时钟
+        Failed,   // 本轮没有任何有效回复
+    };
+
+    static constexpr uint8_t MAX_SERVERS = 4;
+    static constexpr uint32_t DEFAULT_TIMEOUT_MS = 2000;
+    static constexpr uint8_t DEFAULT_MAX_TRIES = 3;
+    static constexpr uint32_t DEFAULT_COLLECT_WINDOW_MS = 300;
+    static constexpr uint32_t DEFAULT_DNS_TTL_S = 3600;
+
+    explicit SntpClient(DisciplinedClock& clock);
+    ~SntpClient();
+
+    SntpClient(const SntpClient&) = delete;
+    SntpClient& operator=(const SntpClient&) = delete;
+
+    // 创建并绑定 udp_pcb；必须在网络栈初始化之后调用
+    bool begin();
+    void end();
+
+    // 服务器列表（本轮进行中不能修改）；满或忙时返回 false
+    bool addServer(const char* host);
+    void clearServers();
+    uint8_t serverCount() const { return server_count_; }
+    const SntpServerStats& server(uint8_t index) const { return servers_[index].stats; }
+
+    void setCollectWindowMs(uint32_t ms) { collect_window_us_ = ms * 1000; }
+    void setDnsTtlSeconds(uint32_t seconds) { dns_ttl_us_ = static_cast<uint64_t>(seconds) * 1000000; }
+
+    // 发起一轮对时；没有服务器或上一轮仍在进行时返回 false
+    bool start(uint32_t timeout_ms = DEFAULT_TIMEOUT_MS, uint8_t max_tries = DEFAULT_MAX_TRIES);
+
+    // 处理超时、重发与本轮收尾；在主循环中调用，不阻塞
+    void poll();
+
+    // 放弃当前这一轮
+    void cancel();
+
+    State state() const { return state_; }
+    bool busy() const { return state_ == State::Running; }
+    // 本轮被采用的样本与服务器（state() == Done 时有效）
+    const SntpSample& lastSample() const { return sample_; }
+    int8_t selectedServer() const { return selected_; }
+
+private:
+    enum class SlotState : uint8_t { Idle, Resolving, Waiting, Replied, Failed };
+
+    struct Slot {
+        SntpClient* owner;
+        SntpServerStats stats;
+        SlotState state;
+        uint8_t tries;
+        uint64_t deadline_us;
+        NtpTimestamp request_t1;  // 发出的 T1（用于匹配 originate）
+        SntpSample sample;        // 本轮样本（state == Replied 时有效）
+    };
+
+    static void dnsFound(const char* name, const ip_addr_t* addr, void* arg);
+    static void recv(void* arg, struct udp_pcb* pcb, struct pbuf* p, const ip_addr_t* addr, uint16_t port);
+
+    void startSlot(Slot& slot, uint64_t now_us);
+    void sendRequest(Slot& slot);
+    void handleReply(struct pbuf* p, const ip_addr_t* addr, uint16_t port, uint64_t recv_boot_us);
+    bool slotPending(const Slot& slot) const;
+    void finishRound();
+
+    DisciplinedClock& clock_;
+    struct udp_pcb* pcb_;
+    Slot servers_[MAX_SERVERS];
+    uint8_t server_count_;
+    State state_;
+    uint8_t max_tries_;
+    uint32_t timeout_us_;
+    uint32_t collect_window_us_;
+    uint64_t dns_ttl_us_;
+    uint64_t first_reply_us_;  // 本轮第一个有效回复的时间；0 表示尚无
+    SntpSample sample_;
+    int8_t selected_;
+};
+
+} // namespace net
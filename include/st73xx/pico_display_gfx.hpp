@@ -20,6 +20,15 @@ public:
     // 新增灰度像素绘制函数
     void drawPixelGray(int16_t x, int16_t y, uint8_t gray);
 
+    // 灰度直线与径向线段（需要驱动支持 plotPixelGrayRaw，如ST7306）
+    // ST73XX_UI 的图元只有黑白两色，需要保留灰度的刻度、指针用这两个函数；逐点经过 drawPixelGray 的裁剪与旋转
+    void drawLineGray(int16_t x0, int16_t y0, int16_t x1, int16_t y1, uint8_t gray);
+    void drawRadialLineGray(int16_t cx, int16_t cy, int16_t r0, int16_t r1, st73xx::Angle angle, uint8_t gray);
+
+protected:
+    // 矩形填充直接交给驱动的显存内核，按字节整块写入
+    void writeRect(uint x, uint y, uint w, uint h, uint16_t color) override;
+
 private:
     Driver& driver_; // 底层驱动的引用
 };
@@ -24,30 +24,58 @@ void PicoDisplayGFX<Driver>::writePoint(uint x, uint y, uint16_t color) {
     driver_.plotPixelRaw(x, y, (color != 0));
 }
 
+template<typename Driver>
+void PicoDisplayGFX<Driver>::writeRect(uint x, uint y, uint w, uint h, uint16_t color) {
+    driver_.fillRectRaw(x, y, w, h, (color != 0));
+}
+
 template<typename Driver>
 void PicoDisplayGFX<Driver>::drawPixelGray(int16_t x, int16_t y, uint8_t gray) {
-    if ((x >= 0) && (x < WIDTH) && (y >= 0) && (y < HEIGHT)) {
-        int16_t tx = x, ty = y;
-        switch (rotation_) {
-        case 1:
-            tx = y;
-            ty = _width - 1 - x;
-            break;
-        case 2:
-            tx = _width - 1 - x;
-            ty = _height - 1 - y;
-            break;
-        case 3:
-            tx = _height - 1 - y;
-            ty = x;
-            break;
-        }
+    // 与 drawPixel 相同的原点、裁剪和旋转处理
+    int16_t tx, ty;
+    if (mapPoint(x, y, tx, ty)) {
         // 确保灰度值在0-3范围内
         uint8_t level = gray & 0x03;
         driver_.plotPixelGrayRaw(static_cast<uint>(tx), static_cast<uint>(ty), level);
     }
 }
 
+template<typename Driver>
+void PicoDisplayGFX<Driver>::drawLineGray(int16_t x0, int16_t y0, int16_t x1, int16_t y1, uint8_t gray) {
+    int32_t dx = x1 > x0 ? x1 - x0 : x0 - x1;
+    int32_t dy = y1 > y0 ? y1 - y0 : y0 - y1;
+    int32_t sx = x0 < x1 ? 1 : -1;
+    int32_t sy = y0 < y1 ? 1 : -1;
+    int32_t err = dx - dy;
+    int32_t x = x0;
+    int32_t y = y0;
+
+    for (;;) {
+        drawPixelGray(static_cast<int16_t>(x), static_cast<int16_t>(y), gray);
+        if (x == x1 && y == y1) break;
+        int32_t e2 = 2 * err;
+        if (e2 > -dy) {
+            err -= dy;
+            x += sx;
+        }
+        if (e2 < dx) {
+            err += dx;
+            y += sy;
+        }
+    }
+}
+
+template<typename Driver>
+void PicoDisplayGFX<Driver>::drawRadialLineGray(int16_t cx, int16_t cy, int16_t r0, int16_t r1,
+                                                st73xx::Angle angle, uint8_t gray) {
+    // 端点计算与 ST73XX_UI::drawRadialLine 相同
+    int32_t c = st73xx::cosQ15(angle);
+    int32_t s = st73xx::sinQ15(angle);
+    drawLineGray(static_cast<int16_t>(cx + st73xx::mulQ15(r0, c)), static_cast<int16_t>(cy + st73xx::mulQ15(r0, s)),
+                 static_cast<int16_t>(cx + st73xx::mulQ15(r1, c)), static_cast<int16_t>(cy + st73xx::mulQ15(r1, s)),
+                 gray);
+}
+
 } // namespace pico_gfx
 
 #endif // PICO_DISPLAY_GFX_INL 
\ No newline at end of file
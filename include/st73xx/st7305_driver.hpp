@@ -4,6 +4,17 @@
 #include <cstring>
 #include <string_view>
 #include "pico/stdlib.h"
+#include "st73xx_config.hpp"
+#include "st73xx_command_batch.hpp"
+#include "st73xx_init_sequence.hpp"
+#include "st73xx_transport.hpp"
+#include "st73xx_packed_framebuffer.hpp"
+#include "st73xx_spi_transport.hpp"
+
+// 保存热启动标记的看门狗scratch寄存器编号（0~3可供应用使用）
+#ifndef ST7305_WARM_BOOT_SCRATCH
+#define ST7305_WARM_BOOT_SCRATCH 0
+#endif
 
 namespace st7305 {
 
@@ -19,26 +30,55 @@ public:
     static constexpr uint8_t COLOR_WHITE = 0x00;
     static constexpr uint8_t COLOR_BLACK = 0x01;
 
+    // 显存格式：168x384，1bit，4x2像素/字节
+    using Packing = st73xx::ST7305Packing;
+    using Framebuffer = st73xx::PackedFramebuffer<Packing>;
+
     // 显示参数
-    static constexpr uint16_t LCD_WIDTH = 168;
-    static constexpr uint16_t LCD_HEIGHT = 384;
-    static constexpr uint16_t LCD_DATA_WIDTH = 42;  // LCD_WIDTH / 4
-    static constexpr uint16_t LCD_DATA_HEIGHT = 192; // LCD_HEIGHT / 2
-    static constexpr uint32_t DISPLAY_BUFFER_LENGTH = LCD_DATA_WIDTH * LCD_DATA_HEIGHT;
-
-    // 构造函数
-    ST7305Driver(uint dc_pin, uint res_pin, uint cs_pin, uint sclk_pin, uint sdin_pin);
+    static constexpr uint16_t LCD_WIDTH = Packing::WIDTH;
+    static constexpr uint16_t LCD_HEIGHT = Packing::HEIGHT;
+    static constexpr uint16_t LCD_DATA_WIDTH = Packing::STRIDE;  // LCD_WIDTH / 4
+    static constexpr uint16_t LCD_DATA_HEIGHT = Packing::ROWS;   // LCD_HEIGHT / 2
+    static constexpr uint32_t DISPLAY_BUFFER_LENGTH = Packing::BUFFER_LENGTH;
+
+    // 构造函数：使用spi0上的阻塞SPI传输
+    // framebuffer: 调用者提供的 DISPLAY_BUFFER_LENGTH 字节显存（静态数组、指定段等），
+    // 为空时在堆上分配；零堆模式（ST73XX_NO_HEAP）下必须提供
+#if ST73XX_NO_HEAP
+    ST7305Driver(uint dc_pin, uint res_pin, uint cs_pin, uint sclk_pin, uint sdin_pin, uint8_t* framebuffer);
+    // 使用外部传输（spi1、DMA、PIO或主机端记录传输），传输对象的生命周期由调用者管理
+    ST7305Driver(st73xx::Transport& transport, uint8_t* framebuffer);
+#else
+    ST7305Driver(uint dc_pin, uint res_pin, uint cs_pin, uint sclk_pin, uint sdin_pin,
+                 uint8_t* framebuffer = nullptr);
+    // 使用外部传输（spi1、DMA、PIO或主机端记录传输），传输对象的生命周期由调用者管理
+    explicit ST7305Driver(st73xx::Transport& transport, uint8_t* framebuffer = nullptr);
+#endif
     ~ST7305Driver();
 
     // 初始化函数
-    void initialize();
+    // Auto: 面板自上次初始化后未掉电且未休眠时走热启动，跳过复位和Sleep Out等待
+    void initialize(st73xx::InitMode mode = st73xx::InitMode::Auto);
+    bool wasWarmStart() const;  // 最近一次initialize()是否走了热启动路径
     void clear();
     void display();
 
+    // 异步刷新：传输支持时在后台发送显存，返回后可继续非绘图工作
+    // 在 waitForDisplay() 返回或 isDisplayBusy() 为false之前不得修改显存
+    void displayAsync();
+    bool isDisplayBusy() const;
+    void waitForDisplay();
+
+    st73xx::Transport& transport() { return *transport_; }
+
     // 绘图函数
     void drawPixel(uint16_t x, uint16_t y, bool color);
     void fill(uint8_t data);
 
+    // 显存内核（物理坐标）：span/rect/glyph/blit 等批量绘制
+    Framebuffer& framebuffer() { return framebuffer_; }
+    const Framebuffer& framebuffer() const { return framebuffer_; }
+
     // 文本显示函数
     void drawChar(uint16_t x, uint16_t y, char c, bool color);
     void drawString(uint16_t x, uint16_t y, std::string_view str, bool color);
@@ -62,6 +102,8 @@ public:
     void High_Power_Mode();
 
     void plotPixelRaw(uint16_t x, uint16_t y, bool color);
+    // 物理坐标矩形填充（按字节整块写入），超出屏幕部分被裁掉
+    void fillRectRaw(uint16_t x, uint16_t y, uint16_t w, uint16_t h, bool color);
 
     uint8_t getCurrentFontWidth() const;
 
@@ -69,16 +111,15 @@ public:
 
 private:
     void writeCommand(uint8_t cmd);
-    void writeData(uint8_t data);
-    void writeData(const uint8_t* data, size_t len);
-    void writePoint(uint16_t x, uint16_t y, bool enabled);
-
-    const uint dc_pin_;
-    const uint res_pin_;
-    const uint cs_pin_;
-    const uint sclk_pin_;
-    const uint sdin_pin_;
+    void writeBatch(const st73xx::CommandBatch& batch, const uint8_t* payload = nullptr, size_t len = 0);
+
+    // 引脚构造时内部创建的spi0传输，就地构造在驱动对象中，不占用堆
+    alignas(st73xx::SpiTransport) unsigned char pin_transport_storage_[sizeof(st73xx::SpiTransport)];
+    st73xx::SpiTransport* pin_transport_ = nullptr;
+    st73xx::Transport* transport_;
     uint8_t* display_buffer_;
+    bool owns_buffer_ = false;
+    Framebuffer framebuffer_;
 
     bool hpm_mode_ = false;
     bool lpm_mode_ = false;
@@ -87,9 +128,12 @@ private:
 
     FontLayout font_layout_ = FontLayout::Vertical;
 
+    bool warm_started_ = false;
+
     // 私有辅助函数
-    void setAddress();
-    void initST7305();
+    void attachBuffer();
+    void appendFrameHeader(st73xx::CommandBatch& batch);
+    void initST7305(bool warm);
 };
 
 } // namespace st7305 
\ No newline at end of file
@@ -4,6 +4,17 @@
 #include <cstring>
 #include <string_view>
 #include "pico/stdlib.h"
+#include "st73xx_config.hpp"
+#include "st73xx_command_batch.hpp"
+#include "st73xx_init_sequence.hpp"
+#include "st73xx_transport.hpp"
+#include "st73xx_packed_framebuffer.hpp"
+#include "st73xx_spi_transport.hpp"
+
+// 保存热启动标记的看门狗scratch寄存器编号（0~3可供应用使用）
+#ifndef ST7306_WARM_BOOT_SCRATCH
+#define ST7306_WARM_BOOT_SCRATCH 1
+#endif
 
 namespace st7306 {
 
@@ -19,6 +30,20 @@ enum class DisplayMode {
     Night    // 黑底白字
 };
 
+// 显存格式
+enum class BufferFormat {
+    Gray2,   // 2bit灰度，30000字节，与面板显存格式相同
+    Mono     // 1bit黑白，15000字节，刷新时逐行展开为2bit发送
+};
+
+// HPM/LPM 自动切换（功耗调节器）配置
+struct PowerGovernorConfig {
+    uint32_t idle_timeout_ms = 5000;   // 最后一次刷新后空闲多久切换到LPM(1Hz)
+    uint32_t burst_interval_ms = 1000; // LPM下两次刷新间隔小于该值视为进入活动期
+    uint8_t burst_flushes = 2;         // 连续多少次短间隔刷新后切回HPM(32Hz)
+    uint32_t transition_ms = 300;      // HPM/LPM切换后的稳定时间
+};
+
 class ST7306Driver {
 public:
     // 颜色定义
@@ -27,27 +52,73 @@ public:
     static constexpr uint8_t COLOR_GRAY1 = 0x01;
     static constexpr uint8_t COLOR_GRAY2 = 0x02;
 
+    // 显存格式：300x400，2bit灰度，2x2像素/字节
+    using Packing = st73xx::ST7306Packing;
+    using Framebuffer = st73xx::PackedFramebuffer<Packing>;
+
     // 显示参数
-    static constexpr uint16_t LCD_WIDTH = 300;
-    static constexpr uint16_t LCD_HEIGHT = 400;
-    static constexpr uint16_t LCD_DATA_WIDTH = 150;  // LCD_WIDTH / 2
-    static constexpr uint16_t LCD_DATA_HEIGHT = 200; // LCD_HEIGHT / 2
-    static constexpr uint32_t DISPLAY_BUFFER_LENGTH = LCD_DATA_WIDTH * LCD_DATA_HEIGHT;
-
-    // 构造函数
-    ST7306Driver(uint dc_pin, uint res_pin, uint cs_pin, uint sclk_pin, uint sdin_pin);
+    static constexpr uint16_t LCD_WIDTH = Packing::WIDTH;
+    static constexpr uint16_t LCD_HEIGHT = Packing::HEIGHT;
+    static constexpr uint16_t LCD_DATA_WIDTH = Packing::STRIDE;  // LCD_WIDTH / 2
+    static constexpr uint16_t LCD_DATA_HEIGHT = Packing::ROWS;   // LCD_HEIGHT / 2
+    static constexpr uint32_t DISPLAY_BUFFER_LENGTH = Packing::BUFFER_LENGTH;
+
+    // 单色工作缓冲：1bit，4x2像素/字节
+    using MonoPacking = st73xx::ST7306MonoPacking;
+    using MonoFramebuffer = st73xx::PackedFramebuffer<MonoPacking>;
+    static constexpr uint32_t MONO_BUFFER_LENGTH = MonoPacking::BUFFER_LENGTH;
+
+    // 构造函数：使用spi0上的阻塞SPI传输
+    // framebuffer: 调用者提供的 DISPLAY_BUFFER_LENGTH 字节显存（静态数组、指定段等），
+    // 为空时在堆上分配；零堆模式（ST73XX_NO_HEAP）下必须提供
+    // format: Mono 时显存只需 MONO_BUFFER_LENGTH 字节，灰度绘制按阈值（>=GRAY2 为黑）落到1bit
+#if ST73XX_NO_HEAP
+    ST7306Driver(uint dc_pin, uint res_pin, uint cs_pin, uint sclk_pin, uint sdin_pin, uint8_t* framebuffer,
+                 BufferFormat format = BufferFormat::Gray2);
+    // 使用外部传输（spi1、DMA、PIO或主机端记录传输），传输对象的生命周期由调用者管理
+    ST7306Driver(st73xx::Transport& transport, uint8_t* framebuffer, BufferFormat format = BufferFormat::Gray2);
+#else
+    ST7306Driver(uint dc_pin, uint res_pin, uint cs_pin, uint sclk_pin, uint sdin_pin,
+                 uint8_t* framebuffer = nullptr, BufferFormat format = BufferFormat::Gray2);
+    // 使用外部传输（spi1、DMA、PIO或主机端记录传输），传输对象的生命周期由调用者管理
+    explicit ST7306Driver(st73xx::Transport& transport, uint8_t* framebuffer = nullptr,
+                          BufferFormat format = BufferFormat::Gray2);
+#endif
     ~ST7306Driver();
 
     // 初始化函数
-    void initialize();
+    // Auto: 面板自上次初始化后未掉电且未休眠时走热启动，跳过复位和清RAM等待
+    void initialize(st73xx::InitMode mode = st73xx::InitMode::Auto);
     void clear();
     void display();
 
+    // 异步刷新：传输支持时在后台发送显存，返回后可继续非绘图工作
+    // 在 waitForDisplay() 返回或 isDisplayBusy() 为false之前不得修改显存
+    // 单色模式下需要CPU逐行展开，退化为 display()（展开与DMA发送仍然重叠）
+    void displayAsync();
+    bool isDisplayBusy() const;
+    void waitForDisplay();
+
+    // 局部刷新：只发送字节行 [first_row, first_row + row_count)（每个字节行对应两条像素行），
+    // 行地址窗口随之收窄；列方向仍为整行。同步发送，适合只改动少数行的更新
+    void displayRows(uint16_t first_row, uint16_t row_count);
+
+    st73xx::Transport& transport() { return *transport_; }
+
     // 绘图函数
     void drawPixel(uint16_t x, uint16_t y, bool color);
     void drawPixelGray(uint16_t x, uint16_t y, uint8_t gray_level);
     void fill(uint8_t data);
 
+    // 显存内核（物理坐标）：span/rect/glyph/blit 等批量绘制
+    // 灰度模式使用 framebuffer()，单色模式使用 monoFramebuffer()；另一个视图未挂接显存
+    Framebuffer& framebuffer() { return framebuffer_; }
+    const Framebuffer& framebuffer() const { return framebuffer_; }
+    MonoFramebuffer& monoFramebuffer() { return mono_framebuffer_; }
+    const MonoFramebuffer& monoFramebuffer() const { return mono_framebuffer_; }
+    BufferFormat bufferFormat() const { return format_; }
+    bool isMonoMode() const { return format_ == BufferFormat::Mono; }
+
     // 文本显示函数
     void drawChar(uint16_t x, uint16_t y, char c, bool color);
     void drawString(uint16_t x, uint16_t y, std::string_view str, bool color);
@@ -61,6 +132,13 @@ public:
     void lowPowerMode();
     void highPowerMode();
 
+    // 功耗调节器：根据刷新频率自动在HPM/LPM之间切换
+    // 空闲超时由定时器告警触发，应用无需再手动管理功耗模式
+    void enablePowerGovernor(const PowerGovernorConfig& config = PowerGovernorConfig());
+    void disablePowerGovernor();
+    bool isPowerGovernorEnabled() const;
+    bool isLowPowerMode() const;
+
     // 新增接口
     void clearDisplay();
     void setRotation(int r);
@@ -73,6 +151,8 @@ public:
 
     void plotPixelRaw(uint16_t x, uint16_t y, bool color);
     void plotPixelGrayRaw(uint16_t x, uint16_t y, uint8_t gray_level);
+    // 物理坐标矩形填充（按字节整块写入），超出屏幕部分被裁掉
+    void fillRectRaw(uint16_t x, uint16_t y, uint16_t w, uint16_t h, bool color);
 
     uint8_t getCurrentFontWidth() const;
 
@@ -84,23 +164,31 @@ public:
     
     // 初始化状态检查
     bool is_initialized() const;
+    bool wasWarmStart() const;  // 最近一次initialize()是否走了热启动路径
 
 private:
     void writeCommand(uint8_t cmd);
-    void writeData(uint8_t data);
-    void writeData(const uint8_t* data, size_t len);
+    void writeBatch(const st73xx::CommandBatch& batch, const uint8_t* payload = nullptr, size_t len = 0);
     void writePoint(uint16_t x, uint16_t y, bool enabled);
     void writePointGray(uint16_t x, uint16_t y, uint8_t color);
 
-    const uint dc_pin_;
-    const uint res_pin_;
-    const uint cs_pin_;
-    const uint sclk_pin_;
-    const uint sdin_pin_;
+    // 引脚构造时内部创建的spi0传输，就地构造在驱动对象中，不占用堆
+    alignas(st73xx::SpiTransport) unsigned char pin_transport_storage_[sizeof(st73xx::SpiTransport)];
+    st73xx::SpiTransport* pin_transport_ = nullptr;
+    st73xx::Transport* transport_;
     uint8_t* display_buffer_;
+    bool owns_buffer_ = false;
+    BufferFormat format_;
+    Framebuffer framebuffer_;
+    MonoFramebuffer mono_framebuffer_;
+
+    // 单色刷新的乒乓缓冲：一块字节行展开后交给传输发送，同时展开下一块
+    static constexpr uint16_t MONO_LINES_PER_CHUNK = 4;
+    uint8_t line_buffers_[2][MONO_LINES_PER_CHUNK * Packing::STRIDE];
 
-    bool hpm_mode_ = false;
-    bool lpm_mode_ = false;
+    // 模式标志会被功耗调节器的告警回调（中断上下文）改写
+    volatile bool hpm_mode_ = false;
+    volatile bool lpm_mode_ = false;
 
     int rotation_ = 0; // 0:默认，1:90度，2:180度，3:270度
 
@@ -109,11 +197,41 @@ private:
     DisplayMode display_mode_ = DisplayMode::Day;
     
     bool initialized_ = false;  // 初始化状态标志
+    bool warm_started_ = false;
+
+    // 功耗调节器状态（与告警回调共享的字段均为volatile）
+    PowerGovernorConfig governor_config_;
+    volatile bool governor_enabled_ = false;
+    volatile uint8_t bus_busy_ = 0;        // 命令序列传输中（可嵌套），告警回调不得插入命令
+    bool sleeping_ = false;
+    volatile bool governor_alarm_pending_ = false;
+    alarm_id_t governor_alarm_ = 0;
+    uint32_t last_flush_ms_ = 0;
+    volatile uint32_t mode_switch_ms_ = 0; // 最近一次HPM/LPM切换时间
+    volatile uint8_t burst_count_ = 0;
+
+    // 在一个完整命令序列期间标记总线占用
+    class BusGuard {
+    public:
+        explicit BusGuard(ST7306Driver& driver) : driver_(driver) { driver_.bus_busy_ = driver_.bus_busy_ + 1; }
+        ~BusGuard() { driver_.bus_busy_ = driver_.bus_busy_ - 1; }
+    private:
+        ST7306Driver& driver_;
+    };
 
     // 私有辅助函数
-    void setAddress();
-    void initST7306();
+    void attachBuffer();
+    void appendAddressWindow(st73xx::CommandBatch& batch, uint16_t first_row = 0,
+                             uint16_t last_row = Packing::ROWS - 1);
+    void displayMono(uint16_t first_row = 0, uint16_t row_count = Packing::ROWS);
+    void displayMonoBlocking(uint16_t first_row, uint16_t row_count);
+    void initST7306(bool warm);
     void updateDisplayMode();
+    void setPowerMode(bool low_power);
+    void waitForModeTransition();
+    void governorOnFlush();
+    void armGovernorAlarm();
+    static int64_t governorAlarmCallback(alarm_id_t id, void* user_data);
 };
 
 } // namespace st7306 
\ No newline at end of file
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+
+namespace st73xx {
+
+// 命令批处理
+// 把一条或多条命令及其参数收集起来，由驱动在一次CS拉低期间发送。
+// 相同DC电平的连续字节合并为一个"段"(Run)，DC只在命令/数据切换处翻转一次。
+class CommandBatch {
+public:
+    static constexpr size_t MAX_BYTES = 128;
+    static constexpr size_t MAX_RUNS = 48;
+
+    struct Run {
+        uint8_t offset;  // 在 bytes() 中的起始位置
+        uint8_t length;  // 字节数
+        bool is_data;    // true: DC=1 数据, false: DC=0 命令
+    };
+
+    CommandBatch() = default;
+
+    CommandBatch& command(uint8_t cmd) {
+        append(cmd, false);
+        return *this;
+    }
+
+    CommandBatch& command(uint8_t cmd, std::initializer_list<uint8_t> params) {
+        append(cmd, false);
+        for (uint8_t p : params) {
+            append(p, true);
+        }
+        return *this;
+    }
+
+    CommandBatch& command(uint8_t cmd, const uint8_t* params, size_t count) {
+        append(cmd, false);
+        for (size_t i = 0; i < count; i++) {
+            append(params[i], true);
+        }
+        return *this;
+    }
+
+    CommandBatch& data(uint8_t value) {
+        append(value, true);
+        return *this;
+    }
+
+    void clear() {
+        size_ = 0;
+        run_count_ = 0;
+        overflow_ = false;
+    }
+
+    bool empty() const { return size_ == 0; }
+    size_t size() const { return size_; }
+    size_t runCount() const { return run_count_; }
+    const Run& run(size_t index) const { return runs_[index]; }
+    const uint8_t* bytes() const { return bytes_; }
+    size_t bytesLeft() const { return MAX_BYTES - size_; }
+    size_t runsLeft() const { return MAX_RUNS - run_count_; }
+
+    // 超出容量的字节会被丢弃，调用者可据此检查批次是否完整
+    bool overflowed() const { return overflow_; }
+
+private:
+    void append(uint8_t value, bool is_data) {
+        if (size_ >= MAX_BYTES) {
+            overflow_ = true;
+            return;
+        }
+        if (run_count_ > 0 && runs_[run_count_ - 1].is_data == is_data) {
+            runs_[run_count_ - 1].length++;
+        } else {
+            if (run_count_ >= MAX_RUNS) {
+                overflow_ = true;
+                return;
+            }
+            runs_[run_count_++] = Run{static_cast<uint8_t>(size_), 1, is_data};
+        }
+        bytes_[size_++] = value;
+    }
+
+    uint8_t bytes_[MAX_BYTES];
+    Run runs_[MAX_RUNS];
+    uint8_t size_ = 0;
+    uint8_t run_count_ = 0;
+    bool overflow_ = false;
+};
+
+} // namespace st73xx
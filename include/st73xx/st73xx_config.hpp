@@ -0,0 +1,51 @@
+#pragma once
+
+// === ST73xx 显示栈编译期配置 ===
+
+// 零堆模式：驱动不再调用 new/delete
+//   - 显存必须由调用者提供（构造函数的显存参数变为必填，遗漏时编译失败）
+//   - 引脚构造函数创建的spi0传输放在驱动对象内部
+// ST73XX_UI 本身从不分配堆内存：多边形填充使用静态边表（ST73XX_UI_MAX_POLYGON_EDGES），
+// 与本开关无关。开关只约束显示栈，摇杆等其他组件不在此列。
+// 可在CMake中用 -DST73XX_NO_HEAP=ON 打开
+#ifndef ST73XX_NO_HEAP
+#define ST73XX_NO_HEAP 0
+#endif
+
+// 每帧性能计数（st73xx_metrics.hpp）：写入像素、填充区块、字形、总线字节、绘制与刷新耗时
+// 关闭时计数宏展开为空，不产生任何代码。可在CMake中用 -DST73XX_METRICS=ON 打开
+#ifndef ST73XX_METRICS
+#define ST73XX_METRICS 0
+#endif
+
+// 二进制事件追踪（st73xx_trace.hpp）：每核一个环形缓冲，记录绘制、刷新、DMA、输入采样与网络轮询
+// 关闭时追踪宏展开为空。可在CMake中用 -DST73XX_TRACE=ON 打开
+#ifndef ST73XX_TRACE
+#define ST73XX_TRACE 0
+#endif
+
+// 每个核的追踪记录条数（2的幂，每条8字节）
+#ifndef ST73XX_TRACE_CAPACITY
+#define ST73XX_TRACE_CAPACITY 512
+#endif
+
+// 静态显存的放置属性
+// 默认放在普通 .bss（RP2040 默认链接脚本下为SRAM0~3条带化区域）。
+// 若使用自定义链接脚本把某个SRAM bank单独划出来（与WiFi/lwIP的DMA缓冲区分开，减少总线争用），
+// 可定义为对应的段，例如：
+//   #define ST73XX_FRAMEBUFFER_SECTION __attribute__((section(".framebuffer_bank")))
+// 显存在initialize()/clear()中会被重写，也可以使用 __attribute__((section(".uninitialized_data")))
+// 省去启动时的清零。
+#ifndef ST73XX_FRAMEBUFFER_SECTION
+#define ST73XX_FRAMEBUFFER_SECTION
+#endif
+
+// 声明一块驱动所需大小的显存（文件作用域使用），例如：
+//   ST73XX_DEFINE_FRAMEBUFFER(g_lcd_buffer, st7306::ST7306Driver);
+//   st7306::ST7306Driver lcd(PIN_DC, PIN_RST, PIN_CS, PIN_SCLK, PIN_SDIN, g_lcd_buffer);
+#define ST73XX_DEFINE_FRAMEBUFFER(name, Driver) \
+    alignas(4) uint8_t name[Driver::DISPLAY_BUFFER_LENGTH] ST73XX_FRAMEBUFFER_SECTION
+
+// 单色模式（st7306::BufferFormat::Mono）的显存，大小为 MONO_BUFFER_LENGTH
+#define ST73XX_DEFINE_MONO_FRAMEBUFFER(name, Driver) \
+    alignas(4) uint8_t name[Driver::MONO_BUFFER_LENGTH] ST73XX_FRAMEBUFFER_SECTION
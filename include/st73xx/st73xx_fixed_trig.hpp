@@ -0,0 +1,201 @@
+#pragma once
+
+#include <cstdint>
+
+namespace st73xx {
+
+// 定点三角函数与旋转
+// RP2040 (Cortex-M0+) 没有FPU，sin/cos/atan2 走软浮点，每个顶点数百个周期。
+// 这里的函数只用整数运算，查找表在编译期生成：
+//   - 角度使用二进制角度单位：一圈 = 65536，uint16_t 自然回绕；
+//     0 指向 +x，正方向从 +x 转向 +y（屏幕坐标 y 向下，即顺时针）
+//   - 正弦/余弦返回 Q15（1.0 = 32768）
+using Angle = uint16_t;
+
+constexpr uint32_t ANGLE_TURN = 65536;
+constexpr Angle ANGLE_QUARTER = 0x4000;  // 90度
+constexpr Angle ANGLE_HALF = 0x8000;     // 180度
+constexpr int32_t Q15_ONE = 32768;
+
+// 角度换算（编译期可用）
+constexpr Angle angleFromDegrees(int32_t degrees) {
+    return static_cast<Angle>((static_cast<int64_t>(degrees) * 65536 / 360) & 0xFFFF);
+}
+
+// num/den 圈，例如第 m 分钟：angleFromTurns(m, 60)
+constexpr Angle angleFromTurns(int32_t num, int32_t den) {
+    return static_cast<Angle>((static_cast<int64_t>(num) * 65536 / den) & 0xFFFF);
+}
+
+namespace trig_detail {
+
+constexpr double PI = 3.14159265358979323846;
+
+// 以下仅在编译期生成查找表时使用
+constexpr double sinSeries(double x) {
+    double term = x;
+    double sum = x;
+    for (int n = 1; n < 12; n++) {
+        term = -term * x * x / ((2 * n) * (2 * n + 1));
+        sum += term;
+    }
+    return sum;
+}
+
+constexpr double sqrtNewton(double v) {
+    if (v <= 0) return 0;
+    double x = v > 1 ? v : 1;
+    for (int i = 0; i < 40; i++) {
+        x = 0.5 * (x + v / x);
+    }
+    return x;
+}
+
+// t ∈ [0,1]：两次半角化简后级数快速收敛
+constexpr double atanSeries(double t) {
+    double u = t / (1 + sqrtNewton(1 + t * t));
+    u = u / (1 + sqrtNewton(1 + u * u));
+    double term = u;
+    double sum = u;
+    for (int n = 1; n < 16; n++) {
+        term = -term * u * u;
+        sum += term / (2 * n + 1);
+    }
+    return 4 * sum;
+}
+
+constexpr int SINE_SEGMENTS = 256;  // 1/4周期的分段数
+constexpr int ATAN_SEGMENTS = 64;   // tan ∈ [0,1] 的分段数
+
+struct SineTable {
+    uint16_t v[SINE_SEGMENTS + 1];  // Q15，最后一项为 sin(90°) = 32768
+};
+
+struct AtanTable {
+    uint16_t v[ATAN_SEGMENTS + 1];  // 角度单位，最后一项为 45° = 8192
+};
+
+constexpr SineTable makeSineTable() {
+    SineTable t{};
+    for (int i = 0; i <= SINE_SEGMENTS; i++) {
+        double s = sinSeries(PI / 2 * i / SINE_SEGMENTS);
+        t.v[i] = static_cast<uint16_t>(s * 32768 + 0.5);
+    }
+    return t;
+}
+
+constexpr AtanTable makeAtanTable() {
+    AtanTable t{};
+    for (int i = 0; i <= ATAN_SEGMENTS; i++) {
+        double a = atanSeries(static_cast<double>(i) / ATAN_SEGMENTS);
+        t.v[i] = static_cast<uint16_t>(a / (2 * PI) * 65536 + 0.5);
+    }
+    return t;
+}
+
+constexpr SineTable SINE = makeSineTable();
+constexpr AtanTable ATAN = makeAtanTable();
+
+} // namespace trig_detail
+
+// sin(angle)，Q15，线性插值后误差小于 2/32768
+constexpr int32_t sinQ15(Angle angle) {
+    uint8_t quadrant = static_cast<uint8_t>(angle >> 14);
+    uint32_t idx = angle & 0x3FFF;
+    if (quadrant & 1) idx = 0x4000 - idx;  // 第二、四象限镜像
+
+    uint32_t seg = idx >> 6;
+    uint32_t frac = idx & 0x3F;
+    int32_t v = trig_detail::SINE.v[seg];
+    if (frac) {
+        v += ((static_cast<int32_t>(trig_detail::SINE.v[seg + 1]) - v) * static_cast<int32_t>(frac) + 32) >> 6;
+    }
+    return (quadrant & 2) ? -v : v;
+}
+
+constexpr int32_t cosQ15(Angle angle) {
+    return sinQ15(static_cast<Angle>(angle + ANGLE_QUARTER));
+}
+
+// atan2(y, x) -> 角度，误差不超过 ±3 单位（0.02°）；(0,0) 返回 0
+// 每次调用一次整数除法，其余为查表与插值
+inline Angle atan2Angle(int32_t y, int32_t x) {
+    if (x == 0 && y == 0) return 0;
+    uint32_t ax = static_cast<uint32_t>(x < 0 ? -static_cast<int64_t>(x) : x);
+    uint32_t ay = static_cast<uint32_t>(y < 0 ? -static_cast<int64_t>(y) : y);
+
+    // 第一象限内按 min/max 查表，再按 45° 对称展开
+    bool swap = ay > ax;
+    uint32_t num = swap ? ax : ay;
+    uint32_t den = swap ? ay : ax;
+    // 比值 Q12；den 超过 2^19 时先缩小，避免左移溢出
+    while (den >= (1u << 19)) {
+        num >>= 1;
+        den >>= 1;
+    }
+    uint32_t ratio = (num << 12) / den;  // 0..4096
+
+    uint32_t seg = ratio >> 6;
+    uint32_t frac = ratio & 0x3F;
+    int32_t a = trig_detail::ATAN.v[seg];
+    if (frac) {
+        a += ((static_cast<int32_t>(trig_detail::ATAN.v[seg + 1]) - a) * static_cast<int32_t>(frac) + 32) >> 6;
+    }
+
+    if (swap) a = ANGLE_QUARTER - a;
+    if (x < 0) a = ANGLE_HALF - a;
+    if (y < 0) a = -a;
+    return static_cast<Angle>(a);
+}
+
+// v * q / 32768，四舍五入；|v| <= 65535 时不会溢出
+constexpr int32_t mulQ15(int32_t v, int32_t q) {
+    return (v * q + 0x4000) >> 15;
+}
+
+// 绕原点旋转：预先取出 cos/sin，同一角度的多个顶点共用
+struct Rotation {
+    int32_t cos_q15;
+    int32_t sin_q15;
+
+    constexpr explicit Rotation(Angle angle) : cos_q15(cosQ15(angle)), sin_q15(sinQ15(angle)) {}
+
+    constexpr void apply(int32_t x, int32_t y, int32_t& rx, int32_t& ry) const {
+        rx = mulQ15(x, cos_q15) - mulQ15(y, sin_q15);
+        ry = mulQ15(x, sin_q15) + mulQ15(y, cos_q15);
+    }
+};
+
+// 旋转后平移，用于把以原点为中心定义的指针、叶片等形状放到屏幕上
+struct Transform2D {
+    Rotation rotation;
+    int32_t tx;
+    int32_t ty;
+
+    constexpr Transform2D(Angle angle, int32_t origin_x, int32_t origin_y) :
+        rotation(angle), tx(origin_x), ty(origin_y) {}
+
+    constexpr void apply(int32_t x, int32_t y, int32_t& ox, int32_t& oy) const {
+        rotation.apply(x, y, ox, oy);
+        ox += tx;
+        oy += ty;
+    }
+
+    // 批量变换顶点，输出可直接交给 drawPolygon/drawFilledPolygon
+    void apply(const int16_t* x, const int16_t* y, int16_t* ox, int16_t* oy, uint8_t count) const {
+        for (uint8_t i = 0; i < count; i++) {
+            int32_t rx, ry;
+            apply(x[i], y[i], rx, ry);
+            ox[i] = static_cast<int16_t>(rx);
+            oy[i] = static_cast<int16_t>(ry);
+        }
+    }
+};
+
+// 极坐标 -> 直角坐标：(cx,cy) 为圆心，radius 与结果同单位（可传入放大后的亚像素半径）
+constexpr void polarToCartesian(int32_t cx, int32_t cy, int32_t radius, Angle angle, int32_t& x, int32_t& y) {
+    x = cx + mulQ15(radius, cosQ15(angle));
+    y = cy + mulQ15(radius, sinQ15(angle));
+}
+
+} // namespace st73xx
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include "st73xx_command_batch.hpp"
+
+namespace st73xx {
+
+// 初始化方式
+// 热启动依赖两点：看门狗scratch中的标记（上电复位清零）和复位脚在MCU复位期间保持高电平。
+// RP2040复位后GPIO默认带内部下拉，复位脚必须外接上拉（如10k到3V3），否则面板在MCU
+// 复位时已被复位。传输在接管复位脚前读取其电平（Transport::resetPinWasHigh()），
+// 读到低电平时 Auto 与 Warm 都退回冷启动。面板与MCU分开供电时标记无法反映面板是否掉过电，
+// 这种接法应显式使用 Cold。
+enum class InitMode {
+    Auto,  // 根据热启动标记自动选择
+    Cold,  // 硬件复位 + 完整初始化（含所有延时与清RAM）
+    Warm   // 面板仍处于已配置状态：跳过复位、Sleep Out等待与清RAM
+};
+
+// 初始化表格式（每项）：
+//   cmd, ctrl, params[ctrl & INIT_LEN_MASK], [delay_ms 若 ctrl & INIT_DELAY]
+// 表以 ctrl == INIT_END 的项结束
+constexpr uint8_t INIT_LEN_MASK  = 0x3F; // 参数个数（最多62个）
+constexpr uint8_t INIT_COLD_ONLY = 0x40; // 仅冷启动执行（热启动整项跳过）
+constexpr uint8_t INIT_DELAY     = 0x80; // 参数后跟一个延时字节（毫秒）
+constexpr uint8_t INIT_END       = 0xFF;
+
+// 执行初始化表
+// 相邻命令合并进同一批次，遇到延时项或批次将满时才发送，
+// 因此整个序列只需要寥寥几次CS拉低。
+// write_batch(const CommandBatch&) 负责发送，delay_ms(uint32_t) 负责等待。
+template <typename WriteBatch, typename DelayMs>
+void runInitSequence(const uint8_t* seq, bool warm, WriteBatch&& write_batch, DelayMs&& delay_ms) {
+    CommandBatch batch;
+    for (;;) {
+        uint8_t cmd = *seq++;
+        uint8_t ctrl = *seq++;
+        if (ctrl == INIT_END) break;
+
+        uint8_t len = ctrl & INIT_LEN_MASK;
+        const uint8_t* params = seq;
+        seq += len;
+        uint8_t delay = (ctrl & INIT_DELAY) ? *seq++ : 0;
+
+        if (warm && (ctrl & INIT_COLD_ONLY)) continue;
+
+        if (batch.bytesLeft() < static_cast<size_t>(len) + 1 || batch.runsLeft() < 2) {
+            write_batch(batch);
+            batch.clear();
+        }
+        batch.command(cmd, params, len);
+
+        if (delay) {
+            write_batch(batch);
+            batch.clear();
+            delay_ms(delay);
+        }
+    }
+    if (!batch.empty()) {
+        write_batch(batch);
+    }
+}
+
+} // namespace st73xx
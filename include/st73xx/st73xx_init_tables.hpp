@@ -0,0 +1,98 @@
+#pragma once
+
+#include <cstdint>
+#include "st73xx_init_sequence.hpp"
+
+// ST7305/ST7306 的初始化表
+// 不依赖Pico SDK：驱动与主机端工具（tools/tagged_stream_sim.cpp）共用同一份表，
+// 主机端校验的就是实际发送给面板的序列。
+
+namespace st7305 {
+
+using st73xx::INIT_COLD_ONLY;
+using st73xx::INIT_DELAY;
+using st73xx::INIT_END;
+
+// 初始化表，格式见 st73xx_init_sequence.hpp
+inline constexpr uint8_t INIT_SEQUENCE[] = {
+    0xD6, 2, 0x13, 0x02,                                      // NVM Load Control
+    0xD1, 1, 0x01,                                            // Booster Enable
+    0xC0, 2, 0x12, 0x0A,                                      // Gate Voltage Setting: VGH 17V, VGL -10V
+    0xC1, 4, 115, 0x3E, 0x3C, 0x3C,                           // VSHP Setting (厂商值)
+    0xC2, 4, 0, 0x21, 0x23, 0x23,                             // VSLP Setting (厂商值)
+    0xC4, 4, 50, 0x5C, 0x5A, 0x5A,                            // VSHN Setting (厂商值)
+    0xC5, 4, 50, 0x35, 0x37, 0x37,                            // VSLN Setting (厂商值)
+    0xD8, 2, 0x80, 0xE9,                                      // OSC Setting: Enable OSC, HPM Frame Rate Max = 51hZ
+    0xB2, 1, 0x12,                                            // Frame Rate Control: HPM=51hz ; LPM=1hz
+    0xB3, 10, 0xE5, 0xF6, 0x17, 0x77, 0x77,
+              0x77, 0x77, 0x77, 0x77, 0x71,                   // Update Period Gate EQ Control in HPM
+    0xB4, 8, 0x05, 0x46, 0x77, 0x77, 0x77, 0x77, 0x76, 0x45,  // Update Period Gate EQ Control in LPM
+    0x62, 3, 0x32, 0x03, 0x1F,                                // Gate Timing Control
+    0xB7, 1, 0x13,                                            // Source EQ Enable
+    0xB0, 1, 0x60,                                            // Gate Line Setting: 384 line = 96 * 4
+    0x11, 0 | INIT_COLD_ONLY | INIT_DELAY, 120,               // Sleep out，重要：需要120ms延时
+    0xC9, 1, 0x00,                                            // Source Voltage Select: VSHP1; VSLP1 ; VSHN1 ; VSLN1
+    0x36, 1, 0x48,                                            // Memory Data Access Control: MX=1 ; DO=1
+    0x3A, 1, 0x11,                                            // Data Format Select: 10:4write for 24bit ; 11: 3write for 24bit
+    0xB9, 1, 0x20,                                            // Gamma Mode Setting: 20: Mono 00:4GS
+    0xB8, 1, 0x29,                                            // Panel Setting: 1-Dot inversion, Frame inversion, One Line Interlace
+    // 设置显示区域（全屏，严格对应168x384像素）
+    0x2A, 4, 0x17, 0x24, 0x00, 0x00,                          // Column Address Setting (0x24-0x17=14, 14*12=168)
+    0x2B, 4, 0x00, 0xBF, 0x00, 0x00,                          // Row Address Setting (192*2=384)
+    0x35, 1, 0x00,                                            // TE off
+    0xD0, 1, 0xFF,                                            // Auto power down ON
+    0x38, 0,                                                  // HPM:high Power Mode ON
+    0x29, 0,                                                  // Display ON
+    0x20, 0,                                                  // Display Inversion Off
+    0xBB, 1 | INIT_COLD_ONLY, 0x4F,                           // Enable Clear RAM: CLR=0 ; clear RAM to 0
+    0x00, INIT_END
+};
+
+} // namespace st7305
+
+namespace st7306 {
+
+using st73xx::INIT_COLD_ONLY;
+using st73xx::INIT_DELAY;
+using st73xx::INIT_END;
+
+// 初始化表，格式见 st73xx_init_sequence.hpp
+// 完全匹配原厂代码ST7306_4p2_BW_DisplayDriver.cpp中的Initial_ST7305函数
+inline constexpr uint8_t INIT_SEQUENCE[] = {
+    0xD6, 2, 0x17, 0x02,                                      // NVM Load Control
+    0xD1, 1, 0x01,                                            // Booster Enable
+    0xC0, 2, 0x12, 0x0A,                                      // Gate Voltage Setting: VGH 17V, VGL -10V
+    // VLC=3.6V (12/-5)(delta Vp=0.6V)
+    0xC1, 4, 115, 0x3E, 0x3C, 0x3C,                           // VSHP Setting (4.8V)
+    0xC2, 4, 0, 0x21, 0x23, 0x23,                             // VSLP Setting (0.98V)
+    0xC4, 4, 50, 0x5C, 0x5A, 0x5A,                            // VSHN Setting (-3.6V)
+    0xC5, 4, 50, 0x35, 0x37, 0x37,                            // VSLN Setting (0.22V)
+    0xD8, 2, 0xA6, 0xE9,                                      // OSC Setting
+    0xB2, 1, 0x12,                                            // Frame Rate Control: HPM=32hz ; LPM=1hz
+    0xB3, 10, 0xE5, 0xF6, 0x17, 0x77, 0x77,
+              0x77, 0x77, 0x77, 0x77, 0x71,                   // Update Period Gate EQ Control in HPM
+    0xB4, 8, 0x05, 0x46, 0x77, 0x77, 0x77, 0x77, 0x76, 0x45,  // Update Period Gate EQ Control in LPM
+    0x62, 3, 0x32, 0x03, 0x1F,                                // Gate Timing Control
+    0xB7, 1, 0x13,                                            // Source EQ Enable
+    0xB0, 1, 0x64,                                            // Gate Line Setting: 400行 = 100*4
+    0x11, 0 | INIT_COLD_ONLY | INIT_DELAY, 120,               // Sleep out
+    0xC9, 1, 0x00,                                            // Source Voltage Select: VSHP1; VSLP1 ; VSHN1 ; VSLN1
+    0x36, 1, 0x48,                                            // Memory Data Access Control: MX=1 ; DO=1
+    0x3A, 1, 0x11,                                            // Data Format Select: 11: 3write for 24bit
+    0xB9, 1, 0x20,                                            // Gamma Mode Setting: 20: Mono
+    0xB8, 1, 0x29,                                            // Panel Setting: 1-Dot inversion, Frame inversion, One Line Interlace
+    0x2A, 2, 0x05, 0x36,                                      // Column Address Setting
+    0x2B, 2, 0x00, 0xC7,                                      // Row Address Setting: 0xC7 = 199 (LCD_DATA_HEIGHT-1)
+    0x35, 1, 0x00,                                            // TE
+    0xD0, 1, 0xFF,                                            // Auto power down ON
+    0x38, 0,                                                  // HPM:high Power Mode ON
+    0x29, 0,                                                  // Display ON
+    0x20, 0,                                                  // Display Inversion Off
+    0xBB, 1 | INIT_COLD_ONLY | INIT_DELAY, 0x4F, 10,          // Enable Clear RAM: CLR=0 ; 等待清除完成
+    // 重新设置地址窗口，确保显示正常
+    0x2A, 2, 0x05, 0x36,                                      // Column Address Setting
+    0x2B, 2, 0x00, 0xC7,                                      // Row Address Setting
+    0x00, INIT_END
+};
+
+} // namespace st7306
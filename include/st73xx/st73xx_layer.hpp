@@ -0,0 +1,288 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include "st73xx_packed_framebuffer.hpp"
+
+namespace st73xx {
+
+// 脏矩形：[x0,x1) x [y0,y1)，物理坐标；空矩形 x0 >= x1
+struct DirtyRect {
+    int16_t x0 = 0;
+    int16_t y0 = 0;
+    int16_t x1 = 0;
+    int16_t y1 = 0;
+
+    bool empty() const { return x0 >= x1 || y0 >= y1; }
+    void clear() { x0 = y0 = x1 = y1 = 0; }
+
+    // 并入一个矩形（w/h <= 0 时忽略）
+    void add(int x, int y, int w, int h) {
+        if (w <= 0 || h <= 0) return;
+        if (empty()) {
+            x0 = static_cast<int16_t>(x);
+            y0 = static_cast<int16_t>(y);
+            x1 = static_cast<int16_t>(x + w);
+            y1 = static_cast<int16_t>(y + h);
+            return;
+        }
+        if (x < x0) x0 = static_cast<int16_t>(x);
+        if (y < y0) y0 = static_cast<int16_t>(y);
+        if (x + w > x1) x1 = static_cast<int16_t>(x + w);
+        if (y + h > y1) y1 = static_cast<int16_t>(y + h);
+    }
+
+    void add(const DirtyRect& r) {
+        if (!r.empty()) add(r.x0, r.y0, r.x1 - r.x0, r.y1 - r.y0);
+    }
+
+    // 以 (x,y) 为中心、半径 r 的正方形（线宽、圆点等的外扩）
+    void addPoint(int x, int y, int r = 0) { add(x - r, y - r, 2 * r + 1, 2 * r + 1); }
+
+    bool intersects(const DirtyRect& r) const {
+        return !empty() && !r.empty() && x0 < r.x1 && r.x0 < x1 && y0 < r.y1 && r.y0 < y1;
+    }
+
+    // 裁剪到 [0,w) x [0,h)，并向外扩展到打包格式的字节边界，使之后的整字节复制不会切开像素
+    template <typename Packing>
+    void alignTo() {
+        if (x0 < 0) x0 = 0;
+        if (y0 < 0) y0 = 0;
+        if (x1 > Packing::WIDTH) x1 = Packing::WIDTH;
+        if (y1 > Packing::HEIGHT) y1 = Packing::HEIGHT;
+        if (empty()) {
+            clear();
+            return;
+        }
+        x0 = static_cast<int16_t>(x0 - x0 % Packing::PIXELS_X);
+        x1 = static_cast<int16_t>((x1 + Packing::PIXELS_X - 1) / Packing::PIXELS_X * Packing::PIXELS_X);
+        y0 = static_cast<int16_t>(y0 & ~1);
+        y1 = static_cast<int16_t>((y1 + 1) & ~1);
+    }
+};
+
+// 缓存的静态背景层
+// 表盘、边框等不变的内容只在背景缓冲中绘制一次；之后每帧只把上一帧动态内容覆盖过的区域
+// 从背景按整字节行复制回显存，再绘制新的动态内容，CPU开销与动态区域面积成正比。
+// 背景缓冲与显存同格式，由调用者提供（静态数组，或指向flash中预先生成的图像）。
+template <typename Packing>
+class BackgroundLayer {
+public:
+    using Framebuffer = PackedFramebuffer<Packing>;
+
+    explicit BackgroundLayer(const uint8_t* storage = nullptr) : data_(storage) {}
+
+    void attach(const uint8_t* storage) { data_ = storage; }
+    const uint8_t* data() const { return data_; }
+    bool valid() const { return data_ != nullptr; }
+
+    // 把当前显存整帧保存为背景（storage 必须可写）
+    void capture(const Framebuffer& src, uint8_t* storage) {
+        memcpy(storage, src.data(), Packing::BUFFER_LENGTH);
+        data_ = storage;
+    }
+
+    // 整帧恢复
+    void restore(Framebuffer& dst) const {
+        memcpy(dst.data(), data_, Packing::BUFFER_LENGTH);
+    }
+
+    // 恢复一个区域：先扩展到字节边界，再逐个字节行复制
+    void restore(Framebuffer& dst, DirtyRect rect) const {
+        rect.template alignTo<Packing>();
+        if (rect.empty()) return;
+        const uint16_t bx = static_cast<uint16_t>(rect.x0 / Packing::PIXELS_X);
+        const uint16_t bytes = static_cast<uint16_t>((rect.x1 - rect.x0) / Packing::PIXELS_X);
+        for (int row = rect.y0 / 2; row < rect.y1 / 2; row++) {
+            uint32_t offset = static_cast<uint32_t>(row) * Packing::STRIDE + bx;
+            memcpy(dst.data() + offset, data_ + offset, bytes);
+        }
+    }
+
+private:
+    const uint8_t* data_;
+};
+
+// 多层合成器
+// 每层是一块与显存同格式的打包缓冲，外加一块同格式的遮罩缓冲：遮罩中像素对应的位全为1表示
+// 该像素不透明、覆盖下层，全为0表示透明。层0在最下面，可以不带遮罩（视为全不透明）。
+// 各层分别记录脏矩形；compose() 只对脏区域按字节合成：
+//   out = (out & ~mask) | (pixels & mask)
+// 只有上层（光标、动画）变化时，下层不必重绘，合成开销与变化区域面积成正比。
+//
+// 典型用法：
+//   LayerCompositor<ST7306Packing, 3> comp;
+//   comp.addLayer(chrome_px);                  // 静态边框
+//   comp.addLayer(data_px, data_mask);         // 慢速数据
+//   comp.addLayer(cursor_px, cursor_mask);     // 光标/动画
+//   comp.clearRect(2, old_x, old_y, 8, 8);
+//   comp.fillRect(2, new_x, new_y, 8, 8, 3);
+//   comp.compose(display.framebuffer());
+//   display.display();
+template <typename Packing, uint8_t MaxLayers = 4>
+class LayerCompositor {
+public:
+    using Framebuffer = PackedFramebuffer<Packing>;
+    static constexpr uint8_t MAX_LAYERS = MaxLayers;
+    static constexpr uint8_t OPAQUE = Packing::MAX_LEVEL;  // 遮罩中"不透明"的灰度值（对应位全为1）
+
+    LayerCompositor() : count_(0) {}
+
+    // 追加一层（位于已有层之上），返回层号；层数已满返回 -1
+    // pixels/mask 各 Packing::BUFFER_LENGTH 字节，由调用者提供；mask 为空表示整层不透明
+    int8_t addLayer(uint8_t* pixels, uint8_t* mask = nullptr) {
+        if (count_ >= MaxLayers || pixels == nullptr) return -1;
+        Layer& l = layers_[count_];
+        l.pixels.attach(pixels);
+        l.mask.attach(mask);
+        l.visible = true;
+        l.dirty.clear();
+        l.dirty.add(0, 0, Packing::WIDTH, Packing::HEIGHT);
+        return static_cast<int8_t>(count_++);
+    }
+
+    uint8_t layerCount() const { return count_; }
+
+    // 直接访问某层的像素/遮罩（可配合 PackedFramebuffer 的绘图函数使用，绘制后需调用 invalidate）
+    Framebuffer& pixels(uint8_t layer) { return layers_[layer].pixels; }
+    Framebuffer& mask(uint8_t layer) { return layers_[layer].mask; }
+    bool hasMask(uint8_t layer) const { return layers_[layer].mask.data() != nullptr; }
+
+    // 标记某层的区域需要重新合成
+    void invalidate(uint8_t layer, int x, int y, int w, int h) {
+        if (layer < count_) layers_[layer].dirty.add(x, y, w, h);
+    }
+
+    void invalidate(uint8_t layer, const DirtyRect& rect) {
+        if (layer < count_) layers_[layer].dirty.add(rect);
+    }
+
+    void invalidateAll() {
+        for (uint8_t i = 0; i < count_; i++) {
+            layers_[i].dirty.clear();
+            layers_[i].dirty.add(0, 0, Packing::WIDTH, Packing::HEIGHT);
+        }
+    }
+
+    // 隐藏/显示整层：该层覆盖到的区域未知，按整屏处理
+    void setVisible(uint8_t layer, bool visible) {
+        if (layer >= count_ || layers_[layer].visible == visible) return;
+        layers_[layer].visible = visible;
+        layers_[layer].dirty.clear();
+        layers_[layer].dirty.add(0, 0, Packing::WIDTH, Packing::HEIGHT);
+    }
+
+    bool isVisible(uint8_t layer) const { return layer < count_ && layers_[layer].visible; }
+
+    // 在某层绘制不透明矩形（像素与遮罩同时写入）并标记脏区域
+    void fillRect(uint8_t layer, int x, int y, int w, int h, uint8_t level) {
+        if (layer >= count_) return;
+        Layer& l = layers_[layer];
+        l.pixels.fillRect(x, y, w, h, level);
+        if (l.mask.data()) l.mask.fillRect(x, y, w, h, OPAQUE);
+        l.dirty.add(x, y, w, h);
+    }
+
+    void setPixel(uint8_t layer, int x, int y, uint8_t level) {
+        if (layer >= count_) return;
+        Layer& l = layers_[layer];
+        l.pixels.setPixel(x, y, level);
+        if (l.mask.data()) l.mask.setPixel(x, y, OPAQUE);
+        l.dirty.add(x, y, 1, 1);
+    }
+
+    // 把某层的区域变为透明（无遮罩的层填为白色）
+    void clearRect(uint8_t layer, int x, int y, int w, int h) {
+        if (layer >= count_) return;
+        Layer& l = layers_[layer];
+        l.pixels.fillRect(x, y, w, h, 0);
+        if (l.mask.data()) l.mask.fillRect(x, y, w, h, 0);
+        l.dirty.add(x, y, w, h);
+    }
+
+    // 整层清为透明
+    void clearLayer(uint8_t layer) {
+        clearRect(layer, 0, 0, Packing::WIDTH, Packing::HEIGHT);
+    }
+
+    // 是否有待合成的区域
+    bool pending() const {
+        for (uint8_t i = 0; i < count_; i++) {
+            if (!layers_[i].dirty.empty()) return true;
+        }
+        return false;
+    }
+
+    // 把所有层的脏区域合成到 out，清除脏标记，返回本次写过区域的外接矩形（已按字节对齐，可用于局部刷新）
+    DirtyRect compose(Framebuffer& out) {
+        // 收集各层脏矩形，相交的合并，避免同一字节合成两次
+        DirtyRect rects[MaxLayers];
+        uint8_t n = 0;
+        for (uint8_t i = 0; i < count_; i++) {
+            DirtyRect r = layers_[i].dirty;
+            layers_[i].dirty.clear();
+            r.template alignTo<Packing>();
+            if (r.empty()) continue;
+            for (uint8_t j = 0; j < n;) {
+                if (rects[j].intersects(r)) {
+                    r.add(rects[j]);
+                    rects[j] = rects[--n];
+                    j = 0;
+                } else {
+                    j++;
+                }
+            }
+            rects[n++] = r;
+        }
+
+        DirtyRect written;
+        for (uint8_t i = 0; i < n; i++) {
+            composeRect(out, rects[i]);
+            written.add(rects[i]);
+        }
+        return written;
+    }
+
+private:
+    struct Layer {
+        Framebuffer pixels;
+        Framebuffer mask;
+        DirtyRect dirty;
+        bool visible = false;
+    };
+
+    // rect 已按字节对齐且非空
+    void composeRect(Framebuffer& out, const DirtyRect& rect) const {
+        // 最上面一个可见的无遮罩层会完全盖住它下面的层，从它开始合成
+        int8_t base = -1;
+        for (uint8_t i = 0; i < count_; i++) {
+            if (layers_[i].visible && layers_[i].mask.data() == nullptr) base = static_cast<int8_t>(i);
+        }
+
+        const uint16_t bx = static_cast<uint16_t>(rect.x0 / Packing::PIXELS_X);
+        const uint16_t bytes = static_cast<uint16_t>((rect.x1 - rect.x0) / Packing::PIXELS_X);
+        for (int row = rect.y0 / 2; row < rect.y1 / 2; row++) {
+            const uint32_t offset = static_cast<uint32_t>(row) * Packing::STRIDE + bx;
+            uint8_t* dst = out.data() + offset;
+            if (base >= 0) {
+                memcpy(dst, layers_[base].pixels.data() + offset, bytes);
+            } else {
+                memset(dst, 0, bytes);  // 没有不透明底层时为白色
+            }
+            for (uint8_t i = static_cast<uint8_t>(base + 1); i < count_; i++) {
+                const Layer& l = layers_[i];
+                if (!l.visible) continue;
+                const uint8_t* px = l.pixels.data() + offset;
+                const uint8_t* m = l.mask.data() + offset;
+                for (uint16_t b = 0; b < bytes; b++) {
+                    dst[b] = static_cast<uint8_t>((dst[b] & ~m[b]) | (px[b] & m[b]));
+                }
+            }
+        }
+    }
+
+    Layer layers_[MaxLayers];
+    uint8_t count_;
+};
+
+} // namespace st73xx
@@ -0,0 +1,150 @@
+#pragma once
+
+#include <cstdint>
+#include "st73xx_config.hpp"
+#if ST73XX_METRICS
+#include "pico/stdlib.h"
+#endif
+
+namespace st73xx {
+
+// 一帧的计数（一帧 = 两次刷新之间的绘制 + 一次刷新）
+struct FrameCounters {
+    uint32_t pixels;     // 写入显存的像素（区块按面积计）
+    uint32_t spans;      // 整块填充次数（fillRect、清屏）
+    uint32_t glyphs;     // 绘制的字符
+    uint32_t bus_bytes;  // 发往面板的字节（命令、参数与显存）
+    uint32_t render_us;  // 本帧第一次绘制（或 beginFrame()）到开始刷新
+    uint32_t flush_us;   // 刷新调用耗时；异步刷新只计启动传输的时间
+};
+
+struct MetricSummary {
+    uint32_t count;
+    uint32_t min;
+    uint32_t avg;
+    uint32_t max;
+    uint32_t p99;  // 来自对数直方图，误差不超过一个桶宽（约25%）
+};
+
+struct MetricsSnapshot {
+    uint32_t frames;
+    FrameCounters last;
+    MetricSummary pixels;
+    MetricSummary spans;
+    MetricSummary glyphs;
+    MetricSummary bus_bytes;
+    MetricSummary render_us;
+    MetricSummary flush_us;
+};
+
+#if ST73XX_METRICS
+
+// 每帧性能计数
+// 驱动与 ST73XX_UI 在绘制和刷新路径上通过 ST73XX_METRIC_* 宏计数，驱动的 display()/displayAsync()/
+// displayRows() 结束时把本帧计数计入各项的直方图。所有显示共用一份统计；计数不加锁，
+// 绘制与刷新应在同一个核上进行。
+class Metrics {
+public:
+    static constexpr bool ENABLED = true;
+
+    static void addPixels(uint32_t n) {
+        touch();
+        current_.pixels += n;
+    }
+    static void addSpan(uint32_t pixels) {
+        touch();
+        current_.spans++;
+        current_.pixels += pixels;
+    }
+    static void addGlyph() {
+        touch();
+        current_.glyphs++;
+    }
+    static void addBusBytes(uint32_t n) { current_.bus_bytes += n; }
+
+    // 显式标记本帧绘制开始；不调用时以刷新后的第一次绘制为准
+    static void beginFrame() {
+        frame_open_ = true;
+        render_start_us_ = time_us_32();
+    }
+
+    static void snapshot(MetricsSnapshot& out);
+    static void reset();
+    static void print();
+
+    // 刷新调用的作用域：嵌套时（如异步刷新退化为同步）只有最外层计时并结束本帧
+    class FlushScope {
+    public:
+        FlushScope() { flushBegin(); }
+        ~FlushScope() { flushEnd(); }
+        FlushScope(const FlushScope&) = delete;
+        FlushScope& operator=(const FlushScope&) = delete;
+    };
+
+private:
+    // 对数直方图：每个2的幂区间分4个桶；桶计数将要溢出时全部减半，分布偏向近期
+    class Histogram {
+    public:
+        static constexpr uint8_t BUCKETS = 128;
+
+        void add(uint32_t value);
+        MetricSummary summary() const;
+        void clear();
+
+    private:
+        static uint8_t bucketOf(uint32_t value);
+        static uint32_t bucketUpper(uint8_t bucket);
+
+        uint32_t count_ = 0;
+        uint32_t min_ = UINT32_MAX;
+        uint32_t max_ = 0;
+        uint64_t sum_ = 0;
+        uint16_t buckets_[BUCKETS] = {};
+    };
+
+    enum Field : uint8_t { Pixels, Spans, Glyphs, BusBytes, RenderUs, FlushUs, FIELD_COUNT };
+
+    static void touch() {
+        if (!frame_open_) beginFrame();
+    }
+    static void flushBegin();
+    static void flushEnd();
+
+    static FrameCounters current_;
+    static FrameCounters last_;
+    static Histogram histograms_[FIELD_COUNT];
+    static uint32_t frames_;
+    static uint32_t render_start_us_;
+    static uint32_t flush_start_us_;
+    static uint8_t flush_depth_;
+    static bool frame_open_;
+};
+
+#define ST73XX_METRIC_PIXELS(n) ::st73xx::Metrics::addPixels(n)
+#define ST73XX_METRIC_SPAN(pixels) ::st73xx::Metrics::addSpan(pixels)
+#define ST73XX_METRIC_GLYPH() ::st73xx::Metrics::addGlyph()
+#define ST73XX_METRIC_BUS_BYTES(n) ::st73xx::Metrics::addBusBytes(n)
+#define ST73XX_METRIC_FLUSH_SCOPE() ::st73xx::Metrics::FlushScope st73xx_metrics_flush_scope_
+
+#else
+
+// 关闭时的空实现：接口保持可用，宏不求值参数
+class Metrics {
+public:
+    static constexpr bool ENABLED = false;
+
+    static void beginFrame() {}
+    static void snapshot(MetricsSnapshot& out) { out = MetricsSnapshot{}; }
+    static void reset() {}
+    static void print() {}
+};
+
+#define ST73XX_METRIC_PIXELS(n) ((void)0)
+#define ST73XX_METRIC_SPAN(pixels) ((void)0)
+#define ST73XX_METRIC_GLYPH() ((void)0)
+#define ST73XX_METRIC_BUS_BYTES(n) ((void)0)
+#define ST73XX_METRIC_FLUSH_SCOPE() ((void)0)
+
+#endif
+
+} // namespace st73xx
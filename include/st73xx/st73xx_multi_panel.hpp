@@ -0,0 +1,200 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include "st73xx_init_sequence.hpp"
+
+namespace st73xx {
+
+// 刷新调度策略
+enum class FlushPolicy {
+    RoundRobin,  // 按面板顺序轮流
+    Priority     // 按 优先级 + 脏度 + 等待时间 打分，分高者先刷
+};
+
+// 多面板控制器
+// 多块面板共用一条SPI总线（CS各自独立），应用只提交刷新请求，
+// 由 poll() 在总线空闲时挑选下一块面板启动异步刷新（DMA/PIO传输下CPU不参与数据搬运）。
+//
+// Panel 需要提供：
+//   void initialize(InitMode mode);  bool wasWarmStart() const;
+//   void displayAsync();             bool isDisplayBusy() const;
+// ST7305Driver/ST7306Driver 以及主机端的 SimulatedPanel 都满足该要求。
+//
+// 本头文件不依赖Pico SDK；时间由调用者以微秒传入，便于在主机仿真中统计帧率。
+template <typename Panel, size_t MaxPanels = 4>
+class MultiPanelController {
+public:
+    struct PanelStats {
+        uint32_t requests = 0;     // 提交的刷新请求
+        uint32_t flushes = 0;      // 完成的刷新
+        uint32_t coalesced = 0;    // 排队期间被合并的请求
+        uint64_t max_wait_us = 0;  // 请求到开始传输的最长等待
+    };
+
+    explicit MultiPanelController(FlushPolicy policy = FlushPolicy::RoundRobin) :
+        policy_(policy)
+    {
+    }
+
+    // 返回面板编号，已满返回-1
+    int addPanel(Panel& panel, uint8_t priority = 0) {
+        if (count_ >= MaxPanels) return -1;
+        Slot& slot = slots_[count_];
+        slot = Slot();
+        slot.panel = &panel;
+        slot.priority = priority;
+        return static_cast<int>(count_++);
+    }
+
+    // 依次初始化所有面板
+    // 热启动标记由同型号面板共用，只有第一块面板按 mode 判定，其余面板跟随它的结果，
+    // 否则第一块面板写入标记后其余面板会被误判为热启动
+    void initializeAll(InitMode mode = InitMode::Auto) {
+        if (count_ == 0) return;
+        slots_[0].panel->initialize(mode);
+        InitMode rest = slots_[0].panel->wasWarmStart() ? InitMode::Warm : InitMode::Cold;
+        for (size_t i = 1; i < count_; i++) {
+            slots_[i].panel->initialize(rest);
+        }
+    }
+
+    void setPolicy(FlushPolicy policy) { policy_ = policy; }
+    FlushPolicy policy() const { return policy_; }
+    void setPriority(size_t index, uint8_t priority) { slots_[index].priority = priority; }
+
+    // 提交刷新请求；面板已在队列中时只累加脏度（如本帧改动的行数或像素数）
+    void requestFlush(size_t index, uint32_t dirtiness, uint64_t now_us) {
+        if (index >= count_) return;
+        Slot& slot = slots_[index];
+        slot.stats.requests++;
+        if (slot.pending) {
+            slot.stats.coalesced++;
+        } else {
+            slot.pending = true;
+            slot.request_us = now_us;
+        }
+        uint64_t d = static_cast<uint64_t>(slot.dirtiness) + dirtiness;
+        slot.dirtiness = d > 0xFFFFFFFFu ? 0xFFFFFFFFu : static_cast<uint32_t>(d);
+    }
+
+    // 面板正在传输时不得修改其显存
+    bool isFlushing(size_t index) const {
+        return static_cast<int>(index) == active_ && slots_[index].panel->isDisplayBusy();
+    }
+
+    bool isPending(size_t index) const { return slots_[index].pending; }
+
+    // 总线空闲时启动下一块面板的刷新；返回是否启动了新的传输
+    bool poll(uint64_t now_us) {
+        if (!busIdle()) return false;
+
+        int next = selectNext(now_us);
+        if (next < 0) return false;
+
+        Slot& slot = slots_[next];
+        uint64_t waited = now_us - slot.request_us;
+        if (waited > slot.stats.max_wait_us) slot.stats.max_wait_us = waited;
+        slot.pending = false;
+        slot.dirtiness = 0;
+        active_ = next;
+        next_rr_ = static_cast<size_t>(next) + 1;
+        if (!window_started_) {
+            window_started_ = true;
+            window_start_us_ = now_us;
+        }
+        slot.panel->displayAsync();
+        return true;
+    }
+
+    // 阻塞直到队列清空且总线空闲，now_us 由回调提供
+    template <typename NowUs>
+    void flushAll(NowUs&& now_us) {
+        while (hasPending() || !busIdle()) {
+            poll(now_us());
+        }
+    }
+
+    bool hasPending() const {
+        for (size_t i = 0; i < count_; i++) {
+            if (slots_[i].pending) return true;
+        }
+        return false;
+    }
+
+    size_t panelCount() const { return count_; }
+    const PanelStats& stats(size_t index) const { return slots_[index].stats; }
+    uint32_t totalFlushes() const { return total_flushes_; }
+
+    // 自 resetStats() 后第一次刷新起，所有面板合计的每秒刷新帧数
+    float aggregateFps(uint64_t now_us) const {
+        if (!window_started_ || total_flushes_ == 0 || now_us <= window_start_us_) return 0.0f;
+        return total_flushes_ * 1000000.0f / static_cast<float>(now_us - window_start_us_);
+    }
+
+    void resetStats() {
+        for (size_t i = 0; i < count_; i++) {
+            slots_[i].stats = PanelStats();
+        }
+        total_flushes_ = 0;
+        window_started_ = false;
+        window_start_us_ = 0;
+    }
+
+private:
+    struct Slot {
+        Panel* panel = nullptr;
+        uint8_t priority = 0;
+        bool pending = false;
+        uint32_t dirtiness = 0;
+        uint64_t request_us = 0;
+        PanelStats stats;
+    };
+
+    // 上一次启动的传输结束时记一帧
+    bool busIdle() {
+        if (active_ < 0) return true;
+        if (slots_[active_].panel->isDisplayBusy()) return false;
+        slots_[active_].stats.flushes++;
+        total_flushes_++;
+        active_ = -1;
+        return true;
+    }
+
+    int selectNext(uint64_t now_us) const {
+        if (count_ == 0) return -1;
+        if (policy_ == FlushPolicy::RoundRobin) {
+            for (size_t n = 0; n < count_; n++) {
+                size_t i = (next_rr_ + n) % count_;
+                if (slots_[i].pending) return static_cast<int>(i);
+            }
+            return -1;
+        }
+
+        // 优先级每级相当于256个脏度单位；等待时间每毫秒加1分，防止低优先级面板饿死
+        int best = -1;
+        uint64_t best_score = 0;
+        for (size_t i = 0; i < count_; i++) {
+            const Slot& slot = slots_[i];
+            if (!slot.pending) continue;
+            uint64_t score = (static_cast<uint64_t>(slot.priority) << 8) + slot.dirtiness +
+                             (now_us - slot.request_us) / 1000;
+            if (best < 0 || score > best_score) {
+                best = static_cast<int>(i);
+                best_score = score;
+            }
+        }
+        return best;
+    }
+
+    Slot slots_[MaxPanels];
+    size_t count_ = 0;
+    FlushPolicy policy_;
+    int active_ = -1;
+    size_t next_rr_ = 0;
+    uint32_t total_flushes_ = 0;
+    bool window_started_ = false;
+    uint64_t window_start_us_ = 0;
+};
+
+} // namespace st73xx
@@ -0,0 +1,335 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace st73xx {
+
+// 面板显存打包格式
+// ST73xx 系列的显存都是"上下两行共用一个字节"，每字节横向容纳 4/Bits 个像素：
+//   ST7305 (1bit): 4x2 像素/字节    P0P2 P4P6 -> BIT7 BIT5 BIT3 BIT1
+//                                    P1P3 P5P7 -> BIT6 BIT4 BIT2 BIT0
+//   ST7306 (2bit): 2x2 像素/字节，每个像素的灰度高位在前、低位在后
+// 像素 (col,row) 的第 plane 位（plane 0 为灰度最高位）位于 7-(col*2*Bits + plane*2 + row)。
+template <uint16_t Width, uint16_t Height, uint8_t Bits>
+struct PanelPacking {
+    static_assert(Bits == 1 || Bits == 2, "only 1-bit and 2-bit packing are supported");
+    static_assert(Width % (4 / Bits) == 0 && Height % 2 == 0, "panel size must be byte aligned");
+
+    static constexpr uint16_t WIDTH = Width;
+    static constexpr uint16_t HEIGHT = Height;
+    static constexpr uint8_t BITS = Bits;
+    static constexpr uint8_t PIXELS_X = 4 / Bits;  // 每字节横向像素数
+    static constexpr uint8_t PIXELS_Y = 2;         // 每字节纵向像素数
+    static constexpr uint16_t STRIDE = Width / PIXELS_X;
+    static constexpr uint16_t ROWS = Height / PIXELS_Y;
+    static constexpr uint32_t BUFFER_LENGTH = static_cast<uint32_t>(STRIDE) * ROWS;
+    static constexpr uint8_t MAX_LEVEL = (1u << Bits) - 1;
+
+    static constexpr uint8_t bitPosition(uint8_t col, uint8_t row, uint8_t plane) {
+        return static_cast<uint8_t>(7 - (col * 2 * Bits + plane * 2 + row));
+    }
+};
+
+using ST7305Packing = PanelPacking<168, 384, 1>;
+using ST7306Packing = PanelPacking<300, 400, 2>;
+// ST7306 单色工作缓冲：与面板同尺寸的1bit打包（15000字节），刷新时展开为2bit
+using ST7306MonoPacking = PanelPacking<300, 400, 1>;
+
+// 打包显存视图
+// 不持有存储，由驱动（或调用者）提供 Packing::BUFFER_LENGTH 字节的缓冲区。
+// 所有坐标都是物理坐标；level 为灰度级（1bit面板：0白 1黑；2bit面板：0白 ~ 3黑）。
+// 像素位置与灰度的位图案在编译期查表生成，span/rect 内核按字节整块写入。
+template <typename Packing>
+class PackedFramebuffer {
+public:
+    static constexpr uint16_t WIDTH = Packing::WIDTH;
+    static constexpr uint16_t HEIGHT = Packing::HEIGHT;
+    static constexpr uint16_t STRIDE = Packing::STRIDE;
+    static constexpr uint16_t ROWS = Packing::ROWS;
+    static constexpr uint32_t BUFFER_LENGTH = Packing::BUFFER_LENGTH;
+    static constexpr uint8_t PIXELS_X = Packing::PIXELS_X;
+    static constexpr uint8_t MAX_LEVEL = Packing::MAX_LEVEL;
+
+    explicit PackedFramebuffer(uint8_t* data = nullptr) : data_(data) {}
+
+    void attach(uint8_t* data) { data_ = data; }
+    uint8_t* data() { return data_; }
+    const uint8_t* data() const { return data_; }
+    static constexpr size_t size() { return BUFFER_LENGTH; }
+
+    // 按原始字节填充
+    void fillBytes(uint8_t value) { memset(data_, value, BUFFER_LENGTH); }
+
+    // 整屏填充为同一灰度
+    void fill(uint8_t level) { memset(data_, TABLES.fill[level & MAX_LEVEL], BUFFER_LENGTH); }
+
+    void setPixel(int x, int y, uint8_t level) {
+        if (x < 0 || y < 0 || x >= WIDTH || y >= HEIGHT) return;
+        setPixelUnchecked(static_cast<uint16_t>(x), static_cast<uint16_t>(y), level);
+    }
+
+    void setPixelUnchecked(uint16_t x, uint16_t y, uint8_t level) {
+        uint8_t slot = slotOf(x, y);
+        uint8_t& b = data_[indexOf(x, y)];
+        b = static_cast<uint8_t>((b & ~TABLES.mask[slot]) | TABLES.bits[slot][level & MAX_LEVEL]);
+    }
+
+    uint8_t getPixel(int x, int y) const {
+        if (x < 0 || y < 0 || x >= WIDTH || y >= HEIGHT) return 0;
+        uint8_t col = static_cast<uint8_t>(x % PIXELS_X);
+        uint8_t row = static_cast<uint8_t>(y & 1);
+        uint8_t b = data_[indexOf(static_cast<uint16_t>(x), static_cast<uint16_t>(y))];
+        uint8_t level = 0;
+        for (uint8_t plane = 0; plane < Packing::BITS; plane++) {
+            level = static_cast<uint8_t>((level << 1) | ((b >> Packing::bitPosition(col, row, plane)) & 1));
+        }
+        return level;
+    }
+
+    // 水平/垂直线段，端点包含在内，自动裁剪
+    void hspan(int x0, int x1, int y, uint8_t level) {
+        if (x0 > x1) { int t = x0; x0 = x1; x1 = t; }
+        fillRect(x0, y, x1 - x0 + 1, 1, level);
+    }
+
+    void vspan(int x, int y0, int y1, uint8_t level) {
+        if (y0 > y1) { int t = y0; y0 = y1; y1 = t; }
+        fillRect(x, y0, 1, y1 - y0 + 1, level);
+    }
+
+    // 矩形填充：按字节行（两条像素行）处理，中间整字节直接写入
+    void fillRect(int x, int y, int w, int h, uint8_t level) {
+        int x0 = x < 0 ? 0 : x;
+        int y0 = y < 0 ? 0 : y;
+        int x1 = x + w > WIDTH ? WIDTH : x + w;    // 不含
+        int y1 = y + h > HEIGHT ? HEIGHT : y + h;  // 不含
+        if (x0 >= x1 || y0 >= y1) return;
+
+        const uint8_t pattern = TABLES.fill[level & MAX_LEVEL];
+        const int bx0 = x0 / PIXELS_X;
+        const int bx1 = (x1 - 1) / PIXELS_X;
+        const uint8_t c0 = static_cast<uint8_t>(x0 % PIXELS_X);
+        const uint8_t c1 = static_cast<uint8_t>((x1 - 1) % PIXELS_X);
+
+        for (int yy = y0; yy < y1; yy = (yy | 1) + 1) {
+            uint8_t r0 = static_cast<uint8_t>(yy & 1);
+            uint8_t r1 = ((yy | 1) < y1) ? 1 : r0;
+            uint8_t rows = static_cast<uint8_t>(TABLES.row_mask[r0] | TABLES.row_mask[r1]);
+            uint8_t* line = data_ + static_cast<uint32_t>(yy >> 1) * STRIDE;
+
+            if (bx0 == bx1) {
+                writeMasked(line[bx0], static_cast<uint8_t>(TABLES.col_mask[c0][c1] & rows), pattern);
+                continue;
+            }
+            writeMasked(line[bx0], static_cast<uint8_t>(TABLES.col_mask[c0][PIXELS_X - 1] & rows), pattern);
+            if (rows == 0xFF) {
+                memset(line + bx0 + 1, pattern, static_cast<size_t>(bx1 - bx0 - 1));
+            } else {
+                for (int bx = bx0 + 1; bx < bx1; bx++) {
+                    writeMasked(line[bx], rows, pattern);
+                }
+            }
+            writeMasked(line[bx1], static_cast<uint8_t>(TABLES.col_mask[0][c1] & rows), pattern);
+        }
+    }
+
+    // 字形：每行一个字节，bit7为最左像素（与 font::get_char_data 格式一致）
+    // opaque=false 时背景像素保持不变
+    void drawGlyph(int x, int y, const uint8_t* rows, uint8_t w, uint8_t h,
+                   uint8_t fg, uint8_t bg, bool opaque = true) {
+        if (w > 8) w = 8;
+        blitBitmap(x, y, rows, w, h, 1, fg, bg, opaque);
+    }
+
+    // 1bpp位图（行优先，MSB在左，每行 stride 字节）
+    void blitBitmap(int x, int y, const uint8_t* bitmap, uint16_t w, uint16_t h, uint16_t stride,
+                    uint8_t fg, uint8_t bg, bool opaque = true) {
+        int sx0 = x < 0 ? -x : 0;
+        int sy0 = y < 0 ? -y : 0;
+        int sx1 = x + w > WIDTH ? WIDTH - x : w;
+        int sy1 = y + h > HEIGHT ? HEIGHT - y : h;
+        for (int sy = sy0; sy < sy1; sy++) {
+            const uint8_t* src = bitmap + static_cast<uint32_t>(sy) * stride;
+            uint16_t py = static_cast<uint16_t>(y + sy);
+            for (int sx = sx0; sx < sx1; sx++) {
+                bool on = (src[sx >> 3] >> (7 - (sx & 7))) & 1;
+                if (on) {
+                    setPixelUnchecked(static_cast<uint16_t>(x + sx), py, fg);
+                } else if (opaque) {
+                    setPixelUnchecked(static_cast<uint16_t>(x + sx), py, bg);
+                }
+            }
+        }
+    }
+
+    // 从同格式显存复制矩形；源与目标都按字节对齐时整字节复制
+    void copyRect(const PackedFramebuffer& src, int sx, int sy, int w, int h, int dx, int dy) {
+        if (sx < 0) { w += sx; dx -= sx; sx = 0; }
+        if (sy < 0) { h += sy; dy -= sy; sy = 0; }
+        if (dx < 0) { w += dx; sx -= dx; dx = 0; }
+        if (dy < 0) { h += dy; sy -= dy; dy = 0; }
+        if (sx + w > WIDTH) w = WIDTH - sx;
+        if (sy + h > HEIGHT) h = HEIGHT - sy;
+        if (dx + w > WIDTH) w = WIDTH - dx;
+        if (dy + h > HEIGHT) h = HEIGHT - dy;
+        if (w <= 0 || h <= 0) return;
+
+        bool aligned = (sx % PIXELS_X) == 0 && (dx % PIXELS_X) == 0 && (w % PIXELS_X) == 0 &&
+                       (sy & 1) == 0 && (dy & 1) == 0 && (h & 1) == 0;
+        if (aligned && &src != this) {
+            for (int r = 0; r < h / 2; r++) {
+                memcpy(data_ + static_cast<uint32_t>(dy / 2 + r) * STRIDE + dx / PIXELS_X,
+                       src.data_ + static_cast<uint32_t>(sy / 2 + r) * STRIDE + sx / PIXELS_X,
+                       static_cast<size_t>(w / PIXELS_X));
+            }
+            return;
+        }
+        for (int r = 0; r < h; r++) {
+            for (int c = 0; c < w; c++) {
+                setPixelUnchecked(static_cast<uint16_t>(dx + c), static_cast<uint16_t>(dy + r),
+                                  src.getPixel(sx + c, sy + r));
+            }
+        }
+    }
+
+    // 驱动自带的旋转：逻辑坐标 -> 物理坐标（0:默认，1:90度，2:180度，3:270度）
+    static void rotate(int rotation, uint16_t& x, uint16_t& y) {
+        uint16_t tx = x, ty = y;
+        switch (rotation & 3) {
+            case 1:
+                tx = WIDTH - 1 - y;
+                ty = x;
+                break;
+            case 2:
+                tx = WIDTH - 1 - x;
+                ty = HEIGHT - 1 - y;
+                break;
+            case 3:
+                tx = y;
+                ty = HEIGHT - 1 - x;
+                break;
+            default:
+                break;
+        }
+        x = tx;
+        y = ty;
+    }
+
+    static constexpr uint32_t indexOf(uint16_t x, uint16_t y) {
+        return static_cast<uint32_t>(y >> 1) * STRIDE + x / PIXELS_X;
+    }
+
+private:
+    static constexpr uint8_t SLOTS = PIXELS_X * 2;
+
+    struct Tables {
+        uint8_t mask[SLOTS];                     // 像素在字节内占用的位
+        uint8_t bits[SLOTS][MAX_LEVEL + 1];      // 像素取某灰度时的位图案
+        uint8_t fill[MAX_LEVEL + 1];             // 整字节都取某灰度
+        uint8_t row_mask[2];                     // 上/下行全部像素
+        uint8_t col_mask[PIXELS_X][PIXELS_X];    // 第c0~c1列（含）两行的全部像素
+    };
+
+    static constexpr Tables makeTables() {
+        Tables t{};
+        for (uint8_t col = 0; col < PIXELS_X; col++) {
+            for (uint8_t row = 0; row < 2; row++) {
+                uint8_t slot = static_cast<uint8_t>(col * 2 + row);
+                for (uint8_t plane = 0; plane < Packing::BITS; plane++) {
+                    uint8_t bit = static_cast<uint8_t>(1u << Packing::bitPosition(col, row, plane));
+                    t.mask[slot] |= bit;
+                    t.row_mask[row] |= bit;
+                    for (uint8_t level = 0; level <= MAX_LEVEL; level++) {
+                        if ((level >> (Packing::BITS - 1 - plane)) & 1) {
+                            t.bits[slot][level] |= bit;
+                        }
+                    }
+                }
+                for (uint8_t level = 0; level <= MAX_LEVEL; level++) {
+                    t.fill[level] |= t.bits[slot][level];
+                }
+            }
+        }
+        for (uint8_t c0 = 0; c0 < PIXELS_X; c0++) {
+            for (uint8_t c1 = c0; c1 < PIXELS_X; c1++) {
+                for (uint8_t c = c0; c <= c1; c++) {
+                    t.col_mask[c0][c1] |= static_cast<uint8_t>(t.mask[c * 2] | t.mask[c * 2 + 1]);
+                }
+            }
+        }
+        return t;
+    }
+
+    static constexpr Tables TABLES = makeTables();
+
+    static constexpr uint8_t slotOf(uint16_t x, uint16_t y) {
+        return static_cast<uint8_t>((x % PIXELS_X) * 2 + (y & 1));
+    }
+
+    static void writeMasked(uint8_t& b, uint8_t mask, uint8_t pattern) {
+        b = static_cast<uint8_t>((b & ~mask) | (pattern & mask));
+    }
+
+    uint8_t* data_;
+};
+
+// 打包格式展开：1bit源 -> 2bit目标（同尺寸）
+// 源字节含4x2像素，正好对应目标的两个字节；置位像素展开为最深灰度（两个位平面都置位）。
+// 256项查找表在编译期生成，每个字节行只需一次查表和两次写入。
+template <typename Src, typename Dst>
+class PackingExpander {
+public:
+    static_assert(Src::BITS == 1 && Dst::BITS == 2, "only 1-bit to 2-bit expansion is supported");
+    static_assert(Src::WIDTH == Dst::WIDTH && Src::HEIGHT == Dst::HEIGHT, "packings must describe the same panel");
+
+    static constexpr uint16_t SRC_STRIDE = Src::STRIDE;
+    static constexpr uint16_t DST_STRIDE = Dst::STRIDE;
+    static constexpr uint16_t ROWS = Src::ROWS;
+
+    // 展开一个字节行：src 为 SRC_STRIDE 字节，dst 为 DST_STRIDE 字节
+    static void expandRow(const uint8_t* src, uint8_t* dst) {
+        for (uint16_t i = 0; i < SRC_STRIDE; i++) {
+            const uint8_t* pair = TABLE.bytes[src[i]];
+            dst[0] = pair[0];
+            dst[1] = pair[1];
+            dst += 2;
+        }
+    }
+
+    // 展开连续多个字节行
+    static void expandRows(const uint8_t* src, uint8_t* dst, uint16_t rows) {
+        for (uint16_t r = 0; r < rows; r++) {
+            expandRow(src + static_cast<uint32_t>(r) * SRC_STRIDE, dst + static_cast<uint32_t>(r) * DST_STRIDE);
+        }
+    }
+
+private:
+    struct Table {
+        uint8_t bytes[256][2];
+    };
+
+    static constexpr Table makeTable() {
+        Table t{};
+        for (uint16_t v = 0; v < 256; v++) {
+            for (uint8_t col = 0; col < Src::PIXELS_X; col++) {
+                for (uint8_t row = 0; row < 2; row++) {
+                    if (!((v >> Src::bitPosition(col, row, 0)) & 1)) continue;
+                    uint8_t dcol = static_cast<uint8_t>(col % Dst::PIXELS_X);
+                    for (uint8_t plane = 0; plane < Dst::BITS; plane++) {
+                        t.bytes[v][col / Dst::PIXELS_X] |=
+                            static_cast<uint8_t>(1u << Dst::bitPosition(dcol, row, plane));
+                    }
+                }
+            }
+        }
+        return t;
+    }
+
+    static constexpr Table TABLE = makeTable();
+};
+
+using ST7306MonoExpander = PackingExpander<ST7306MonoPacking, ST7306Packing>;
+
+} // namespace st73xx
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "st73xx_command_batch.hpp"
+#include "st73xx_init_sequence.hpp"
+#include "st73xx_recording_transport.hpp"
+
+namespace st73xx {
+
+// 主机端面板仿真（不依赖Pico SDK）
+// 多块 SimulatedPanel 共用一个 SimulatedClock，每次刷新的总线占用时间由
+// RecordingTransport 的时序模型给出，从而可以在主机上统计多面板调度的合计帧率。
+
+class SimulatedClock {
+public:
+    uint64_t nowNs() const { return now_ns_; }
+    uint64_t nowUs() const { return now_ns_ / 1000; }
+    void advanceNs(uint64_t ns) { now_ns_ += ns; }
+    void advanceUs(uint64_t us) { now_ns_ += us * 1000; }
+
+private:
+    uint64_t now_ns_ = 0;
+};
+
+class SimulatedPanel {
+public:
+    // buffer_length: 显存字节数（ST7306为30000，ST7305为8064）
+    // stride: 每字节行的字节数（ST7306为150，ST7305为42），用于行带局部刷新
+    SimulatedPanel(SimulatedClock& clock, size_t buffer_length,
+                   const BusTiming& timing = BusTiming::dmaSpi(), uint16_t stride = 150) :
+        clock_(clock),
+        transport_(timing, false),
+        buffer_(buffer_length, 0),
+        stride_(stride)
+    {
+    }
+
+    void initialize(InitMode mode) {
+        warm_started_ = (mode == InitMode::Warm);
+        initialized_ = true;
+    }
+    bool wasWarmStart() const { return warm_started_; }
+    bool is_initialized() const { return initialized_; }
+
+    void displayAsync() {
+        CommandBatch batch;
+        batch.command(0x2A, {0x05, 0x36})
+             .command(0x2B, {0x00, 0xC7})
+             .command(0x2C);
+        uint64_t before = transport_.nowNs();
+        transport_.write(batch, buffer_.data(), buffer_.size());
+        busy_until_ns_ = clock_.nowNs() + (transport_.nowNs() - before);
+        frames_++;
+    }
+
+    void display() {
+        displayAsync();
+        if (busy_until_ns_ > clock_.nowNs()) {
+            clock_.advanceNs(busy_until_ns_ - clock_.nowNs());
+        }
+    }
+
+    // 局部刷新字节行 [first_row, first_row + row_count)，与 ST7306Driver::displayRows() 的总线内容一致
+    void displayRows(uint16_t first_row, uint16_t row_count) {
+        CommandBatch batch;
+        batch.command(0x2A, {0x05, 0x36})
+             .command(0x2B, {static_cast<uint8_t>(first_row), static_cast<uint8_t>(first_row + row_count - 1)})
+             .command(0x2C);
+        uint64_t before = transport_.nowNs();
+        transport_.write(batch, buffer_.data() + static_cast<size_t>(first_row) * stride_,
+                         static_cast<size_t>(row_count) * stride_);
+        clock_.advanceNs(transport_.nowNs() - before);
+        frames_++;
+    }
+
+    bool isDisplayBusy() const { return clock_.nowNs() < busy_until_ns_; }
+    uint64_t busyUntilNs() const { return busy_until_ns_; }
+
+    uint8_t* buffer() { return buffer_.data(); }
+    size_t bufferLength() const { return buffer_.size(); }
+    uint16_t stride() const { return stride_; }
+    uint32_t frames() const { return frames_; }
+    const RecordingTransport& transport() const { return transport_; }
+
+private:
+    SimulatedClock& clock_;
+    RecordingTransport transport_;
+    std::vector<uint8_t> buffer_;
+    uint16_t stride_;
+    uint64_t busy_until_ns_ = 0;
+    uint32_t frames_ = 0;
+    bool warm_started_ = false;
+    bool initialized_ = false;
+};
+
+} // namespace st73xx
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include "pico/stdlib.h"
+#include "hardware/pio.h"
+#include "st73xx_command_batch.hpp"
+#include "st73xx_transport.hpp"
+#include "st73xx_tagged_stream.hpp"
+
+namespace st73xx {
+
+// 基于PIO状态机的显示传输
+// 批次被编码为标记流（见 st73xx_tagged_stream.hpp），由两个链接的DMA通道送入状态机：
+// 第一个通道发送段头和命令字节，结束后自动触发第二个通道直接从显存发送负载。
+// DC与CS由状态机在段边界处驱动，整次更新期间CPU无需介入。
+//
+// 引脚要求：SCK 必须等于 cs_pin + 1（侧置引脚连续），MOSI与DC可任意选择。
+class PioTransport : public Transport {
+public:
+    static constexpr size_t MAX_PREFIX_WORDS = CommandBatch::MAX_BYTES + CommandBatch::MAX_RUNS + 1;
+
+    PioTransport(PIO pio, uint dc_pin, uint res_pin, uint cs_pin, uint mosi_pin, uint32_t baudrate = 40000000);
+    ~PioTransport() override;
+
+    // 装载PIO程序并申请状态机与DMA通道
+    bool begin() override;
+
+    // 阻塞发送：返回时CS已拉高
+    void write(const CommandBatch& batch, const uint8_t* payload = nullptr, size_t len = 0) override;
+
+    // 启动传输后立即返回；负载在传输完成前必须保持不变
+    bool writeAsync(const CommandBatch& batch, const uint8_t* payload = nullptr, size_t len = 0) override;
+
+    // 分块发送：前缀中的负载段头已包含总长度，各块由负载DMA通道依次送入FIFO
+    bool beginWrite(const CommandBatch& batch, size_t payload_len) override;
+    void writeChunk(const uint8_t* data, size_t len) override;
+    void endWrite() override;
+
+    bool busy() const override;
+    void wait() override;
+
+    void setReset(bool level) override;
+    bool resetPinWasHigh() const override { return reset_was_high_; }
+    void delayMs(uint32_t ms) override;
+
+private:
+    PIO pio_;
+    const uint dc_pin_;
+    const uint res_pin_;
+    const uint cs_pin_;
+    const uint mosi_pin_;
+    const uint32_t baudrate_;
+
+    uint sm_ = 0;
+    uint offset_ = 0;
+    int dma_prefix_ = -1;
+    int dma_payload_ = -1;
+    bool started_ = false;
+    bool reset_was_high_ = true;
+    bool traced_ = false;  // 追踪中的显存传输尚未记录结束
+
+    void startPrefixDma(size_t words, bool chain);
+    void startPayloadDma(const uint8_t* data, size_t len, bool trigger);
+
+    uint32_t prefix_[MAX_PREFIX_WORDS];
+};
+
+} // namespace st73xx
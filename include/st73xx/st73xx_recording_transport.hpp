@@ -0,0 +1,185 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "st73xx_transport.hpp"
+
+namespace st73xx {
+
+// 总线时序模型（单位ns），用于在主机端估算不同传输方式的效率
+// 预设值为RP2040@125MHz上的粗略测量，只用于相对比较
+struct BusTiming {
+    uint32_t sck_hz = 40000000;
+    uint32_t byte_gap_ns = 0;          // 字节之间的额外空隙
+    uint32_t run_overhead_ns = 0;      // 每段开销：等待FIFO排空、切换DC
+    uint32_t transaction_overhead_ns = 0; // 每次CS拉低/拉高及调用开销
+
+    // 阻塞SPI：每段结束都要等FIFO排空才能切换DC
+    static BusTiming blockingSpi(uint32_t sck_hz = 40000000) {
+        return BusTiming{sck_hz, 0, 1200, 800};
+    }
+    // DMA SPI：命令阻塞发送，负载由DMA连续送出；多出一次通道配置
+    static BusTiming dmaSpi(uint32_t sck_hz = 40000000) {
+        return BusTiming{sck_hz, 0, 1200, 2000};
+    }
+    // PIO：段头由状态机解析，约10个状态机周期；每字节多3个周期的取数与循环
+    static BusTiming pio(uint32_t sck_hz = 40000000) {
+        uint32_t cycle_ns = 500000000u / sck_hz; // 每个数据位2个周期
+        return BusTiming{sck_hz, 3 * cycle_ns, 10 * cycle_ns, 1500};
+    }
+
+    uint64_t byteNs() const { return 8000000000ull / sck_hz; }
+};
+
+// 主机端记录传输
+// 捕获驱动发出的完整字节流（含DC电平、事务边界、复位和延时），并按 BusTiming 推算时间。
+// 可用来在没有硬件的情况下比较批处理/传输方式的效率，或校验初始化序列。
+class RecordingTransport : public Transport {
+public:
+    enum class EventType : uint8_t {
+        Run,     // 同一DC电平的一段字节，bytes()[offset .. offset+length)
+        Reset,   // 复位脚电平变化，level有效
+        Delay    // 面板时序延时，length为毫秒数
+    };
+
+    struct Event {
+        EventType type;
+        bool is_data;          // Run: DC电平；Reset: 电平
+        uint32_t transaction;  // 所属事务序号
+        uint32_t offset;
+        uint32_t length;
+        uint64_t start_ns;
+        uint64_t end_ns;
+    };
+
+    struct Stats {
+        uint32_t transactions = 0;
+        uint32_t runs = 0;
+        uint32_t command_bytes = 0;
+        uint32_t data_bytes = 0;      // 含负载
+        uint32_t payload_bytes = 0;
+        uint64_t bus_ns = 0;          // 总线占用时间（不含延时）
+        uint64_t delay_ns = 0;
+
+        // 理想传输时间 / 实际总线时间
+        double efficiency(const BusTiming& timing) const {
+            if (bus_ns == 0) return 0.0;
+            return static_cast<double>(timing.byteNs() * (command_bytes + data_bytes)) / bus_ns;
+        }
+    };
+
+    explicit RecordingTransport(const BusTiming& timing = BusTiming::blockingSpi(), bool keep_bytes = true) :
+        timing_(timing),
+        keep_bytes_(keep_bytes)
+    {
+    }
+
+    bool begin() override { return true; }
+
+    void write(const CommandBatch& batch, const uint8_t* payload = nullptr, size_t len = 0) override {
+        now_ns_ += timing_.transaction_overhead_ns;
+        const uint8_t* bytes = batch.bytes();
+        for (size_t i = 0; i < batch.runCount(); i++) {
+            const CommandBatch::Run& run = batch.run(i);
+            addRun(bytes + run.offset, run.length, run.is_data);
+        }
+        if (payload && len > 0) {
+            addRun(payload, len, true);
+            stats_.payload_bytes += static_cast<uint32_t>(len);
+        }
+        stats_.transactions++;
+        stats_.bus_ns = now_ns_ - stats_.delay_ns;
+    }
+
+    // 分块发送：各块在记录中合并为一段数据，与一次性发送的结果相同
+    bool beginWrite(const CommandBatch& batch, size_t payload_len) override {
+        if (payload_len == 0) return false;
+        now_ns_ += timing_.transaction_overhead_ns;
+        const uint8_t* bytes = batch.bytes();
+        for (size_t i = 0; i < batch.runCount(); i++) {
+            const CommandBatch::Run& run = batch.run(i);
+            addRun(bytes + run.offset, run.length, run.is_data);
+        }
+        stream_run_ = -1;
+        return true;
+    }
+
+    void writeChunk(const uint8_t* data, size_t len) override {
+        if (len == 0) return;
+        if (stream_run_ < 0) {
+            addRun(data, len, true);
+            stream_run_ = static_cast<int32_t>(events_.size() - 1);
+        } else {
+            now_ns_ += len * (timing_.byteNs() + timing_.byte_gap_ns);
+            if (keep_bytes_) {
+                bytes_.insert(bytes_.end(), data, data + len);
+            }
+            Event& event = events_[stream_run_];
+            event.length += static_cast<uint32_t>(len);
+            event.end_ns = now_ns_;
+            stats_.data_bytes += static_cast<uint32_t>(len);
+        }
+        stats_.payload_bytes += static_cast<uint32_t>(len);
+    }
+
+    void endWrite() override {
+        stream_run_ = -1;
+        stats_.transactions++;
+        stats_.bus_ns = now_ns_ - stats_.delay_ns;
+    }
+
+    void setReset(bool level) override {
+        events_.push_back(Event{EventType::Reset, level, stats_.transactions, 0, 0, now_ns_, now_ns_});
+    }
+
+    void delayMs(uint32_t ms) override {
+        uint64_t start = now_ns_;
+        now_ns_ += static_cast<uint64_t>(ms) * 1000000;
+        stats_.delay_ns += now_ns_ - start;
+        events_.push_back(Event{EventType::Delay, false, stats_.transactions, 0, ms, start, now_ns_});
+    }
+
+    const std::vector<Event>& events() const { return events_; }
+    const std::vector<uint8_t>& bytes() const { return bytes_; }
+    const Stats& stats() const { return stats_; }
+    const BusTiming& timing() const { return timing_; }
+    uint64_t nowNs() const { return now_ns_; }
+
+    void clear() {
+        events_.clear();
+        bytes_.clear();
+        stats_ = Stats();
+        now_ns_ = 0;
+    }
+
+private:
+    void addRun(const uint8_t* data, size_t len, bool is_data) {
+        uint64_t start = now_ns_;
+        now_ns_ += timing_.run_overhead_ns + len * (timing_.byteNs() + timing_.byte_gap_ns);
+
+        uint32_t offset = static_cast<uint32_t>(bytes_.size());
+        if (keep_bytes_) {
+            bytes_.insert(bytes_.end(), data, data + len);
+        }
+        events_.push_back(Event{EventType::Run, is_data, stats_.transactions, offset,
+                                static_cast<uint32_t>(len), start, now_ns_});
+
+        stats_.runs++;
+        if (is_data) {
+            stats_.data_bytes += static_cast<uint32_t>(len);
+        } else {
+            stats_.command_bytes += static_cast<uint32_t>(len);
+        }
+    }
+
+    BusTiming timing_;
+    bool keep_bytes_;
+    std::vector<Event> events_;
+    std::vector<uint8_t> bytes_;
+    Stats stats_;
+    uint64_t now_ns_ = 0;
+    int32_t stream_run_ = -1;  // 分块发送中正在累积的数据段事件
+};
+
+} // namespace st73xx
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include "pico/stdlib.h"
+#include "hardware/spi.h"
+#include "st73xx_transport.hpp"
+
+namespace st73xx {
+
+// 阻塞SPI传输
+// 可用于任一SPI外设，例如第二块面板接在spi1上：
+//   st73xx::SpiTransport bus1(spi1, 8, 9, 13, 10, 11);
+//   st7306::ST7306Driver panel2(bus1);
+//
+// 多块面板也可以共用同一个SPI（SCK/MOSI/DC共用，CS各自独立）：
+// 同一SPI上的所有传输共享一份总线状态，SPI只初始化一次，
+// 写入前会先等待其他面板尚未结束的异步传输，busy() 反映整条总线的占用情况。
+class SpiTransport : public Transport {
+public:
+    SpiTransport(spi_inst_t* spi, uint dc_pin, uint res_pin, uint cs_pin, uint sclk_pin, uint sdin_pin,
+                 uint32_t baudrate = 40000000);
+    ~SpiTransport() override;
+
+    bool begin() override;
+    void write(const CommandBatch& batch, const uint8_t* payload = nullptr, size_t len = 0) override;
+    bool beginWrite(const CommandBatch& batch, size_t payload_len) override;
+    void writeChunk(const uint8_t* data, size_t len) override;
+    void endWrite() override;
+    bool busy() const override;
+    void wait() override;
+    void setReset(bool level) override;
+    bool resetPinWasHigh() const override { return reset_was_high_; }
+    void delayMs(uint32_t ms) override;
+
+    spi_inst_t* spi() const { return spi_; }
+
+protected:
+    // 每个SPI外设一份的共享状态
+    struct BusState {
+        bool initialized = false;
+        volatile uint8_t writing = 0;          // 正在进行阻塞写（可能被中断打断）
+        SpiTransport* volatile owner = nullptr; // 最近一次占用总线的传输，可能仍有异步传输未结束
+    };
+
+    BusState& bus() const;
+    // 标记总线占用，并等待其他面板的异步传输结束
+    void acquireBus();
+    void releaseBus();
+
+    // CS已拉低时按段发送批次，返回最后的DC电平
+    bool writeRuns(const CommandBatch& batch);
+
+    // 异步传输钩子：是否仍在传输、结束传输并拉高CS
+    virtual bool transferPending() const { return false; }
+    virtual void finishTransfer() {}
+
+    spi_inst_t* const spi_;
+    const uint dc_pin_;
+    const uint res_pin_;
+    const uint cs_pin_;
+    const uint sclk_pin_;
+    const uint sdin_pin_;
+    const uint32_t baudrate_;
+    bool started_ = false;
+    bool reset_was_high_ = true;
+
+private:
+    static BusState bus_states_[2];
+};
+
+// DMA SPI传输
+// 命令和参数仍用阻塞写（字节很少），显存负载交给DMA；
+// writeAsync() 在负载开始传输后立即返回，CPU可以在此期间准备下一帧以外的工作。
+class DmaSpiTransport : public SpiTransport {
+public:
+    using SpiTransport::SpiTransport;
+    ~DmaSpiTransport() override;
+
+    bool begin() override;
+    void write(const CommandBatch& batch, const uint8_t* payload = nullptr, size_t len = 0) override;
+    bool writeAsync(const CommandBatch& batch, const uint8_t* payload = nullptr, size_t len = 0) override;
+    void writeChunk(const uint8_t* data, size_t len) override;
+    void endWrite() override;
+
+protected:
+    bool transferPending() const override;
+    void finishTransfer() override;
+
+private:
+    void startDma(const uint8_t* data, size_t len);
+
+    int dma_channel_ = -1;
+    volatile bool pending_ = false;  // DMA已启动但CS尚未拉高
+};
+
+} // namespace st73xx
@@ -0,0 +1,155 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include "st73xx_command_batch.hpp"
+
+namespace st73xx {
+
+// 标记流编码（与 st73xx_tagged_spi.pio 对应）
+// 本头文件不依赖Pico SDK，可在主机端编译，用于生成和校验发送给PIO状态机的字流。
+namespace tagged {
+
+constexpr uint32_t HEADER_DC  = 1u << 31;
+constexpr uint32_t HEADER_END = 1u << 30;
+constexpr uint32_t MAX_RUN_LENGTH = 0x10000; // 段长字段为16位（字节数-1）
+
+constexpr uint32_t runHeader(bool is_data, bool end, uint32_t count) {
+    return (is_data ? HEADER_DC : 0u) | (end ? HEADER_END : 0u) | ((count - 1) & 0xFFFFu);
+}
+
+constexpr uint32_t byteWord(uint8_t value) {
+    return static_cast<uint32_t>(value) << 24;
+}
+
+// 编码一个批次所需的字数；有负载时再加一个负载段头（负载字节由DMA直接从显存送出）
+inline size_t encodedWords(const CommandBatch& batch, bool has_payload) {
+    return batch.runCount() + batch.size() + (has_payload ? 1 : 0);
+}
+
+// 把批次编码为字流。有负载时以负载段头结尾，负载字节需紧随其后送入FIFO；
+// 否则最后一个命令/数据段带END标志。返回写入的字数，容量不足返回0。
+inline size_t encodeBatch(const CommandBatch& batch, size_t payload_len, uint32_t* out, size_t capacity) {
+    bool has_payload = payload_len > 0;
+    if (encodedWords(batch, has_payload) > capacity || payload_len > MAX_RUN_LENGTH) {
+        return 0;
+    }
+    if (batch.empty() && !has_payload) {
+        return 0;
+    }
+
+    size_t n = 0;
+    const uint8_t* bytes = batch.bytes();
+    for (size_t i = 0; i < batch.runCount(); i++) {
+        const CommandBatch::Run& run = batch.run(i);
+        bool last = !has_payload && (i + 1 == batch.runCount());
+        out[n++] = runHeader(run.is_data, last, run.length);
+        for (size_t b = 0; b < run.length; b++) {
+            out[n++] = byteWord(bytes[run.offset + b]);
+        }
+    }
+    if (has_payload) {
+        out[n++] = runHeader(true, true, static_cast<uint32_t>(payload_len));
+    }
+    return n;
+}
+
+// 主机端仿真：按PIO程序的语义解析字流，还原出总线上的 CS/DC/字节序列。
+// 回调签名：void(uint8_t byte, bool is_data, uint32_t transaction)
+// 每个字节发生在第 transaction 次CS拉低期间。
+class StreamEmulator {
+public:
+    StreamEmulator() = default;
+
+    template <typename OnByte>
+    void push(uint32_t word, OnByte&& on_byte) {
+        if (remaining_ == 0) {
+            // 段头
+            is_data_ = (word & HEADER_DC) != 0;
+            end_ = (word & HEADER_END) != 0;
+            remaining_ = (word & 0xFFFFu) + 1;
+            if (!in_transaction_) {
+                in_transaction_ = true;
+                cycles_ += 2;
+            } else {
+                cycles_ += 1;
+            }
+            cycles_ += 8; // DC分支与段头解析
+            return;
+        }
+
+        on_byte(static_cast<uint8_t>(word >> 24), is_data_, transactions_);
+        bytes_++;
+        cycles_ += 19; // pull + set + 8位*2周期 + 循环跳转
+        if (--remaining_ == 0) {
+            cycles_ += 2;
+            if (end_) {
+                in_transaction_ = false;
+                transactions_++;
+            }
+        }
+    }
+
+    bool idle() const { return !in_transaction_ && remaining_ == 0; }
+    uint32_t transactions() const { return transactions_; }
+    uint32_t bytes() const { return bytes_; }
+    uint64_t cycles() const { return cycles_; }   // 状态机周期数，用于估算总线效率
+
+    void reset() { *this = StreamEmulator(); }
+
+private:
+    bool is_data_ = false;
+    bool end_ = false;
+    bool in_transaction_ = false;
+    uint32_t remaining_ = 0;
+    uint32_t transactions_ = 0;
+    uint32_t bytes_ = 0;
+    uint64_t cycles_ = 0;
+};
+
+// 校验：编码后的字流经仿真还原，应与批次+负载逐字节一致且恰好构成一次事务
+inline bool verifyEncoding(const CommandBatch& batch, const uint8_t* payload, size_t payload_len,
+                           const uint32_t* words, size_t word_count) {
+    StreamEmulator emu;
+    size_t expect_index = 0;
+    size_t total = batch.size() + payload_len;
+    bool ok = true;
+
+    auto expected = [&](size_t i, uint8_t& value, bool& is_data) {
+        if (i < batch.size()) {
+            value = batch.bytes()[i];
+            is_data = true;
+            for (size_t r = 0; r < batch.runCount(); r++) {
+                const CommandBatch::Run& run = batch.run(r);
+                if (i >= run.offset && i < static_cast<size_t>(run.offset) + run.length) {
+                    is_data = run.is_data;
+                    break;
+                }
+            }
+        } else {
+            value = payload[i - batch.size()];
+            is_data = true;
+        }
+    };
+    auto check = [&](uint8_t value, bool is_data, uint32_t transaction) {
+        uint8_t want = 0;
+        bool want_dc = false;
+        if (expect_index >= total || transaction != 0) {
+            ok = false;
+            return;
+        }
+        expected(expect_index++, want, want_dc);
+        if (value != want || is_data != want_dc) ok = false;
+    };
+
+    for (size_t i = 0; i < word_count; i++) {
+        emu.push(words[i], check);
+    }
+    for (size_t i = 0; i < payload_len; i++) {
+        emu.push(byteWord(payload[i]), check);
+    }
+    return ok && expect_index == total && emu.idle() && emu.transactions() == 1;
+}
+
+} // namespace tagged
+} // namespace st73xx
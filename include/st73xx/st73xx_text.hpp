@@ -0,0 +1,81 @@
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+#include "st73xx_font.hpp"
+#include "st73xx_metrics.hpp"
+
+namespace st73xx {
+
+// 8x16点阵文本绘制，ST7305/ST7306 驱动共用
+// 驱动只负责选择显存与提供带旋转的逐点绘制，字形、笔位推进与宽度计算都在这里。
+namespace text {
+
+inline bool isPrintable(char c) {
+    return c >= 32 && c <= 126;
+}
+
+// 字符串宽度（像素），不可打印字符不占宽度
+inline uint16_t stringWidth(std::string_view str) {
+    uint16_t width = 0;
+    for (char c : str) {
+        if (isPrintable(c)) {
+            width += font::FONT_WIDTH;
+        }
+    }
+    return width;
+}
+
+// 绘制单个字符，fg/bg 表示字形前景/背景是否为黑
+// rotation 为0时逻辑坐标即物理坐标，整块写入字形；
+// 否则逐点调用 draw_pixel(x, y, bool black)，由驱动完成坐标旋转
+template <typename Framebuffer, typename DrawPixel>
+void drawChar(Framebuffer& fb, int rotation, uint16_t x, uint16_t y, char c, bool fg, bool bg,
+              DrawPixel&& draw_pixel) {
+    const uint8_t* rows = font::get_char_data(c);
+    if (!rows) return;
+    ST73XX_METRIC_GLYPH();
+
+    if (rotation == 0) {
+        ST73XX_METRIC_PIXELS(font::FONT_WIDTH * font::FONT_HEIGHT);  // 旋转时由逐点绘制计数
+        fb.drawGlyph(x, y, rows, font::FONT_WIDTH, font::FONT_HEIGHT,
+                     fg ? Framebuffer::MAX_LEVEL : 0, bg ? Framebuffer::MAX_LEVEL : 0);
+        return;
+    }
+    for (uint8_t row = 0; row < font::FONT_HEIGHT; row++) {
+        uint8_t bits = rows[row];
+        for (uint8_t col = 0; col < font::FONT_WIDTH; col++) {
+            bool pixel = (bits >> (7 - col)) & 0x01;
+            draw_pixel(x + col, y + row, pixel ? fg : bg);
+        }
+    }
+}
+
+// 绘制字符串：跳过不可打印字符，每个字符后笔位沿旋转方向前进一个字宽
+// draw_char(x, y, char) 绘制单个字符
+template <typename DrawChar>
+void drawString(int rotation, uint16_t x, uint16_t y, std::string_view str, DrawChar&& draw_char) {
+    for (char c : str) {
+        if (!isPrintable(c)) {
+            continue;
+        }
+        draw_char(x, y, c);
+        switch (rotation) {
+            case 1: // 90度，竖排，字头朝上
+                y += font::FONT_WIDTH;
+                break;
+            case 2: // 180度，横排反向
+                x -= font::FONT_WIDTH;
+                break;
+            case 3: // 270度，竖排反向
+                y -= font::FONT_WIDTH;
+                break;
+            default: // 正常横排
+                x += font::FONT_WIDTH;
+                break;
+        }
+    }
+}
+
+} // namespace text
+} // namespace st73xx
@@ -0,0 +1,162 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include "st73xx_config.hpp"
+#if ST73XX_TRACE
+#include "pico/stdlib.h"
+#include "hardware/sync.h"
+#endif
+
+namespace st73xx {
+
+// 事件编号：0 保留；内置事件之外的编号从 User 开始，用 traceUserEvent(n) 生成并用 Trace::nameEvent() 命名
+enum class TraceEvent : uint8_t {
+    Render = 1,       // 应用标记的一帧绘制
+    Flush = 2,        // 驱动 display()/displayAsync()/displayRows()
+    BusDma = 3,       // DMA发送显存：启动到观察到完成（wait 或下一次总线访问），是实际完成时刻的上界
+    InputSample = 4,  // 摇杆采样
+    NetPoll = 5,      // 网络轮询（帧缓冲服务器、SNTP、stdio 帧接收）
+    User = 32,
+};
+
+constexpr uint8_t TRACE_MAX_EVENTS = 64;
+
+constexpr TraceEvent traceUserEvent(uint8_t n) {
+    return static_cast<TraceEvent>(static_cast<uint8_t>(TraceEvent::User) + n);
+}
+
+enum class TracePhase : uint8_t {
+    Begin = 0,
+    End = 1,
+    Instant = 2,  // arg 为附带的参数
+    Counter = 3,  // arg 为计数器的当前值
+};
+
+// 一条记录8字节：32位微秒时间戳（time_us_32，约71分钟回绕，解码时以导出时刻展开）
+struct TraceRecord {
+    uint32_t timestamp_us;
+    uint8_t event;
+    uint8_t phase;
+    uint16_t arg;
+};
+
+// ---- 导出格式（小端），由 Trace::dump() 写出、tools/trace_decode.cpp 解析 ----
+// 文件头 TRACE_DUMP_HEADER_LENGTH 字节：
+//   0  magic "S73T"
+//   4  version (1)
+//   5  cores
+//   6  name_count
+//   7  保留
+//   8  capacity   每核环形缓冲的记录数
+//   12 now_us     导出时刻的 time_us_64，用于展开32位时间戳
+// 事件名表 name_count 项：id(1) len(1) 名字(len字节，不含结尾0)
+// 每个核：count(4) dropped(4)（被覆盖的旧记录数），随后 count 条记录，从旧到新
+//   记录：timestamp_us(4) event(1) phase(1) arg(2)
+constexpr uint8_t TRACE_DUMP_MAGIC[4] = {'S', '7', '3', 'T'};
+constexpr uint8_t TRACE_DUMP_VERSION = 1;
+constexpr size_t TRACE_DUMP_HEADER_LENGTH = 20;
+constexpr size_t TRACE_RECORD_LENGTH = 8;
+
+#if ST73XX_TRACE
+
+static_assert((ST73XX_TRACE_CAPACITY & (ST73XX_TRACE_CAPACITY - 1)) == 0, "ST73XX_TRACE_CAPACITY must be a power of two");
+
+// 二进制事件追踪
+// 每个核一个环形缓冲，写满后覆盖最旧的记录。记录只写本核的缓冲，两个核之间不加锁；
+// 同一核上与中断之间的竞争靠短暂关中断（取时间戳、占槽、写8字节）解决，不调用 printf，
+// 热路径上的开销是几十个周期。dump() 暂停记录后把两个核的缓冲以二进制写到 stdio，
+// 由主机端 tools/trace_decode.cpp 转成 Chrome trace / Perfetto 可读的 JSON。
+class Trace {
+public:
+    static constexpr bool ENABLED = true;
+    static constexpr uint8_t CORES = 2;
+    static constexpr uint32_t CAPACITY = ST73XX_TRACE_CAPACITY;
+
+    static void record(TraceEvent event, TracePhase phase, uint16_t arg = 0) {
+        if (!recording_) return;
+        Ring& ring = rings_[get_core_num()];
+        const uint32_t save = save_and_disable_interrupts();
+        TraceRecord& r = ring.records[ring.head & (CAPACITY - 1)];
+        r.timestamp_us = time_us_32();
+        r.event = static_cast<uint8_t>(event);
+        r.phase = static_cast<uint8_t>(phase);
+        r.arg = arg;
+        ring.head++;
+        restore_interrupts(save);
+    }
+
+    static void begin(TraceEvent event, uint16_t arg = 0) { record(event, TracePhase::Begin, arg); }
+    static void end(TraceEvent event, uint16_t arg = 0) { record(event, TracePhase::End, arg); }
+    static void instant(TraceEvent event, uint16_t arg = 0) { record(event, TracePhase::Instant, arg); }
+    static void counter(TraceEvent event, uint16_t value) { record(event, TracePhase::Counter, value); }
+
+    // 为自定义事件命名（名字须为静态字符串）；内置事件已命名
+    static void nameEvent(TraceEvent event, const char* name);
+
+    static void setRecording(bool on) { recording_ = on; }
+    static bool recording() { return recording_; }
+    static void clear();
+
+    // 以二进制写出全部记录（putchar_raw，不做换行转换）；clear 为真时写完后清空缓冲
+    static void dump(bool clear = true);
+
+    // 作用域事件：构造时 Begin，析构时 End
+    class Scope {
+    public:
+        explicit Scope(TraceEvent event, uint16_t arg = 0) : event_(event) { begin(event, arg); }
+        ~Scope() { end(event_); }
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        TraceEvent event_;
+    };
+
+private:
+    struct Ring {
+        TraceRecord records[CAPACITY];
+        uint32_t head;  // 累计写入条数，取模得到下一个槽
+    };
+
+    static Ring rings_[CORES];
+    static const char* names_[TRACE_MAX_EVENTS];
+    static volatile bool recording_;
+};
+
+// event 为 TraceEvent 表达式，例如 ST73XX_TRACE_SCOPE(st73xx::TraceEvent::Flush)
+#define ST73XX_TRACE_BEGIN(event) ::st73xx::Trace::begin(event)
+#define ST73XX_TRACE_END(event) ::st73xx::Trace::end(event)
+#define ST73XX_TRACE_INSTANT(event, arg) ::st73xx::Trace::instant(event, static_cast<uint16_t>(arg))
+#define ST73XX_TRACE_COUNTER(event, value) ::st73xx::Trace::counter(event, static_cast<uint16_t>(value))
+#define ST73XX_TRACE_SCOPE(event) ::st73xx::Trace::Scope st73xx_trace_scope_(event)
+#define ST73XX_TRACE_SCOPE_ARG(event, arg) ::st73xx::Trace::Scope st73xx_trace_scope_(event, static_cast<uint16_t>(arg))
+
+#else
+
+// 关闭时的空实现：接口保持可用，宏不求值参数
+class Trace {
+public:
+    static constexpr bool ENABLED = false;
+
+    static void begin(TraceEvent, uint16_t = 0) {}
+    static void end(TraceEvent, uint16_t = 0) {}
+    static void instant(TraceEvent, uint16_t = 0) {}
+    static void counter(TraceEvent, uint16_t) {}
+    static void nameEvent(TraceEvent, const char*) {}
+    static void setRecording(bool) {}
+    static bool recording() { return false; }
+    static void clear() {}
+    static void dump(bool = true) {}
+};
+
+#define ST73XX_TRACE_BEGIN(event) ((void)0)
+#define ST73XX_TRACE_END(event) ((void)0)
+#define ST73XX_TRACE_INSTANT(event, arg) ((void)0)
+#define ST73XX_TRACE_COUNTER(event, value) ((void)0)
+#define ST73XX_TRACE_SCOPE(event) ((void)0)
+#define ST73XX_TRACE_SCOPE_ARG(event, arg) ((void)0)
+
+#endif
+
+} // namespace st73xx
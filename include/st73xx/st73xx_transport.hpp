@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include "st73xx_command_batch.hpp"
+
+namespace st73xx {
+
+// 显示总线传输接口
+// 驱动只通过该接口访问总线：命令批次（+可选显存负载）、复位脚和面板时序延时。
+// 本头文件不依赖Pico SDK，主机端的记录传输（st73xx_recording_transport.hpp）同样实现该接口。
+//
+// 实现：
+//   SpiTransport     阻塞SPI，可选spi0/spi1（st73xx_spi_transport.hpp）
+//   DmaSpiTransport  命令阻塞发送，显存负载由DMA发送（st73xx_spi_transport.hpp）
+//   PioTransport     PIO状态机驱动DC/CS，整次更新由DMA链完成（st73xx_pio_transport.hpp）
+//   RecordingTransport 主机端记录字节流并按总线模型计时（st73xx_recording_transport.hpp）
+class Transport {
+public:
+    virtual ~Transport() = default;
+
+    // 初始化总线与控制脚，可重复调用
+    virtual bool begin() = 0;
+
+    // 在一次CS拉低期间发送批次，负载以DC=1紧随其后；返回时CS已拉高
+    virtual void write(const CommandBatch& batch, const uint8_t* payload = nullptr, size_t len = 0) = 0;
+
+    // 启动传输后尽快返回；负载在 busy() 变为false之前必须保持不变
+    // 默认实现退化为阻塞发送
+    virtual bool writeAsync(const CommandBatch& batch, const uint8_t* payload = nullptr, size_t len = 0) {
+        write(batch, payload, len);
+        return true;
+    }
+
+    // 分块发送负载：beginWrite 发送批次并把DC切到数据，随后多次 writeChunk 送出共 payload_len 字节，
+    // 最后 endWrite 等待发送完成并拉高CS，整个过程只有一次CS拉低。
+    // writeChunk 可能在数据仍在传输时返回（DMA/PIO），下一次 writeChunk/endWrite 返回前
+    // 不得改写该块——两块缓冲区轮流使用即可（乒乓），CPU准备下一块时上一块在后台发送。
+    virtual bool beginWrite(const CommandBatch& batch, size_t payload_len) = 0;
+    virtual void writeChunk(const uint8_t* data, size_t len) = 0;
+    virtual void endWrite() = 0;
+
+    // 是否仍有异步传输在进行（中断上下文中可调用）
+    virtual bool busy() const { return false; }
+
+    // 等待异步传输结束并释放CS
+    virtual void wait() {}
+
+    // 复位脚电平
+    virtual void setReset(bool level) = 0;
+
+    // begin() 接管复位脚之前读到的电平。低电平说明复位脚没有外部上拉，MCU复位期间
+    // 面板已被复位，热启动不可用。无法读取的实现返回true。
+    virtual bool resetPinWasHigh() const { return true; }
+
+    // 面板时序要求的延时（复位、Sleep Out、清RAM等）
+    virtual void delayMs(uint32_t ms) = 0;
+};
+
+} // namespace st73xx
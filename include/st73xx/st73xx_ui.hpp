@@ -3,9 +3,16 @@
 
 #include "pico/stdlib.h"
 #include <cstdint>
+#include "st73xx_fixed_trig.hpp"
 
 #define value_interchange(a, b) do { (a) ^= (b); (b) ^= (a); (a) ^= (b); } while(0)
 
+// 多边形填充的边表容量（水平边和完全在裁剪区上下方的边不计入）
+// 边表在每个 ST73XX_UI 实例内，每条边24字节；超出容量时改走逐行求交点的回退路径，结果相同但较慢
+#ifndef ST73XX_UI_MAX_POLYGON_EDGES
+#define ST73XX_UI_MAX_POLYGON_EDGES 64
+#endif
+
 class ST73XX_UI {
 public:
     ST73XX_UI(int16_t w, int16_t h);
@@ -33,7 +40,13 @@ public:
     void drawTriangle(int16_t x0, int16_t y0, int16_t x1, int16_t y1, int16_t x2, int16_t y2, uint16_t color);
     void drawFilledTriangle(int16_t x0, int16_t y0, int16_t x1, int16_t y1, int16_t x2, int16_t y2, uint16_t color);
 
+    // 从圆心 (cx,cy) 沿 angle 方向、半径 r0 到 r1 的线段（刻度、指针）；角度为定点单位，见 st73xx_fixed_trig.hpp
+    void drawRadialLine(int16_t cx, int16_t cy, int16_t r0, int16_t r1, st73xx::Angle angle, uint16_t color);
+
     void drawPolygon(const int16_t *x, const int16_t *y, uint8_t sides, uint16_t color); // Adjusted for common polygon passing
+    // 奇偶规则扫描线填充（活动边表，16.16定点增量步进）
+    // 边数超过 ST73XX_UI_MAX_POLYGON_EDGES 时每条扫描线重新遍历全部边，仍完整绘制
+    // 工作区属于实例：不同实例可在两个核上同时使用，同一实例不可在中断中重入
     void drawFilledPolygon(const int16_t *x, const int16_t *y, uint8_t sides, uint16_t color); // Adjusted
 
     void fillScreen(uint16_t color);
@@ -42,9 +55,23 @@ public:
     void drawChar(int16_t x, int16_t y, unsigned char c, uint16_t color, uint16_t bg, uint8_t size_x, uint8_t size_y);
     // (setCursor, setTextSize, setTextColor etc. would go here if implementing full Adafruit_GFX text)
 
-    void setRotation(uint8_t r);
+    void setRotation(uint8_t r);  // 同时重置裁剪栈和原点
     uint8_t getRotation(void) const;
 
+    // 裁剪与视口（逻辑坐标，即旋转后的坐标）
+    // 所有图元先按当前裁剪矩形做几何裁剪（直线用Cohen-Sutherland，填充按span/矩形求交），
+    // 被裁掉的部分不会光栅化；压栈时新矩形与当前裁剪区求交，出栈恢复上一层的裁剪区和原点。
+    static constexpr uint8_t CLIP_STACK_DEPTH = 8;
+    bool pushClipRect(int16_t x, int16_t y, int16_t w, int16_t h);   // 坐标相对当前原点；栈满返回false
+    bool pushViewport(int16_t x, int16_t y, int16_t w, int16_t h);   // 裁剪到子区域并把原点移到其左上角
+    void popClip();
+    void resetClip();                                                 // 清空裁剪栈，裁剪区恢复为整屏，原点归零
+    void setOrigin(int16_t x, int16_t y);                             // 屏幕坐标下的原点
+    int16_t originX() const;
+    int16_t originY() const;
+    void getClipRect(int16_t& x, int16_t& y, int16_t& w, int16_t& h) const; // 相对当前原点
+    bool isClippedOut(int16_t x, int16_t y, int16_t w, int16_t h) const;   // 矩形完全不可见
+
     // Getter for display dimensions
     int16_t width() const;
     int16_t height() const;
@@ -54,9 +81,54 @@ public:
     int16_t HEIGHT; ///< Display height as modified by current rotation
 
 protected:
+    // 物理坐标矩形填充，区域已裁剪到屏幕内；默认逐点调用 writePoint，子类可换成显存的整字节填充
+    virtual void writeRect(uint x, uint y, uint w, uint h, uint16_t color);
+
+    // 逻辑坐标（相对原点）-> 物理坐标，点在裁剪区外时返回false
+    bool mapPoint(int16_t x, int16_t y, int16_t& tx, int16_t& ty) const;
+
     int16_t _width;  // Physical display width
     int16_t _height; // Physical display height
     uint8_t rotation_;
+
+private:
+    // 裁剪状态：[x0,x1) x [y0,y1) 为屏幕逻辑坐标，始终包含在屏幕内
+    struct ClipState {
+        int16_t x0, y0, x1, y1;
+        int16_t origin_x, origin_y;
+    };
+
+    ClipState clip_;
+    ClipState clip_stack_[CLIP_STACK_DEPTH];
+    uint8_t clip_depth_ = 0;
+
+    // 以下坐标都是屏幕逻辑坐标（已加原点）
+    void toPhysical(int32_t x, int32_t y, int16_t& tx, int16_t& ty) const;
+    void plotClipped(int32_t x, int32_t y, uint16_t color);              // 调用者保证点在裁剪区内
+    void fillClipped(int32_t x0, int32_t y0, int32_t x1, int32_t y1, uint16_t color); // [x0,x1) x [y0,y1)
+    bool clipLine(int32_t& x0, int32_t& y0, int32_t& x1, int32_t& y1) const;
+    uint8_t outCode(int32_t x, int32_t y) const;
+
+    // 多边形边：扫描线 y 覆盖 [y_top, y_end)。x 用64位保存：int16 顶点加原点后可超出 ±32767，
+    // 换成16.16定点会溢出32位
+    struct PolygonEdge {
+        int64_t x;      // 当前扫描线上的交点，16.16定点（已加0.5用于取整）
+        int64_t dxdy;   // 每条扫描线x的增量，16.16定点
+        int32_t y_top;
+        int32_t y_end;
+    };
+
+    // 多边形填充工作区：活动边表，或回退路径每条扫描线的交点（sides 最多255条边）
+    union PolygonScratch {
+        struct {
+            PolygonEdge edges[ST73XX_UI_MAX_POLYGON_EDGES];
+            uint8_t active[ST73XX_UI_MAX_POLYGON_EDGES];
+        } table;
+        int32_t crossings[255];
+    };
+    PolygonScratch polygon_;
+
+    void fillPolygonScanlines(const int16_t *vx, const int16_t *vy, uint8_t sides, uint16_t color);
     // GFXFont *gfxFont;
 };
 
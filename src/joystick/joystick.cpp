@@ -1,11 +1,15 @@
 
 #include "joystick.hpp"
 #include "hardware/i2c.h"
+#include "hardware/irq.h"
+#include "hardware/sync.h"
 #include "pico/stdlib.h"
 #include <cstring> // For memcpy
+#include "st73xx_trace.hpp"
 
 // Helper function for reading bytes from a specific register
 static inline int reg_read(i2c_inst_t *i2c, uint8_t addr, uint8_t reg, uint8_t *buf, uint8_t nbytes) {
+    ST73XX_TRACE_SCOPE_ARG(st73xx::TraceEvent::InputSample, reg);
     // Send the register address we want to read from
     int ret = i2c_write_blocking(i2c, addr, &reg, 1, true); // true to keep control of bus
     if (ret < 0) {
@@ -28,6 +32,28 @@ static inline int reg_write(i2c_inst_t *i2c, uint8_t addr, uint8_t reg, const ui
     return ret;
 }
 
+// Background joystick per I2C port, for the interrupt handlers
+static Joystick *s_background[2] = {nullptr, nullptr};
+
+// A transaction that has not completed after this long is abandoned (a 100 kHz sample takes ~1.2 ms)
+static const uint32_t SAMPLE_TIMEOUT_US = 10000;
+
+int Joystick::read_reg(uint8_t reg, uint8_t *buf, uint8_t nbytes)
+{
+    pause_background();
+    int ret = reg_read(_i2c_port, _addr, reg, buf, nbytes);
+    resume_background();
+    return ret;
+}
+
+int Joystick::write_reg(uint8_t reg, const uint8_t *buf, uint8_t nbytes)
+{
+    pause_background();
+    int ret = reg_write(_i2c_port, _addr, reg, buf, nbytes);
+    resume_background();
+    return ret;
+}
+
 bool Joystick::begin(i2c_inst_t *i2c_port, uint8_t addr, uint sda_pin, uint scl_pin, uint32_t speed)
 {
     _i2c_port = i2c_port;
@@ -63,14 +89,14 @@ uint16_t Joystick::get_joy_adc_value_x(adc_mode_t adc_bits)
     if (adc_bits == ADC_16BIT_RESULT) {
         uint8_t reg = JOYSTICK_ADC_VALUE_12BITS_REG; // Reads X and Y together
         uint8_t temp_data[4];
-        ret = reg_read(_i2c_port, _addr, reg, temp_data, 4);
+        ret = read_reg(reg, temp_data, 4);
         if (ret == 4) {
              memcpy(&value, &temp_data[0], 2); // Extract X value
         }
     } else if (adc_bits == ADC_8BIT_RESULT) {
         uint8_t reg = JOYSTICK_ADC_VALUE_8BITS_REG; // Reads X and Y together
         uint8_t temp_data[2];
-        ret = reg_read(_i2c_port, _addr, reg, temp_data, 2);
+        ret = read_reg(reg, temp_data, 2);
         if (ret == 2) {
             value = temp_data[0]; // Extract X value
         }
@@ -82,7 +108,7 @@ void Joystick::get_joy_adc_16bits_value_xy(uint16_t *adc_x, uint16_t *adc_y)
 {
     uint8_t data[4];
     uint8_t reg = JOYSTICK_ADC_VALUE_12BITS_REG;
-    int ret = reg_read(_i2c_port, _addr, reg, data, 4);
+    int ret = read_reg(reg, data, 4);
     if (ret == 4) {
         memcpy(adc_x, &data[0], 2);
         memcpy(adc_y, &data[2], 2);
@@ -96,7 +122,7 @@ void Joystick::get_joy_adc_8bits_value_xy(uint8_t *adc_x, uint8_t *adc_y)
 {
     uint8_t data[2];
     uint8_t reg = JOYSTICK_ADC_VALUE_8BITS_REG;
-    int ret = reg_read(_i2c_port, _addr, reg, data, 2);
+    int ret = read_reg(reg, data, 2);
      if (ret == 2) {
         *adc_x = data[0];
         *adc_y = data[1];
@@ -115,14 +141,14 @@ uint16_t Joystick::get_joy_adc_value_y(adc_mode_t adc_bits)
     if (adc_bits == ADC_16BIT_RESULT) {
         uint8_t reg = JOYSTICK_ADC_VALUE_12BITS_REG; // Reads X and Y together
         uint8_t temp_data[4];
-        ret = reg_read(_i2c_port, _addr, reg, temp_data, 4);
+        ret = read_reg(reg, temp_data, 4);
         if (ret == 4) {
              memcpy(&value, &temp_data[2], 2); // Extract Y value
         }
     } else if (adc_bits == ADC_8BIT_RESULT) {
         uint8_t reg = JOYSTICK_ADC_VALUE_8BITS_REG; // Reads X and Y together
         uint8_t temp_data[2];
-        ret = reg_read(_i2c_port, _addr, reg, temp_data, 2);
+        ret = read_reg(reg, temp_data, 2);
         if (ret == 2) {
             value = temp_data[1]; // Extract Y value
         }
@@ -134,7 +160,7 @@ int16_t Joystick::get_joy_adc_12bits_offset_value_x(void)
 {
     int16_t value = 0;
     uint8_t reg = JOYSTICK_OFFSET_ADC_VALUE_12BITS_REG;
-    reg_read(_i2c_port, _addr, reg, (uint8_t *)&value, 2);
+    read_reg(reg, (uint8_t *)&value, 2);
     return value;
 }
 
@@ -142,7 +168,7 @@ int16_t Joystick::get_joy_adc_12bits_offset_value_y(void)
 {
     int16_t value = 0;
     uint8_t reg = JOYSTICK_OFFSET_ADC_VALUE_12BITS_REG + 2;
-    reg_read(_i2c_port, _addr, reg, (uint8_t *)&value, 2);
+    read_reg(reg, (uint8_t *)&value, 2);
     return value;
 }
 
@@ -150,7 +176,7 @@ int8_t Joystick::get_joy_adc_8bits_offset_value_x(void)
 {
     int8_t value = 0;
     uint8_t reg = JOYSTICK_OFFSET_ADC_VALUE_8BITS_REG;
-    reg_read(_i2c_port, _addr, reg, (uint8_t *)&value, 1);
+    read_reg(reg, (uint8_t *)&value, 1);
     return value;
 }
 
@@ -158,7 +184,7 @@ int8_t Joystick::get_joy_adc_8bits_offset_value_y(void)
 {
     int8_t value = 0;
     uint8_t reg = JOYSTICK_OFFSET_ADC_VALUE_8BITS_REG + 1;
-    reg_read(_i2c_port, _addr, reg, (uint8_t *)&value, 1);
+    read_reg(reg, (uint8_t *)&value, 1);
     return value;
 }
 
@@ -176,7 +202,7 @@ void Joystick::set_joy_adc_value_cal(uint16_t x_neg_min, uint16_t x_neg_max, uin
     memcpy(&data[12], (uint8_t *)&y_pos_min, 2);
     memcpy(&data[14], (uint8_t *)&y_pos_max, 2);
 
-    reg_write(_i2c_port, _addr, JOYSTICK_ADC_VALUE_CAL_REG, data, 16);
+    write_reg(JOYSTICK_ADC_VALUE_CAL_REG, data, 16);
 }
 
 void Joystick::get_joy_adc_value_cal(uint16_t *x_neg_min, uint16_t *x_neg_max, uint16_t *x_pos_min,
@@ -184,7 +210,7 @@ void Joystick::get_joy_adc_value_cal(uint16_t *x_neg_min, uint16_t *x_neg_max, u
                                  uint16_t *y_pos_min, uint16_t *y_pos_max)
 {
     uint8_t data[16];
-    int ret = reg_read(_i2c_port, _addr, JOYSTICK_ADC_VALUE_CAL_REG, data, 16);
+    int ret = read_reg(JOYSTICK_ADC_VALUE_CAL_REG, data, 16);
     if (ret == 16) {
         memcpy((uint8_t *)x_neg_min, &data[0], 2);
         memcpy((uint8_t *)x_neg_max, &data[2], 2);
@@ -204,50 +230,277 @@ uint8_t Joystick::get_button_value(void)
 {
     uint8_t data = 1; // Default to not pressed
     uint8_t reg = JOYSTICK_BUTTON_REG;
-    reg_read(_i2c_port, _addr, reg, &data, 1);
+    read_reg(reg, &data, 1);
     return data;
 }
 
 void Joystick::set_rgb_color(uint32_t color)
 {
     // Color is sent as R, G, B, Brightness (4 bytes)
-    reg_write(_i2c_port, _addr, JOYSTICK_RGB_REG, (uint8_t *)&color, 4);
+    write_reg(JOYSTICK_RGB_REG, (uint8_t *)&color, 4);
 }
 
 uint32_t Joystick::get_rgb_color(void)
 {
     uint32_t rgb_read_buff = 0;
-    reg_read(_i2c_port, _addr, JOYSTICK_RGB_REG, (uint8_t *)&rgb_read_buff, 4);
+    read_reg(JOYSTICK_RGB_REG, (uint8_t *)&rgb_read_buff, 4);
     return rgb_read_buff;
 }
 
 uint8_t Joystick::get_firmware_version(void)
 {
     uint8_t reg_value = 0;
-    reg_read(_i2c_port, _addr, JOYSTICK_FIRMWARE_VERSION_REG, &reg_value, 1);
+    read_reg(JOYSTICK_FIRMWARE_VERSION_REG, &reg_value, 1);
     return reg_value;
 }
 
 uint8_t Joystick::get_bootloader_version(void)
 {
     uint8_t reg_value = 0;
-    reg_read(_i2c_port, _addr, JOYSTICK_BOOTLOADER_VERSION_REG, &reg_value, 1);
+    read_reg(JOYSTICK_BOOTLOADER_VERSION_REG, &reg_value, 1);
     return reg_value;
 }
 
 uint8_t Joystick::get_i2c_address(void)
 {
     uint8_t reg_value = 0;
-    reg_read(_i2c_port, _addr, JOYSTICK_I2C_ADDRESS_REG, &reg_value, 1);
+    read_reg(JOYSTICK_I2C_ADDRESS_REG, &reg_value, 1);
     return reg_value;
 }
 
 uint8_t Joystick::set_i2c_address(uint8_t new_addr)
 {
-    int ret = reg_write(_i2c_port, _addr, JOYSTICK_I2C_ADDRESS_REG, &new_addr, 1);
+    int ret = write_reg(JOYSTICK_I2C_ADDRESS_REG, &new_addr, 1);
     if (ret > 0) {
         _addr = new_addr;
         return 1;
     }
     return 0;
-} 
\ No newline at end of file
+} 
+// Queue both transactions into the TX FIFO (7 of 16 entries); the controller runs them back to back:
+//   S addr+W 0x50 Sr addr+R x_lo x_hi y_lo y_hi P   S addr+W 0x20 Sr addr+R button P
+void Joystick::queue_sample(void)
+{
+    i2c_hw_t *hw = i2c_get_hw(_i2c_port);
+    disable_controller();
+    hw->tar = _addr;
+    hw->enable = 1;
+
+    const uint32_t read = I2C_IC_DATA_CMD_CMD_BITS;
+    hw->data_cmd = JOYSTICK_OFFSET_ADC_VALUE_12BITS_REG;
+    hw->data_cmd = read | I2C_IC_DATA_CMD_RESTART_BITS;
+    hw->data_cmd = read;
+    hw->data_cmd = read;
+    hw->data_cmd = read | I2C_IC_DATA_CMD_STOP_BITS;
+    hw->data_cmd = JOYSTICK_BUTTON_REG;
+    hw->data_cmd = read | I2C_IC_DATA_CMD_RESTART_BITS | I2C_IC_DATA_CMD_STOP_BITS;
+    _bg_queued_us = time_us_32();
+}
+
+// Collect the queued reading once all bytes have arrived
+bool Joystick::finish_sample(joystick_sample_t *sample)
+{
+    i2c_hw_t *hw = i2c_get_hw(_i2c_port);
+    if (hw->rxflr < SAMPLE_RX_BYTES) return false;
+    uint8_t data[SAMPLE_RX_BYTES];
+    for (uint8_t i = 0; i < SAMPLE_RX_BYTES; i++) {
+        data[i] = (uint8_t)hw->data_cmd;
+    }
+    sample->x = (int16_t)(data[0] | (data[1] << 8));
+    sample->y = (int16_t)(data[2] | (data[3] << 8));
+    sample->button = data[4];
+    sample->time_us = time_us_32();
+    return true;
+}
+
+// Abandon the queued transactions: clear an abort (which also releases the flushed TX FIFO)
+// and drop any received bytes
+void Joystick::reset_transfer(void)
+{
+    i2c_hw_t *hw = i2c_get_hw(_i2c_port);
+    (void)hw->clr_tx_abrt;
+    disable_controller();  // disabling flushes both FIFOs
+    hw->enable = 1;
+}
+
+// IC_ENABLE only requests the disable: IC_TAR and the FIFOs may be touched (and the controller
+// re-enabled) only once IC_ENABLE_STATUS.IC_EN reads 0, which takes a few ic_clk cycles when
+// the bus is idle and until the transfer in progress stops otherwise
+void Joystick::disable_controller(void)
+{
+    i2c_hw_t *hw = i2c_get_hw(_i2c_port);
+    hw->enable = 0;
+    while (hw->enable_status & I2C_IC_ENABLE_STATUS_IC_EN_BITS) {
+        tight_loop_contents();
+    }
+}
+
+bool Joystick::sample(joystick_sample_t *sample)
+{
+    if (_bg_active) {
+        uint32_t seq;
+        do {
+            seq = _bg_seq;
+            if (seq == 0) return false;
+            *sample = _bg_buffer[seq & 1];
+            __dmb();
+        } while (seq != _bg_seq);
+        return true;
+    }
+
+    ST73XX_TRACE_SCOPE(st73xx::TraceEvent::InputSample);
+    queue_sample();
+    i2c_hw_t *hw = i2c_get_hw(_i2c_port);
+    while (!finish_sample(sample)) {
+        if ((hw->raw_intr_stat & I2C_IC_RAW_INTR_STAT_TX_ABRT_BITS) ||
+            time_us_32() - _bg_queued_us > SAMPLE_TIMEOUT_US) {
+            reset_transfer();
+            return false;
+        }
+        tight_loop_contents();
+    }
+    return true;
+}
+
+// Called from the I2C interrupt (or with the interrupt masked, while pausing)
+void Joystick::service_background(void)
+{
+    if (!_bg_busy) return;
+    i2c_hw_t *hw = i2c_get_hw(_i2c_port);
+    if (hw->raw_intr_stat & I2C_IC_RAW_INTR_STAT_TX_ABRT_BITS) {
+        reset_transfer();
+        _bg_errors = _bg_errors + 1;
+        _bg_busy = false;
+        return;
+    }
+    const uint32_t seq = _bg_seq + 1;
+    if (!finish_sample(&_bg_buffer[seq & 1])) return;
+    __dmb();
+    _bg_seq = seq;
+    _bg_busy = false;
+    ST73XX_TRACE_INSTANT(st73xx::TraceEvent::InputSample, time_us_32() - _bg_queued_us);
+}
+
+void Joystick::i2c0_irq_handler(void)
+{
+    Joystick *joystick = s_background[0];
+    if (joystick && !joystick->_bg_paused) joystick->service_background();
+}
+
+void Joystick::i2c1_irq_handler(void)
+{
+    Joystick *joystick = s_background[1];
+    if (joystick && !joystick->_bg_paused) joystick->service_background();
+}
+
+bool Joystick::background_timer_callback(struct repeating_timer *t)
+{
+    Joystick *joystick = (Joystick *)t->user_data;
+    if (joystick->_bg_paused) return true;
+    if (joystick->_bg_busy) {
+        // Lost interrupt or stuck bus: give up on this reading, queue again next period
+        if (time_us_32() - joystick->_bg_queued_us > SAMPLE_TIMEOUT_US) {
+            joystick->reset_transfer();
+            joystick->_bg_errors = joystick->_bg_errors + 1;
+            joystick->_bg_busy = false;
+        }
+        return true;
+    }
+    joystick->_bg_busy = true;
+    joystick->queue_sample();
+    return true;
+}
+
+bool Joystick::start_background(uint32_t period_ms)
+{
+    const uint index = i2c_hw_index(_i2c_port);
+    if (_bg_active) return true;
+    if (s_background[index] || period_ms == 0) return false;
+
+    _bg_seq = 0;
+    _bg_errors = 0;
+    _bg_busy = false;
+    _bg_paused = false;
+    s_background[index] = this;
+
+    i2c_hw_t *hw = i2c_get_hw(_i2c_port);
+    const uint irq = index == 0 ? I2C0_IRQ : I2C1_IRQ;
+    irq_set_exclusive_handler(irq, index == 0 ? i2c0_irq_handler : i2c1_irq_handler);
+    hw->rx_tl = SAMPLE_RX_BYTES - 1;  // RX_FULL once the whole reading is in the FIFO
+    hw->intr_mask = I2C_IC_INTR_MASK_M_RX_FULL_BITS | I2C_IC_INTR_MASK_M_TX_ABRT_BITS;
+    irq_set_enabled(irq, true);
+
+    // The timer and the I2C interrupt both drive the controller, so they must run on the same core.
+    // The default alarm pool fires on the core that initialised it (normally core 0); on another
+    // core a pool is created on a spare hardware alarm
+    alarm_pool_t *pool = alarm_pool_get_default();
+    if (!pool || alarm_pool_core_num(pool) != get_core_num()) {
+        _bg_pool = alarm_pool_create_with_unused_hardware_alarm(1);
+        pool = _bg_pool;
+    }
+
+    // Negative period: measured from the start of one callback to the next
+    if (!pool || !alarm_pool_add_repeating_timer_ms(pool, -(int32_t)period_ms, background_timer_callback, this, &_bg_timer)) {
+        if (_bg_pool) {
+            alarm_pool_destroy(_bg_pool);
+            _bg_pool = nullptr;
+        }
+        hw->intr_mask = 0;
+        irq_set_enabled(irq, false);
+        irq_remove_handler(irq, index == 0 ? i2c0_irq_handler : i2c1_irq_handler);
+        s_background[index] = nullptr;
+        return false;
+    }
+    _bg_active = true;
+    return true;
+}
+
+void Joystick::stop_background(void)
+{
+    if (!_bg_active) return;
+    pause_background();
+    cancel_repeating_timer(&_bg_timer);
+    if (_bg_pool) {
+        alarm_pool_destroy(_bg_pool);
+        _bg_pool = nullptr;
+    }
+
+    const uint index = i2c_hw_index(_i2c_port);
+    const uint irq = index == 0 ? I2C0_IRQ : I2C1_IRQ;
+    irq_set_enabled(irq, false);
+    irq_remove_handler(irq, index == 0 ? i2c0_irq_handler : i2c1_irq_handler);
+    i2c_get_hw(_i2c_port)->rx_tl = 0;
+    s_background[index] = nullptr;
+    _bg_active = false;
+    _bg_paused = false;
+}
+
+// Mask the interrupt and finish (or abandon) the reading in flight, so that a blocking
+// SDK transfer owns the controller; the timer skips its period while paused
+void Joystick::pause_background(void)
+{
+    if (!_bg_active) return;
+    _bg_paused = true;
+    i2c_get_hw(_i2c_port)->intr_mask = 0;
+    while (_bg_busy) {
+        service_background();
+        if (_bg_busy && time_us_32() - _bg_queued_us > SAMPLE_TIMEOUT_US) {
+            reset_transfer();
+            _bg_errors = _bg_errors + 1;
+            _bg_busy = false;
+        }
+    }
+}
+
+void Joystick::resume_background(void)
+{
+    if (!_bg_active) return;
+    i2c_get_hw(_i2c_port)->intr_mask = I2C_IC_INTR_MASK_M_RX_FULL_BITS | I2C_IC_INTR_MASK_M_TX_ABRT_BITS;
+    _bg_paused = false;
+}
+
+void Joystick::get_background_stats(uint32_t *samples, uint32_t *errors) const
+{
+    *samples = _bg_seq;
+    *errors = _bg_errors;
+}
@@ -1,23 +1,23 @@
 #include "js16tmr_joystick/js16tmr_joystick_direct.hpp"
 #include "hardware/adc.h"
+#include "hardware/dma.h"
 #include "pico/stdlib.h"
 #include <stdio.h>
 #include <cstdlib>
+#include "st73xx_trace.hpp"
+
+static_assert((JS16TMR_JOYSTICK_RING_SAMPLES & (JS16TMR_JOYSTICK_RING_SAMPLES - 1)) == 0 &&
+              JS16TMR_JOYSTICK_RING_SAMPLES >= 2, "JS16TMR_JOYSTICK_RING_SAMPLES must be a power of two");
+
+// 重装通道写入数据通道的传输计数（带触发）；数据通道约12天（4kHz）才用完一次
+static const uint32_t s_dma_reload_count = 0xFFFFFFFFu;
 
 bool JS16TMRJoystickDirect::begin() {
     _calibrated = false;
-    _filter_index = 0;
-    _filter_initialized = false;
     _hysteresis_initialized = false;
     _last_stable_x = 0;
     _last_stable_y = 0;
     
-    // 初始化TMR高频滤波器缓冲区
-    for (int i = 0; i < 4; i++) {
-        _filter_x[i] = 0;
-        _filter_y[i] = 0;
-    }
-    
     // 初始化ADC
     adc_init();
     
@@ -35,17 +35,11 @@ bool JS16TMRJoystickDirect::begin() {
     gpio_set_dir(JS16TMR_JOYSTICK_LED_PIN, GPIO_OUT);
     gpio_put(JS16TMR_JOYSTICK_LED_PIN, 0);  // 初始状态关闭LED
     
-    // 等待ADC稳定
-    sleep_ms(100);
-    
-    // 预热ADC，丢弃前几次读数
-    for (int i = 0; i < 5; i++) {
-        adc_select_input(JS16TMR_JOYSTICK_ADC_X_CHANNEL);
-        adc_read();
-        adc_select_input(JS16TMR_JOYSTICK_ADC_Y_CHANNEL);
-        adc_read();
-        sleep_ms(10);
+    // 启动自由运行采样；等待ADC稳定期间环形缓冲区被新样本反复覆盖，不需要另外预热
+    if (!start_free_running()) {
+        printf("JS16TMR摇杆：没有空闲的DMA通道，使用阻塞读取\n");
     }
+    sleep_ms(100);
     
     printf("JS16TMR摇杆直接连接初始化成功\n");
     printf("X轴引脚: GP%d (ADC%d)\n", JS16TMR_JOYSTICK_PIN_X, JS16TMR_JOYSTICK_ADC_X_CHANNEL);
@@ -59,7 +53,66 @@ bool JS16TMRJoystickDirect::begin() {
     return true;
 }
 
+// ADC按 X、Y、X、Y… 轮转连续转换，数据通道把FIFO中的结果循环写入 _ring；
+// 计数用完时链到重装通道，重新装入计数并触发数据通道，写地址接着在缓冲区内回绕
+bool JS16TMRJoystickDirect::start_free_running(void) {
+    _dma_data = dma_claim_unused_channel(false);
+    _dma_reload = dma_claim_unused_channel(false);
+    if (_dma_data < 0 || _dma_reload < 0) {
+        if (_dma_data >= 0) dma_channel_unclaim(_dma_data);
+        if (_dma_reload >= 0) dma_channel_unclaim(_dma_reload);
+        _dma_data = -1;
+        _dma_reload = -1;
+        return false;
+    }
+    for (uint i = 0; i < JS16TMR_JOYSTICK_RING_SAMPLES; i++) {
+        _ring[i] = 0;
+    }
+
+    adc_run(false);
+    adc_fifo_drain();
+    adc_select_input(JS16TMR_JOYSTICK_ADC_X_CHANNEL);  // 第一个结果是X，之后交替
+    adc_set_round_robin((1u << JS16TMR_JOYSTICK_ADC_X_CHANNEL) | (1u << JS16TMR_JOYSTICK_ADC_Y_CHANNEL));
+    adc_fifo_setup(true, true, 1, false, false);  // 每个结果都请求DMA，保留12位
+    adc_set_clkdiv(48000000.0f / JS16TMR_JOYSTICK_SAMPLE_RATE_HZ - 1.0f);  // ADC时钟48MHz
+
+    dma_channel_config c = dma_channel_get_default_config(_dma_data);
+    channel_config_set_transfer_data_size(&c, DMA_SIZE_16);
+    channel_config_set_read_increment(&c, false);
+    channel_config_set_write_increment(&c, true);
+    channel_config_set_ring(&c, true, __builtin_ctz(sizeof(_ring)));
+    channel_config_set_dreq(&c, DREQ_ADC);
+    channel_config_set_chain_to(&c, _dma_reload);
+    dma_channel_configure(_dma_data, &c, _ring, &adc_hw->fifo, s_dma_reload_count, false);
+
+    dma_channel_config reload = dma_channel_get_default_config(_dma_reload);
+    channel_config_set_transfer_data_size(&reload, DMA_SIZE_32);
+    channel_config_set_read_increment(&reload, false);
+    channel_config_set_write_increment(&reload, false);
+    dma_channel_configure(_dma_reload, &reload, &dma_channel_hw_addr(_dma_data)->al1_transfer_count_trig,
+                          &s_dma_reload_count, 1, false);
+
+    dma_channel_start(_dma_data);
+    adc_run(true);
+    return true;
+}
+
+// 对该轴在环形缓冲区中的全部样本取平均（每轴 RING_SAMPLES/2 个）：
+// 不等待ADC，也不需要知道DMA写到了哪里，耗时固定
 uint16_t JS16TMRJoystickDirect::read_adc_channel(uint channel) {
+    if (_dma_data < 0) {
+        return read_adc_blocking(channel);
+    }
+    uint32_t sum = 0;
+    for (uint i = (channel == JS16TMR_JOYSTICK_ADC_X_CHANNEL) ? 0 : 1; i < JS16TMR_JOYSTICK_RING_SAMPLES; i += 2) {
+        sum += _ring[i] & 0x0FFF;
+    }
+    return sum / (JS16TMR_JOYSTICK_RING_SAMPLES / 2);
+}
+
+// 没有DMA通道时的阻塞读取
+uint16_t JS16TMRJoystickDirect::read_adc_blocking(uint channel) {
+    ST73XX_TRACE_SCOPE_ARG(st73xx::TraceEvent::InputSample, channel);
     // 选择ADC通道
     adc_select_input(channel);
     
@@ -76,10 +129,7 @@ uint16_t JS16TMRJoystickDirect::read_adc_channel(uint channel) {
 }
 
 uint16_t JS16TMRJoystickDirect::get_joy_adc_value_x(adc_mode_t adc_bits) {
-    uint16_t value = read_adc_channel(JS16TMR_JOYSTICK_ADC_X_CHANNEL);
-    
-    // 应用移动平均滤波
-    value = apply_filter(value, _filter_x);
+    uint16_t value = read_adc_channel(JS16TMR_JOYSTICK_ADC_X_CHANNEL);  // 已是最近样本的平均
     
     if (adc_bits == ADC_8BIT_RESULT) {
         value = value >> 4; // 转换为 8 位 (0-255)
@@ -88,10 +138,7 @@ uint16_t JS16TMRJoystickDirect::get_joy_adc_value_x(adc_mode_t adc_bits) {
 }
 
 uint16_t JS16TMRJoystickDirect::get_joy_adc_value_y(adc_mode_t adc_bits) {
-    uint16_t value = read_adc_channel(JS16TMR_JOYSTICK_ADC_Y_CHANNEL);
-    
-    // 应用移动平均滤波
-    value = apply_filter(value, _filter_y);
+    uint16_t value = read_adc_channel(JS16TMR_JOYSTICK_ADC_Y_CHANNEL);  // 已是最近样本的平均
     
     if (adc_bits == ADC_8BIT_RESULT) {
         value = value >> 4; // 转换为 8 位 (0-255)
@@ -205,25 +252,3 @@ void JS16TMRJoystickDirect::update_led_from_joystick() {
     // 根据摇杆状态控制LED
     set_led(joystick_active);
 }
-
-uint16_t JS16TMRJoystickDirect::apply_filter(uint16_t new_value, uint16_t* filter_buffer) {
-    // 更新滤波器缓冲区
-    filter_buffer[_filter_index] = new_value;
-    _filter_index = (_filter_index + 1) % 4;
-    
-    // 如果滤波器未初始化，用当前值填充所有缓冲区
-    if (!_filter_initialized) {
-        for (int i = 0; i < 4; i++) {
-            filter_buffer[i] = new_value;
-        }
-        _filter_initialized = true;
-    }
-    
-    // TMR高频优化：简单移动平均，减少计算延迟
-    uint32_t sum = 0;
-    for (int i = 0; i < 4; i++) {
-        sum += filter_buffer[i];
-    }
-    
-    return sum / 4;
-}
@@ -5,6 +5,7 @@
 
 #include "js16tmr_joystick/js16tmr_joystick_handler.hpp"
 #include "js16tmr_joystick/js16tmr_joystick_direct.hpp"
+#include "st73xx_fixed_trig.hpp"
 #include <cstdio>
 #include <string>
 #include <cmath>
@@ -89,19 +90,14 @@ JoystickDirection JS16TMRJoystickHandler::processDirection(int16_t x, int16_t y)
         }
     }
     
-    // 计算方向角度
-    float angle = atan2(y, x) * 180.0f / 3.14159f;
-    if (angle < 0) angle += 360.0f;
-    
-    // 确定主要方向
-    if (angle >= 315.0f || angle < 45.0f) {
-        return JoystickDirection::RIGHT;
-    } else if (angle >= 45.0f && angle < 135.0f) {
-        return JoystickDirection::DOWN;
-    } else if (angle >= 135.0f && angle < 225.0f) {
-        return JoystickDirection::LEFT;
-    } else {
-        return JoystickDirection::UP;
+    // 计算方向角度（定点角度，一圈65536，不走软浮点）
+    // 转过45°后取最高两位即为所在的90°扇区：0右 1下 2左 3上
+    st73xx::Angle angle = st73xx::atan2Angle(y, x);
+    switch (static_cast<st73xx::Angle>(angle + st73xx::ANGLE_QUARTER / 2) >> 14) {
+        case 0: return JoystickDirection::RIGHT;
+        case 1: return JoystickDirection::DOWN;
+        case 2: return JoystickDirection::LEFT;
+        default: return JoystickDirection::UP;
     }
 }
 
@@ -0,0 +1,128 @@
+#include "civil_time.hpp"
+
+namespace net {
+
+namespace {
+
+constexpr int64_t SECONDS_PER_DAY = 86400;
+
+constexpr int64_t floorDiv(int64_t a, int64_t b) {
+    return a >= 0 ? a / b : -((-a + b - 1) / b);
+}
+
+// 规则在 y 年对应的日期（自1970年的天数）
+int32_t ruleDay(const DstRule& rule, int32_t y) {
+    if (rule.week >= 5) {
+        int32_t last = daysFromCivil(y, rule.month, daysInMonth(y, rule.month));
+        return last - (weekdayFromDays(last) - rule.weekday + 7) % 7;
+    }
+    int32_t first = daysFromCivil(y, rule.month, 1);
+    return first + (rule.weekday - weekdayFromDays(first) + 7) % 7 + 7 * (rule.week - 1);
+}
+
+// 切换时刻（UTC秒）；offset_before 为切换前生效的本地偏移
+int64_t transitionUtc(const DstRule& rule, int32_t y, int32_t offset_before) {
+    return static_cast<int64_t>(ruleDay(rule, y)) * SECONDS_PER_DAY + rule.time_s - offset_before;
+}
+
+} // namespace
+
+CivilClock::CivilClock(const TimeZone& zone) :
+    zone_(&zone), unix_(0), next_transition_(INT64_MAX), offset_s_(0), local_{} {
+    set(0);
+}
+
+void CivilClock::setZone(const TimeZone& zone) {
+    zone_ = &zone;
+    set(unix_);
+}
+
+int32_t CivilClock::offsetAt(const TimeZone& zone, int64_t unix_seconds, bool* dst, int64_t* next_transition) {
+    if (zone.dst_delta_s == 0) {
+        if (dst) *dst = false;
+        if (next_transition) *next_transition = INT64_MAX;
+        return zone.std_offset_s;
+    }
+
+    // 前一年、当年、后一年的全部切换点按时间排列（南北半球都适用）
+    const int32_t year = civilFromDays(static_cast<int32_t>(
+        floorDiv(unix_seconds + zone.std_offset_s, SECONDS_PER_DAY))).year;
+    const int32_t dst_offset = zone.std_offset_s + zone.dst_delta_s;
+    int64_t times[6];
+    bool starts[6];
+    uint8_t n = 0;
+    for (int32_t y = year - 1; y <= year + 1; y++) {
+        int64_t start = transitionUtc(zone.dst_start, y, zone.std_offset_s);
+        int64_t end = transitionUtc(zone.dst_end, y, dst_offset);
+        bool start_first = start < end;
+        times[n] = start_first ? start : end;
+        starts[n++] = start_first;
+        times[n] = start_first ? end : start;
+        starts[n++] = !start_first;
+    }
+
+    bool in_dst = !starts[0];  // 第一个切换点之前的状态
+    int64_t next = INT64_MAX;
+    for (uint8_t i = 0; i < n; i++) {
+        if (times[i] <= unix_seconds) {
+            in_dst = starts[i];
+        } else {
+            next = times[i];
+            break;
+        }
+    }
+
+    if (dst) *dst = in_dst;
+    if (next_transition) *next_transition = next;
+    return in_dst ? dst_offset : zone.std_offset_s;
+}
+
+void CivilClock::set(int64_t unix_seconds) {
+    bool dst = false;
+    unix_ = unix_seconds;
+    offset_s_ = offsetAt(*zone_, unix_seconds, &dst, &next_transition_);
+
+    const int64_t local = unix_seconds + offset_s_;
+    const int64_t days = floorDiv(local, SECONDS_PER_DAY);
+    const int32_t secs = static_cast<int32_t>(local - days * SECONDS_PER_DAY);
+    const CivilDate date = civilFromDays(static_cast<int32_t>(days));
+
+    local_.year = date.year;
+    local_.month = date.month;
+    local_.day = date.day;
+    local_.hour = static_cast<uint8_t>(secs / 3600);
+    local_.minute = static_cast<uint8_t>(secs / 60 % 60);
+    local_.second = static_cast<uint8_t>(secs % 60);
+    local_.weekday = weekdayFromDays(static_cast<int32_t>(days));
+    local_.dst = dst;
+}
+
+void CivilClock::advanceTo(int64_t unix_seconds) {
+    int64_t step = unix_seconds - unix_;
+    if (step == 0) return;
+    if (step < 0 || step > MAX_INCREMENTAL_STEP_S || unix_seconds >= next_transition_) {
+        set(unix_seconds);
+        return;
+    }
+    while (step-- > 0) {
+        tickSecond();
+    }
+    unix_ = unix_seconds;
+}
+
+void CivilClock::tickSecond() {
+    if (++local_.second < 60) return;
+    local_.second = 0;
+    if (++local_.minute < 60) return;
+    local_.minute = 0;
+    if (++local_.hour < 24) return;
+    local_.hour = 0;
+    local_.weekday = static_cast<uint8_t>((local_.weekday + 1) % 7);
+    if (++local_.day <= daysInMonth(local_.year, local_.month)) return;
+    local_.day = 1;
+    if (++local_.month <= 12) return;
+    local_.month = 1;
+    local_.year++;
+}
+
+} // namespace net
@@ -0,0 +1,183 @@
+#include "fb_stream_capture.hpp"
+#include "pico/stdlib.h"
+#include <cstdio>
+#include <cstring>
+#if LIB_PICO_STDIO_USB
+#include "tusb.h"
+#endif
+
+namespace net {
+
+namespace {
+
+// 每次 poll() 最多读取的请求字节
+constexpr uint32_t REQUEST_READ_BUDGET = 64;
+
+} // namespace
+
+StdioFrameCapture::StdioFrameCapture(size_t max_message) :
+    max_message_(max_message < MAX_MESSAGE ? max_message : MAX_MESSAGE),
+    source_(),
+    frame_(nullptr),
+    phase_(Phase::Idle),
+    seq_(0),
+    band_rows_(0),
+    next_row_(0),
+    part_(0),
+    parts_(0),
+    message_len_(0),
+    listening_(false),
+    listen_source_(),
+    listen_snapshot_(nullptr),
+    request_fill_(0),
+    stats_()
+{
+}
+
+bool StdioFrameCapture::request(const CaptureSource& source, uint8_t* snapshot) {
+    if (busy() || source.buffer == nullptr || source.stride == 0 || source.rows == 0) return false;
+
+    // 行带取最坏情况（全是字面量）也放得进一条消息的最大行数，且不超过 parts 字段的255条
+    const size_t capacity = max_message_ - FB_STREAM_HEADER_LENGTH - FB_STREAM_DELTA_PREFIX_LENGTH;
+    uint16_t band = static_cast<uint16_t>((source.rows + 254) / 255);
+    if (fbRleWorstCase(static_cast<size_t>(band) * source.stride) > capacity) return false;
+    while (band < source.rows && fbRleWorstCase(static_cast<size_t>(band + 1) * source.stride) <= capacity) {
+        band++;
+    }
+
+    source_ = source;
+    frame_ = source.buffer;
+    if (snapshot) {
+        memcpy(snapshot, source.buffer, static_cast<size_t>(source.stride) * source.rows);
+        frame_ = snapshot;
+    }
+    band_rows_ = band;
+    parts_ = static_cast<uint8_t>((source.rows + band - 1) / band);
+    next_row_ = 0;
+    part_ = 0;
+    seq_++;
+    phase_ = Phase::Info;
+    prepareMessage();
+    return true;
+}
+
+void StdioFrameCapture::listen(const CaptureSource& source, uint8_t* snapshot) {
+    listening_ = true;
+    listen_source_ = source;
+    listen_snapshot_ = snapshot;
+}
+
+void StdioFrameCapture::poll(uint32_t byte_budget) {
+    if (listening_) {
+        pollRequests();
+    }
+
+    if (busy() && !hostConnected()) {
+        // 主机关闭了串口：放弃这次截屏，下次请求重新开始
+        phase_ = Phase::Idle;
+        message_len_ = 0;
+        return;
+    }
+
+    uint32_t written = 0;
+    while (message_len_ > 0 && written + message_len_ <= byte_budget) {
+        // 整条消息放得进发送缓冲区才写，消息不会与其他输出交错，也不会阻塞
+        if (writable() < message_len_) break;
+        // putchar_raw 不把 '\n' 展开成 "\r\n"
+        for (size_t i = 0; i < message_len_; i++) {
+            putchar_raw(message_[i]);
+        }
+        written += static_cast<uint32_t>(message_len_);
+        stats_.messages++;
+        stats_.wire_bytes += static_cast<uint32_t>(message_len_);
+        message_len_ = 0;
+        prepareMessage();
+    }
+    if (written > 0) {
+        stdio_flush();
+    }
+}
+
+// 从 stdin 中找出截屏请求；其余字节丢弃
+void StdioFrameCapture::pollRequests() {
+    for (uint32_t n = 0; n < REQUEST_READ_BUDGET; n++) {
+        int c = getchar_timeout_us(0);
+        if (c == PICO_ERROR_TIMEOUT) break;
+        request_buf_[request_fill_++] = static_cast<uint8_t>(c);
+
+        // 前两个字节必须是魔数，否则向后滑动
+        while (request_fill_ > 0 && (request_buf_[0] != static_cast<uint8_t>(FB_STREAM_MAGIC) ||
+                                     (request_fill_ > 1 && request_buf_[1] != static_cast<uint8_t>(FB_STREAM_MAGIC >> 8)))) {
+            memmove(request_buf_, request_buf_ + 1, --request_fill_);
+        }
+        if (request_fill_ < FB_STREAM_HEADER_LENGTH) continue;
+        request_fill_ = 0;
+
+        FbStreamHeader h;
+        if (fbStreamDecodeHeader(request_buf_, h) && h.type == FbStreamType::Capture) {
+            request(listen_source_, listen_snapshot_);  // 截屏进行中时忽略重复请求
+        }
+    }
+}
+
+// 编码下一条消息到 message_
+void StdioFrameCapture::prepareMessage() {
+    if (phase_ == Phase::Info) {
+        fbStreamEncodeHeader(message_, FbStreamHeader{FbStreamType::Capture, 0, seq_, 0, 0,
+                                                      source_.stride, source_.rows});
+        fbCaptureEncodeInfo(message_ + FB_STREAM_HEADER_LENGTH,
+                            FbCaptureInfo{source_.width, source_.height, source_.bits, source_.rotation});
+        message_len_ = FB_STREAM_HEADER_LENGTH + FB_CAPTURE_INFO_LENGTH;
+        phase_ = Phase::Bands;
+        return;
+    }
+    if (phase_ != Phase::Bands) return;
+    if (next_row_ >= source_.rows) {
+        phase_ = Phase::Idle;
+        stats_.captures++;
+        return;
+    }
+
+    const uint16_t row = next_row_;
+    const uint16_t rows = static_cast<uint16_t>(source_.rows - row < band_rows_ ? source_.rows - row : band_rows_);
+    const size_t n = static_cast<size_t>(rows) * source_.stride;
+    uint8_t* body = message_ + FB_STREAM_HEADER_LENGTH + FB_STREAM_DELTA_PREFIX_LENGTH;
+    // 行带大小保证最坏情况也放得下
+    const size_t encoded = fbRleEncode(frame_ + static_cast<size_t>(row) * source_.stride, nullptr, n, body,
+                                       max_message_ - FB_STREAM_HEADER_LENGTH - FB_STREAM_DELTA_PREFIX_LENGTH);
+
+    const bool last = part_ + 1 == parts_;
+    fbStreamEncodeHeader(message_, FbStreamHeader{FbStreamType::Delta,
+                                                  static_cast<uint8_t>(FB_STREAM_FLAG_KEY | (last ? FB_STREAM_FLAG_FRAME_END : 0)),
+                                                  seq_, 0, row, source_.stride, rows});
+    uint8_t* prefix = message_ + FB_STREAM_HEADER_LENGTH;
+    fbStreamPut16(prefix, 0);
+    prefix[2] = part_;
+    prefix[3] = parts_;
+    fbStreamPut16(prefix + 4, static_cast<uint16_t>(encoded));
+
+    message_len_ = FB_STREAM_HEADER_LENGTH + FB_STREAM_DELTA_PREFIX_LENGTH + encoded;
+    stats_.raw_bytes += static_cast<uint32_t>(n);
+    next_row_ = static_cast<uint16_t>(row + rows);
+    part_++;
+}
+
+bool StdioFrameCapture::hostConnected() const {
+#if LIB_PICO_STDIO_USB
+    return tud_cdc_connected();
+#else
+    return true;
+#endif
+}
+
+// 发送缓冲区剩余空间
+size_t StdioFrameCapture::writable() const {
+#if LIB_PICO_STDIO_USB
+    return tud_cdc_write_available();
+#else
+    // UART：putchar 只在硬件FIFO满时短暂等待，由 byte_budget 限制每次 poll() 的时间
+    return max_message_;
+#endif
+}
+
+} // namespace net
@@ -0,0 +1,74 @@
+#include "fb_stream_stdio.hpp"
+#include "pico/stdlib.h"
+#include "st73xx_trace.hpp"
+#include <cstdio>
+
+namespace net {
+
+namespace {
+
+// 一次交给解析器的字节数；解析器本身不暂存负载
+constexpr size_t READ_CHUNK = 64;
+
+} // namespace
+
+StdioFrameReceiver::StdioFrameReceiver(FrameSink& sink) :
+    sink_(sink),
+    parser_(sink.buffer(), sink.stride(), sink.rows()),
+    idle_reset_us_(DEFAULT_IDLE_RESET_MS * 1000),
+    last_data_us_(0),
+    stats_()
+{
+    parser_.setResync(true);
+}
+
+void StdioFrameReceiver::poll(uint32_t byte_budget) {
+    ST73XX_TRACE_SCOPE(st73xx::TraceEvent::NetPoll);
+    uint8_t chunk[READ_CHUNK];
+    uint32_t total = 0;
+    while (total < byte_budget) {
+        size_t n = 0;
+        while (n < sizeof(chunk)) {
+            int c = getchar_timeout_us(0);
+            if (c == PICO_ERROR_TIMEOUT) break;
+            chunk[n++] = static_cast<uint8_t>(c);
+        }
+        if (n == 0) break;
+        total += static_cast<uint32_t>(n);
+
+        if (!parser_.consume(chunk, n)) {
+            // 几何或编码错误：先刷出已完成的消息，再从下一个魔数重新开始
+            stats_.errors++;
+            flushStreamFrame(parser_, sink_, stats_, nullptr);
+            parser_.reset();
+        }
+        if (parser_.frameReady()) {
+            uint8_t ack[FB_STREAM_HEADER_LENGTH];
+            flushStreamFrame(parser_, sink_, stats_, ack);
+            sendAck(ack);
+        }
+        if (n < sizeof(chunk)) break;
+    }
+
+    const uint64_t now = time_us_64();
+    if (total > 0) {
+        last_data_us_ = now;
+    } else if (!parser_.atMessageBoundary() && now - last_data_us_ >= idle_reset_us_) {
+        // 主机端中途退出：丢掉半条消息，已完成的部分照常刷新
+        stats_.errors++;
+        parser_.abortMessage();
+        if (parser_.hasDirtyRows()) {
+            flushStreamFrame(parser_, sink_, stats_, nullptr);
+        }
+    }
+}
+
+void StdioFrameReceiver::sendAck(const uint8_t* msg) {
+    // putchar_raw 不把 '\n' 展开成 "\r\n"
+    for (size_t i = 0; i < FB_STREAM_HEADER_LENGTH; i++) {
+        putchar_raw(msg[i]);
+    }
+    stdio_flush();
+}
+
+} // namespace net
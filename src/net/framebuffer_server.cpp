@@ -0,0 +1,205 @@
+#include "framebuffer_server.hpp"
+#include "pico/stdlib.h"
+#include "lwip/pbuf.h"
+#include "lwip/tcp.h"
+#include "lwip/udp.h"
+#include "st73xx_trace.hpp"
+
+namespace net {
+
+FramebufferServer::FramebufferServer(FrameSink& sink) :
+    sink_(sink),
+    parser_(sink.buffer(), sink.stride(), sink.rows()),
+    mode_(Mode::Udp),
+    udp_(nullptr),
+    listener_(nullptr),
+    client_(nullptr),
+    peer_addr_(),
+    peer_port_(0),
+    have_peer_(false),
+    flush_timeout_us_(DEFAULT_FLUSH_TIMEOUT_MS * 1000),
+    last_data_us_(0),
+    stats_()
+{
+}
+
+FramebufferServer::~FramebufferServer() {
+    end();
+}
+
+bool FramebufferServer::begin(Mode mode, uint16_t port) {
+    end();
+    mode_ = mode;
+    parser_.reset();
+
+    if (mode == Mode::Udp) {
+        udp_ = udp_new_ip_type(IPADDR_TYPE_ANY);
+        if (!udp_) return false;
+        if (udp_bind(udp_, IP_ANY_TYPE, port) != ERR_OK) {
+            udp_remove(udp_);
+            udp_ = nullptr;
+            return false;
+        }
+        udp_recv(udp_, &FramebufferServer::udpRecv, this);
+        return true;
+    }
+
+    struct tcp_pcb* pcb = tcp_new_ip_type(IPADDR_TYPE_ANY);
+    if (!pcb) return false;
+    if (tcp_bind(pcb, IP_ANY_TYPE, port) != ERR_OK) {
+        tcp_close(pcb);
+        return false;
+    }
+    // 监听成功时原pcb已被释放，失败时仍需自行关闭
+    listener_ = tcp_listen_with_backlog(pcb, 1);
+    if (!listener_) {
+        tcp_close(pcb);
+        return false;
+    }
+    tcp_arg(listener_, this);
+    tcp_accept(listener_, &FramebufferServer::tcpAccept);
+    return true;
+}
+
+void FramebufferServer::end() {
+    closeClient();
+    if (listener_) {
+        tcp_close(listener_);
+        listener_ = nullptr;
+    }
+    if (udp_) {
+        udp_remove(udp_);
+        udp_ = nullptr;
+    }
+    have_peer_ = false;
+}
+
+void FramebufferServer::poll() {
+    ST73XX_TRACE_SCOPE(st73xx::TraceEvent::NetPoll);
+    if (parser_.frameReady()) {
+        flush(true);
+    } else if (parser_.hasDirtyRows() && time_us_64() - last_data_us_ >= flush_timeout_us_) {
+        flush(false);
+    }
+}
+
+void FramebufferServer::consumeChain(const struct pbuf* p) {
+    for (const struct pbuf* q = p; q; q = q->next) {
+        if (!parser_.consume(static_cast<const uint8_t*>(q->payload), q->len)) {
+            break;
+        }
+    }
+    last_data_us_ = time_us_64();
+}
+
+void FramebufferServer::flush(bool ack) {
+    uint8_t msg[FB_STREAM_HEADER_LENGTH];
+    flushStreamFrame(parser_, sink_, stats_, msg);
+    if (ack) {
+        sendAck(msg);
+    }
+}
+
+void FramebufferServer::sendAck(const uint8_t* msg) {
+    if (mode_ == Mode::Tcp) {
+        if (client_ && tcp_sndbuf(client_) >= FB_STREAM_HEADER_LENGTH) {
+            tcp_write(client_, msg, FB_STREAM_HEADER_LENGTH, TCP_WRITE_FLAG_COPY);
+            tcp_output(client_);
+        }
+        return;
+    }
+
+    if (!udp_ || !have_peer_) return;
+    struct pbuf* p = pbuf_alloc(PBUF_TRANSPORT, FB_STREAM_HEADER_LENGTH, PBUF_RAM);
+    if (!p) return;
+    pbuf_take(p, msg, FB_STREAM_HEADER_LENGTH);
+    udp_sendto(udp_, p, &peer_addr_, peer_port_);
+    pbuf_free(p);
+}
+
+void FramebufferServer::closeClient() {
+    if (!client_) return;
+    tcp_arg(client_, nullptr);
+    tcp_recv(client_, nullptr);
+    tcp_err(client_, nullptr);
+    if (tcp_close(client_) != ERR_OK) {
+        tcp_abort(client_);
+    }
+    client_ = nullptr;
+}
+
+void FramebufferServer::udpRecv(void* arg, struct udp_pcb* pcb, struct pbuf* p, const ip_addr_t* addr, uint16_t port) {
+    FramebufferServer* self = static_cast<FramebufferServer*>(arg);
+    ip_addr_copy(self->peer_addr_, *addr);
+    self->peer_port_ = port;
+    self->have_peer_ = true;
+
+    // 每个数据报是一条完整消息；截断的消息不计入脏行，出错的数据报不影响后续数据报
+    self->consumeChain(p);
+    if (self->parser_.error() != FbStreamParser::Error::None || !self->parser_.atMessageBoundary()) {
+        self->stats_.errors++;
+        if (self->parser_.error() != FbStreamParser::Error::None) {
+            // 错误状态只能由 reset() 清除，会丢掉累积的脏行，先把已完成的消息刷出去
+            if (self->parser_.hasDirtyRows() || self->parser_.frameReady()) {
+                self->flush(self->parser_.frameReady());
+            }
+            self->parser_.reset();
+        } else {
+            self->parser_.abortMessage();
+        }
+    }
+    pbuf_free(p);
+}
+
+err_t FramebufferServer::tcpAccept(void* arg, struct tcp_pcb* pcb, err_t err) {
+    FramebufferServer* self = static_cast<FramebufferServer*>(arg);
+    if (err != ERR_OK || !pcb) return ERR_VAL;
+    if (self->client_) {
+        // 只服务一个客户端
+        tcp_abort(pcb);
+        return ERR_ABRT;
+    }
+    self->client_ = pcb;
+    self->parser_.reset();
+    tcp_arg(pcb, self);
+    tcp_recv(pcb, &FramebufferServer::tcpRecv);
+    tcp_err(pcb, &FramebufferServer::tcpError);
+    tcp_nagle_disable(pcb);  // Ack 很小，不等待合并
+    return ERR_OK;
+}
+
+err_t FramebufferServer::tcpRecv(void* arg, struct tcp_pcb* pcb, struct pbuf* p, err_t err) {
+    FramebufferServer* self = static_cast<FramebufferServer*>(arg);
+    if (!p) {
+        // 对端关闭：刷新已收到的完整消息
+        if (self->parser_.hasDirtyRows()) {
+            self->flush(false);
+        }
+        self->closeClient();
+        return ERR_OK;
+    }
+
+    self->consumeChain(p);
+    tcp_recved(pcb, p->tot_len);
+    pbuf_free(p);
+
+    if (self->parser_.error() != FbStreamParser::Error::None) {
+        // 字节流失去同步，无法恢复
+        self->stats_.errors++;
+        self->parser_.reset();
+        self->client_ = nullptr;
+        tcp_abort(pcb);
+        return ERR_ABRT;
+    }
+    return ERR_OK;
+}
+
+void FramebufferServer::tcpError(void* arg, err_t err) {
+    FramebufferServer* self = static_cast<FramebufferServer*>(arg);
+    if (!self) return;
+    // pcb已被lwIP释放
+    self->client_ = nullptr;
+    self->parser_.reset();
+}
+
+} // namespace net
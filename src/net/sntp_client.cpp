@@ -0,0 +1,372 @@
+#include "sntp_client.hpp"
+#include "pico/stdlib.h"
+#include "lwip/dns.h"
+#include "lwip/pbuf.h"
+#include "lwip/udp.h"
+#include "st73xx_trace.hpp"
+#include <cstring>
+
+namespace net {
+
+namespace {
+
+constexpr int64_t US_PER_SECOND = 1000000;
+constexpr int64_t PPB_SCALE = 1000000000;
+
+// NTP报文字段偏移
+constexpr uint16_t OFFSET_ORIGINATE = 24;
+constexpr uint16_t OFFSET_RECEIVE = 32;
+constexpr uint16_t OFFSET_TRANSMIT = 40;
+
+NtpTimestamp readTimestamp(const uint8_t* p) {
+    NtpTimestamp ts = 0;
+    for (int i = 0; i < 8; i++) {
+        ts = (ts << 8) | p[i];
+    }
+    return ts;
+}
+
+void writeTimestamp(uint8_t* p, NtpTimestamp ts) {
+    for (int i = 7; i >= 0; i--) {
+        p[i] = static_cast<uint8_t>(ts);
+        ts >>= 8;
+    }
+}
+
+} // namespace
+
+NtpTimestamp ntpFromUnixUs(int64_t unix_us) {
+    int64_t seconds = unix_us / US_PER_SECOND;
+    int64_t micros = unix_us % US_PER_SECOND;
+    if (micros < 0) {
+        micros += US_PER_SECOND;
+        seconds--;
+    }
+    uint32_t ntp_seconds = static_cast<uint32_t>(seconds + NTP_UNIX_DELTA);
+    uint32_t fraction = static_cast<uint32_t>((static_cast<uint64_t>(micros) << 32) / US_PER_SECOND);
+    return (static_cast<NtpTimestamp>(ntp_seconds) << 32) | fraction;
+}
+
+int64_t unixUsFromNtp(NtpTimestamp ts) {
+    int64_t seconds = static_cast<int64_t>(ts >> 32);
+    if (seconds < 0x80000000LL) {
+        seconds += 0x100000000LL;  // 2036年之后的第1纪元
+    }
+    int64_t micros = static_cast<int64_t>(((ts & 0xFFFFFFFFu) * US_PER_SECOND + 0x80000000u) >> 32);
+    return (seconds - NTP_UNIX_DELTA) * US_PER_SECOND + micros;
+}
+
+// ==================== DisciplinedClock ====================
+
+DisciplinedClock::DisciplinedClock() :
+    ref_boot_us_(0), ref_unix_us_(0), drift_ppb_(0), synced_(false), last_sync_boot_us_(0) {}
+
+void DisciplinedClock::setUnixUs(int64_t unix_us) {
+    reanchor(time_us_64(), unix_us);
+}
+
+int64_t DisciplinedClock::nowUs() const {
+    return toUnixUs(time_us_64());
+}
+
+int64_t DisciplinedClock::toUnixUs(uint64_t boot_us) const {
+    int64_t dt = static_cast<int64_t>(boot_us - ref_boot_us_);
+    return ref_unix_us_ + dt + dt * drift_ppb_ / PPB_SCALE;
+}
+
+uint64_t DisciplinedClock::toBootUs(int64_t unix_us) const {
+    // dt = du * 1e9 / (1e9 + drift)，改写成减法避免 du * 1e9 溢出
+    int64_t du = unix_us - ref_unix_us_;
+    int64_t dt = du - du * drift_ppb_ / (PPB_SCALE + drift_ppb_);
+    return ref_boot_us_ + static_cast<uint64_t>(dt);
+}
+
+void DisciplinedClock::applyOffset(int64_t offset_us, uint64_t boot_us) {
+    int64_t corrected = toUnixUs(boot_us) + offset_us;
+
+    if (synced_) {
+        // 上次对时后累计的偏移来自频率误差；超过修正上限的视为时间跳变（例如服务器被更换），不参与估算
+        uint64_t interval = boot_us - last_sync_boot_us_;
+        if (interval >= MIN_DRIFT_INTERVAL_US) {
+            int64_t residual_ppb = offset_us * PPB_SCALE / static_cast<int64_t>(interval);
+            if (residual_ppb <= MAX_DRIFT_PPB && residual_ppb >= -MAX_DRIFT_PPB) {
+                // 只修正一半，抑制单次测量噪声
+                int64_t drift = drift_ppb_ + residual_ppb / 2;
+                if (drift > MAX_DRIFT_PPB) drift = MAX_DRIFT_PPB;
+                if (drift < -MAX_DRIFT_PPB) drift = -MAX_DRIFT_PPB;
+                drift_ppb_ = static_cast<int32_t>(drift);
+            }
+        }
+    }
+
+    reanchor(boot_us, corrected);
+    synced_ = true;
+    last_sync_boot_us_ = boot_us;
+}
+
+void DisciplinedClock::reanchor(uint64_t boot_us, int64_t unix_us) {
+    ref_boot_us_ = boot_us;
+    ref_unix_us_ = unix_us;
+}
+
+// ==================== SntpClient ====================
+
+SntpClient::SntpClient(DisciplinedClock& clock) :
+    clock_(clock), pcb_(nullptr), server_count_(0), state_(State::Idle), max_tries_(DEFAULT_MAX_TRIES),
+    timeout_us_(DEFAULT_TIMEOUT_MS * 1000), collect_window_us_(DEFAULT_COLLECT_WINDOW_MS * 1000),
+    dns_ttl_us_(static_cast<uint64_t>(DEFAULT_DNS_TTL_S) * 1000000), first_reply_us_(0),
+    sample_{0, 0, 0, 0}, selected_(-1) {}
+
+SntpClient::~SntpClient() {
+    end();
+}
+
+bool SntpClient::begin() {
+    if (pcb_) return true;
+    pcb_ = udp_new_ip_type(IPADDR_TYPE_ANY);
+    if (!pcb_) return false;
+    udp_recv(pcb_, &SntpClient::recv, this);
+    return true;
+}
+
+void SntpClient::end() {
+    cancel();
+    if (pcb_) {
+        udp_remove(pcb_);
+        pcb_ = nullptr;
+    }
+}
+
+bool SntpClient::addServer(const char* host) {
+    if (busy() || !host || server_count_ >= MAX_SERVERS) return false;
+    Slot& slot = servers_[server_count_++];
+    memset(&slot.stats, 0, sizeof(slot.stats));
+    slot.owner = this;
+    slot.stats.host = host;
+    slot.state = SlotState::Idle;
+    slot.tries = 0;
+    slot.deadline_us = 0;
+    slot.request_t1 = 0;
+    // IP字符串无需解析，永不过期
+    if (ipaddr_aton(host, &slot.stats.addr)) {
+        slot.stats.dns_expiry_us = UINT64_MAX;
+    }
+    return true;
+}
+
+void SntpClient::clearServers() {
+    if (busy()) return;
+    server_count_ = 0;
+    selected_ = -1;
+}
+
+bool SntpClient::start(uint32_t timeout_ms, uint8_t max_tries) {
+    if (busy() || !pcb_ || server_count_ == 0) return false;
+
+    max_tries_ = max_tries ? max_tries : 1;
+    timeout_us_ = timeout_ms * 1000;
+    first_reply_us_ = 0;
+    selected_ = -1;
+    state_ = State::Running;
+
+    uint64_t now = time_us_64();
+    for (uint8_t i = 0; i < server_count_; i++) {
+        startSlot(servers_[i], now);
+    }
+    poll();  // 全部立即失败时本轮就此结束
+    return true;
+}
+
+void SntpClient::startSlot(Slot& slot, uint64_t now_us) {
+    slot.tries = 0;
+    slot.request_t1 = 0;
+
+    if (now_us < slot.stats.dns_expiry_us) {
+        sendRequest(slot);  // 缓存命中
+        return;
+    }
+
+    // DNS 总时限与重发总时长相同
+    slot.state = SlotState::Resolving;
+    slot.deadline_us = now_us + static_cast<uint64_t>(timeout_us_) * max_tries_;
+    ip_addr_t addr;
+    err_t err = dns_gethostbyname(slot.stats.host, &addr, &SntpClient::dnsFound, &slot);
+    if (err == ERR_OK) {
+        dnsFound(slot.stats.host, &addr, &slot);
+    } else if (err != ERR_INPROGRESS) {
+        slot.state = SlotState::Failed;
+    }
+}
+
+void SntpClient::poll() {
+    if (!busy()) return;
+    ST73XX_TRACE_SCOPE(st73xx::TraceEvent::NetPoll);
+    uint64_t now = time_us_64();
+
+    for (uint8_t i = 0; i < server_count_; i++) {
+        Slot& slot = servers_[i];
+        if (!slotPending(slot) || static_cast<int64_t>(now - slot.deadline_us) < 0) continue;
+        if (slot.state == SlotState::Waiting && slot.tries < max_tries_) {
+            sendRequest(slot);
+        } else {
+            slot.state = SlotState::Failed;
+        }
+    }
+
+    bool pending = false;
+    for (uint8_t i = 0; i < server_count_; i++) {
+        pending |= slotPending(servers_[i]);
+    }
+    bool window_closed = first_reply_us_ != 0 && now - first_reply_us_ >= collect_window_us_;
+    if (!pending || window_closed) {
+        finishRound();
+    }
+}
+
+void SntpClient::cancel() {
+    if (!busy()) return;
+    for (uint8_t i = 0; i < server_count_; i++) {
+        servers_[i].state = SlotState::Idle;
+        servers_[i].request_t1 = 0;
+    }
+    state_ = State::Idle;
+}
+
+bool SntpClient::slotPending(const Slot& slot) const {
+    return slot.state == SlotState::Resolving || slot.state == SlotState::Waiting;
+}
+
+void SntpClient::dnsFound(const char* name, const ip_addr_t* addr, void* arg) {
+    Slot& slot = *static_cast<Slot*>(arg);
+    if (slot.state != SlotState::Resolving) return;  // 已取消或超时
+    if (!addr) {
+        slot.state = SlotState::Failed;
+        return;
+    }
+    ip_addr_copy(slot.stats.addr, *addr);
+    slot.stats.dns_expiry_us = time_us_64() + slot.owner->dns_ttl_us_;
+    slot.owner->sendRequest(slot);
+}
+
+void SntpClient::sendRequest(Slot& slot) {
+    struct pbuf* p = pbuf_alloc(PBUF_TRANSPORT, NTP_PACKET_LENGTH, PBUF_RAM);
+    uint64_t now = time_us_64();
+    slot.tries++;
+    slot.state = SlotState::Waiting;
+    slot.deadline_us = now + timeout_us_;
+    if (!p) return;  // 内存不足：按超时处理，下次 poll() 重发
+
+    uint8_t* req = static_cast<uint8_t*>(p->payload);
+    memset(req, 0, NTP_PACKET_LENGTH);
+    req[0] = 0x23;  // LI=0, VN=4, Mode=3（客户端）
+    slot.request_t1 = ntpFromUnixUs(clock_.toUnixUs(now));
+    writeTimestamp(req + OFFSET_TRANSMIT, slot.request_t1);
+
+    udp_sendto(pcb_, p, &slot.stats.addr, NTP_PORT);
+    pbuf_free(p);
+}
+
+void SntpClient::recv(void* arg, struct udp_pcb* pcb, struct pbuf* p, const ip_addr_t* addr, uint16_t port) {
+    uint64_t recv_boot_us = time_us_64();  // 尽早取 T4
+    SntpClient* self = static_cast<SntpClient*>(arg);
+    self->handleReply(p, addr, port, recv_boot_us);
+    pbuf_free(p);
+}
+
+void SntpClient::handleReply(struct pbuf* p, const ip_addr_t* addr, uint16_t port, uint64_t recv_boot_us) {
+    if (!busy() || port != NTP_PORT || p->tot_len < NTP_PACKET_LENGTH) return;
+
+    Slot* slot = nullptr;
+    for (uint8_t i = 0; i < server_count_; i++) {
+        if (servers_[i].state == SlotState::Waiting && ip_addr_cmp(addr, &servers_[i].stats.addr)) {
+            slot = &servers_[i];
+            break;
+        }
+    }
+    if (!slot) return;
+
+    uint8_t msg[NTP_PACKET_LENGTH];
+    pbuf_copy_partial(p, msg, NTP_PACKET_LENGTH, 0);
+
+    uint8_t leap = msg[0] >> 6;
+    uint8_t mode = msg[0] & 0x7;
+    uint8_t stratum = msg[1];
+    if (mode != 4) return;
+    if (readTimestamp(msg + OFFSET_ORIGINATE) != slot->request_t1) return;  // 不是本次请求的回复
+
+    if (stratum == 0 || stratum > 15 || leap == 3) {
+        // Kiss-o'-Death 或服务器未同步
+        slot->state = SlotState::Failed;
+        return;
+    }
+
+    NtpTimestamp t3_raw = readTimestamp(msg + OFFSET_TRANSMIT);
+    if (t3_raw == 0) return;
+
+    int64_t t1 = unixUsFromNtp(slot->request_t1);
+    int64_t t2 = unixUsFromNtp(readTimestamp(msg + OFFSET_RECEIVE));
+    int64_t t3 = unixUsFromNtp(t3_raw);
+    int64_t t4 = clock_.toUnixUs(recv_boot_us);
+
+    int64_t delay = (t4 - t1) - (t3 - t2);
+    if (delay < 0) return;
+
+    slot->sample.offset_us = ((t2 - t1) + (t3 - t4)) / 2;
+    slot->sample.delay_us = delay;
+    slot->sample.boot_us = recv_boot_us;
+    slot->sample.stratum = stratum;
+    slot->state = SlotState::Replied;
+    slot->request_t1 = 0;
+    if (first_reply_us_ == 0) first_reply_us_ = recv_boot_us;
+}
+
+void SntpClient::finishRound() {
+    int64_t best_score = INT64_MAX;
+    selected_ = -1;
+
+    for (uint8_t i = 0; i < server_count_; i++) {
+        Slot& slot = servers_[i];
+        SntpServerStats& st = slot.stats;
+        bool replied = slot.state == SlotState::Replied;
+        st.reach = static_cast<uint8_t>((st.reach << 1) | (replied ? 1 : 0));
+
+        if (!replied) {
+            // 域名服务器整轮无回复：丢弃地址缓存，下一轮重新解析
+            if (st.dns_expiry_us != UINT64_MAX) st.dns_expiry_us = 0;
+            slot.state = SlotState::Idle;
+            slot.request_t1 = 0;
+            continue;
+        }
+
+        // 延迟与抖动统计（指数平均，权重1/4；第一个样本直接作为初值）
+        int64_t delay = slot.sample.delay_us;
+        if (st.samples == 0) {
+            st.delay_avg_us = delay;
+            st.jitter_us = 0;
+        } else {
+            int64_t deviation = delay - st.delay_avg_us;
+            if (deviation < 0) deviation = -deviation;
+            st.jitter_us += (deviation - st.jitter_us) / 4;
+            st.delay_avg_us += (delay - st.delay_avg_us) / 4;
+        }
+        st.samples++;
+        st.last = slot.sample;
+        slot.state = SlotState::Idle;
+
+        int64_t score = delay + st.jitter_us;
+        if (score < best_score) {
+            best_score = score;
+            selected_ = static_cast<int8_t>(i);
+        }
+    }
+
+    if (selected_ < 0) {
+        state_ = State::Failed;
+        return;
+    }
+    sample_ = servers_[selected_].sample;
+    clock_.applyOffset(sample_.offset_us, sample_.boot_us);
+    state_ = State::Done;
+}
+
+} // namespace net
@@ -1,70 +1,103 @@
 #include "st7306_driver.hpp"
 #include <cstring>
+#include <new>
 #include <cstdio>
-#include "hardware/spi.h"
-#include "hardware/gpio.h"
+#include "hardware/structs/watchdog.h"
 #include "pico/stdlib.h"
 #include "st73xx_font.hpp"
 #include "gfx_colors.hpp"
+#include "st73xx_init_sequence.hpp"
+#include "st73xx_init_tables.hpp"
+#include "st73xx_metrics.hpp"
+#include "st73xx_trace.hpp"
+#include "st73xx_spi_transport.hpp"
+#include "st73xx_text.hpp"
 
 namespace st7306 {
 
-ST7306Driver::ST7306Driver(uint dc_pin, uint res_pin, uint cs_pin, uint sclk_pin, uint sdin_pin) :
-    dc_pin_(dc_pin),
-    res_pin_(res_pin),
-    cs_pin_(cs_pin),
-    sclk_pin_(sclk_pin),
-    sdin_pin_(sdin_pin),
-    display_buffer_(new uint8_t[DISPLAY_BUFFER_LENGTH]),
+namespace {
+
+// 热启动标记：保存在看门狗scratch寄存器中，软件复位/看门狗复位后保留，上电复位清零
+constexpr uint32_t WARM_BOOT_MAGIC = 0x73060A11;
+
+} // namespace
+
+ST7306Driver::ST7306Driver(uint dc_pin, uint res_pin, uint cs_pin, uint sclk_pin, uint sdin_pin,
+                           uint8_t* framebuffer, BufferFormat format) :
+    pin_transport_(new (pin_transport_storage_) st73xx::SpiTransport(spi0, dc_pin, res_pin, cs_pin, sclk_pin, sdin_pin)),
+    transport_(pin_transport_),
+    display_buffer_(framebuffer),
+    format_(format),
+    framebuffer_(nullptr),
+    mono_framebuffer_(nullptr),
     font_layout_(FontLayout::Vertical)
 {
-    // 初始化GPIO
-    gpio_init(dc_pin_);
-    gpio_init(res_pin_);
-    gpio_init(cs_pin_);
-    gpio_init(sclk_pin_);
-    gpio_init(sdin_pin_);
-
-    gpio_set_dir(dc_pin_, GPIO_OUT);
-    gpio_set_dir(res_pin_, GPIO_OUT);
-    gpio_set_dir(cs_pin_, GPIO_OUT);
-    gpio_set_dir(sclk_pin_, GPIO_OUT);
-    gpio_set_dir(sdin_pin_, GPIO_OUT);
-
-    // 初始化SPI - 速率40MHz
-    spi_init(spi0, 40000000); // 40MHz
-    spi_set_format(spi0, 8, SPI_CPOL_0, SPI_CPHA_0, SPI_MSB_FIRST);
-    gpio_set_function(sclk_pin_, GPIO_FUNC_SPI);
-    gpio_set_function(sdin_pin_, GPIO_FUNC_SPI);
+    attachBuffer();
+}
+
+ST7306Driver::ST7306Driver(st73xx::Transport& transport, uint8_t* framebuffer, BufferFormat format) :
+    transport_(&transport),
+    display_buffer_(framebuffer),
+    format_(format),
+    framebuffer_(nullptr),
+    mono_framebuffer_(nullptr),
+    font_layout_(FontLayout::Vertical)
+{
+    attachBuffer();
+}
+
+void ST7306Driver::attachBuffer() {
+#if !ST73XX_NO_HEAP
+    if (!display_buffer_) {
+        display_buffer_ = new uint8_t[isMonoMode() ? MONO_BUFFER_LENGTH : DISPLAY_BUFFER_LENGTH];
+        owns_buffer_ = true;
+    }
+#endif
+    if (isMonoMode()) {
+        mono_framebuffer_.attach(display_buffer_);
+    } else {
+        framebuffer_.attach(display_buffer_);
+    }
 }
 
 ST7306Driver::~ST7306Driver() {
-    delete[] display_buffer_;
-}
-
-void ST7306Driver::initialize() {
-    // 初始化引脚
-    gpio_set_dir(dc_pin_, GPIO_OUT);
-    gpio_set_dir(res_pin_, GPIO_OUT);
-    gpio_set_dir(cs_pin_, GPIO_OUT);
-    gpio_set_dir(sclk_pin_, GPIO_OUT);
-    gpio_set_dir(sdin_pin_, GPIO_OUT);
-
-    // 复位时序
-    gpio_put(res_pin_, 1);
-    sleep_ms(10);
-    gpio_put(res_pin_, 0);
-    sleep_ms(10);
-    gpio_put(res_pin_, 1);
-    sleep_ms(10);
-
-    // 初始化SPI
-    spi_init(spi0, 40000000); // 40MHz
-    spi_set_format(spi0, 8, SPI_CPOL_0, SPI_CPHA_0, SPI_MSB_FIRST);
-    gpio_set_function(sclk_pin_, GPIO_FUNC_SPI);
-    gpio_set_function(sdin_pin_, GPIO_FUNC_SPI);
-
-    initST7306();
+    disablePowerGovernor();
+    transport_->wait();
+#if !ST73XX_NO_HEAP
+    if (owns_buffer_) {
+        delete[] display_buffer_;
+    }
+#endif
+    if (pin_transport_) {
+        pin_transport_->~SpiTransport();
+    }
+}
+
+void ST7306Driver::initialize(st73xx::InitMode mode) {
+    BusGuard guard(*this);
+
+    // 控制脚与总线由传输负责初始化（引脚构造时为spi0，40MHz）
+    transport_->begin();
+
+    // 复位脚没有保持高电平时面板已被复位，只能冷启动
+    bool warm = transport_->resetPinWasHigh() &&
+                ((mode == st73xx::InitMode::Warm) ||
+                 (mode == st73xx::InitMode::Auto &&
+                  watchdog_hw->scratch[ST7306_WARM_BOOT_SCRATCH] == WARM_BOOT_MAGIC));
+
+    if (!warm) {
+        // 复位时序
+        transport_->setReset(true);
+        transport_->delayMs(10);
+        transport_->setReset(false);
+        transport_->delayMs(10);
+        transport_->setReset(true);
+        transport_->delayMs(10);
+    }
+
+    initST7306(warm);
+    warm_started_ = warm;
+    watchdog_hw->scratch[ST7306_WARM_BOOT_SCRATCH] = WARM_BOOT_MAGIC;
     
     // 初始化显示缓冲区为白色
     fill(0x00);  // 填充为白色
@@ -74,221 +107,182 @@ void ST7306Driver::initialize() {
     initialized_ = true;
 }
 
-void ST7306Driver::initST7306() {
-    writeCommand(0xD6); // NVM Load Control
-    writeData(0x17);
-    writeData(0x02);
-
-    writeCommand(0xD1); // Booster Enable
-    writeData(0x01);
-
-    // 完全匹配原厂代码ST7306_4p2_BW_DisplayDriver.cpp中的Initial_ST7305函数
-    writeCommand(0xC0); // Gate Voltage Setting
-    writeData(0x12); // VGH 17V
-    writeData(0x0A); // VGL -10V
-
-    // VLC=3.6V (12/-5)(delta Vp=0.6V)
-    writeCommand(0xC1); // VSHP Setting (4.8V)
-    writeData(115);    // VSHP1
-    writeData(0x3E);   // VSHP2
-    writeData(0x3C);   // VSHP3
-    writeData(0x3C);   // VSHP4
-
-    writeCommand(0xC2); // VSLP Setting (0.98V)
-    writeData(0);      // VSLP1
-    writeData(0x21);   // VSLP2
-    writeData(0x23);   // VSLP3
-    writeData(0x23);   // VSLP4
-
-    writeCommand(0xC4); // VSHN Setting (-3.6V)
-    writeData(50);     // VSHN1
-    writeData(0x5C);   // VSHN2
-    writeData(0x5A);   // VSHN3
-    writeData(0x5A);   // VSHN4
-
-    writeCommand(0xC5); // VSLN Setting (0.22V)
-    writeData(50);     // VSLN1
-    writeData(0x35);   // VSLN2
-    writeData(0x37);   // VSLN3
-    writeData(0x37);   // VSLN4
-
-    writeCommand(0xD8); // OSC Setting
-    writeData(0xA6);
-    writeData(0xE9);
-
-    writeCommand(0xB2); // Frame Rate Control
-    writeData(0x12);   // HPM=32hz ; LPM=1hz
-
-    // 添加B3命令 - Update Period Gate EQ Control in HPM
-    writeCommand(0xB3);
-    writeData(0xE5);
-    writeData(0xF6);
-    writeData(0x17);
-    writeData(0x77);
-    writeData(0x77);
-    writeData(0x77);
-    writeData(0x77);
-    writeData(0x77);
-    writeData(0x77);
-    writeData(0x71);
-
-    // 添加B4命令 - Update Period Gate EQ Control in LPM
-    writeCommand(0xB4);
-    writeData(0x05);
-    writeData(0x46);
-    writeData(0x77);
-    writeData(0x77);
-    writeData(0x77);
-    writeData(0x77);
-    writeData(0x76);
-    writeData(0x45);
-
-    // 添加Gate Timing Control
-    writeCommand(0x62);
-    writeData(0x32);
-    writeData(0x03);
-    writeData(0x1F);
-    
-    // Source EQ Enable
-    writeCommand(0xB7);
-    writeData(0x13);
-    
-    // Gate Line Setting
-    writeCommand(0xB0);
-    writeData(0x64); // 400行 = 100*4
+void ST7306Driver::initST7306(bool warm) {
+    st73xx::runInitSequence(INIT_SEQUENCE, warm,
+        [this](const st73xx::CommandBatch& batch) { writeBatch(batch); },
+        [this](uint32_t ms) { transport_->delayMs(ms); });
 
-    writeCommand(0x11); // Sleep out
-    sleep_ms(120);
+    hpm_mode_ = true;
+    lpm_mode_ = false;
+    sleeping_ = false;
+    mode_switch_ms_ = to_ms_since_boot(get_absolute_time());
+}
 
-    writeCommand(0xC9); // Source Voltage Select
-    writeData(0x00);   // VSHP1; VSLP1 ; VSHN1 ; VSLN1
+void ST7306Driver::writeCommand(uint8_t cmd) {
+    st73xx::CommandBatch batch;
+    batch.command(cmd);
+    writeBatch(batch);
+}
 
-    writeCommand(0x36); // Memory Data Access Control
-    writeData(0x48);   // MX=1 ; DO=1
+// 在一次CS拉低期间发送整个批次，可选地紧跟一段数据负载（如显存）
+// 之前的异步刷新由传输自行等待完成
+void ST7306Driver::writeBatch(const st73xx::CommandBatch& batch, const uint8_t* payload, size_t len) {
+    ST73XX_METRIC_BUS_BYTES(batch.size() + len);
+    transport_->write(batch, payload, len);
+}
 
-    writeCommand(0x3A); // Data Format Select
-    writeData(0x11);   // 11: 3write for 24bit
+void ST7306Driver::clear() {
+    ST73XX_METRIC_SPAN(static_cast<uint32_t>(LCD_WIDTH) * LCD_HEIGHT);
+    if (isMonoMode()) {
+        mono_framebuffer_.fill(0);
+        return;
+    }
+    framebuffer_.fill(COLOR_WHITE);
+}
 
-    writeCommand(0xB9); // Gamma Mode Setting
-    writeData(0x20);   // 20: Mono
+// data 为2bit显存的原始字节；单色模式下任何非零字节都按全黑填充
+void ST7306Driver::fill(uint8_t data) {
+    ST73XX_METRIC_SPAN(static_cast<uint32_t>(LCD_WIDTH) * LCD_HEIGHT);
+    if (isMonoMode()) {
+        mono_framebuffer_.fillBytes(data ? 0xFF : 0x00);
+        return;
+    }
+    framebuffer_.fillBytes(data);
+}
 
-    writeCommand(0xB8); // Panel Setting
-    writeData(0x29);   // 1-Dot inversion, Frame inversion, One Line Interlace
+void ST7306Driver::writePoint(uint16_t x, uint16_t y, bool enabled) {
+    // 将布尔值转换为灰度值：true -> COLOR_BLACK (0x03), false -> COLOR_WHITE (0x00)
+    writePointGray(x, y, enabled ? COLOR_BLACK : COLOR_WHITE);
+}
 
-    writeCommand(0x2A); // Column Address Setting
-    writeData(0x05);
-    writeData(0x36);
+void ST7306Driver::display() {
+    ST73XX_METRIC_FLUSH_SCOPE();
+    ST73XX_TRACE_SCOPE(st73xx::TraceEvent::Flush);
+    BusGuard guard(*this);
+    governorOnFlush();
+
+    if (isMonoMode()) {
+        displayMono();
+        return;
+    }
 
-    writeCommand(0x2B); // Row Address Setting
-    writeData(0x00);
-    writeData(0xC7);   // 0xC7 = 199 (LCD_DATA_HEIGHT-1)
+    // 地址窗口、写显存命令和整帧数据在同一次CS拉低中发送
+    st73xx::CommandBatch batch;
+    appendAddressWindow(batch);
+    batch.command(0x2C); // write image data
+    writeBatch(batch, display_buffer_, DISPLAY_BUFFER_LENGTH);
+}
 
-    writeCommand(0x35); // TE
-    writeData(0x00);
+void ST7306Driver::displayAsync() {
+    // 单色模式退化为同步刷新，统计与追踪由 display() 记录，避免重复计数
+    if (isMonoMode()) {
+        display();
+        return;
+    }
 
-    writeCommand(0xD0); // Auto power down
-    writeData(0xFF);   // Auto power down ON
+    ST73XX_METRIC_FLUSH_SCOPE();
+    ST73XX_TRACE_SCOPE(st73xx::TraceEvent::Flush);
+    BusGuard guard(*this);
+    governorOnFlush();
 
-    writeCommand(0x38); // HPM:high Power Mode ON
+    st73xx::CommandBatch batch;
+    appendAddressWindow(batch);
+    batch.command(0x2C); // write image data
+    ST73XX_METRIC_BUS_BYTES(batch.size() + DISPLAY_BUFFER_LENGTH);
+    transport_->writeAsync(batch, display_buffer_, DISPLAY_BUFFER_LENGTH);
+}
 
-    writeCommand(0x29); // Display ON
+void ST7306Driver::displayRows(uint16_t first_row, uint16_t row_count) {
+    if (first_row >= Packing::ROWS || row_count == 0) return;
+    if (row_count > Packing::ROWS - first_row) row_count = Packing::ROWS - first_row;
 
-    writeCommand(0x20); // Display Inversion Off
+    ST73XX_METRIC_FLUSH_SCOPE();
+    ST73XX_TRACE_SCOPE(st73xx::TraceEvent::Flush);
+    BusGuard guard(*this);
+    governorOnFlush();
 
-    writeCommand(0xBB); // Enable Clear RAM
-    writeData(0x4F);   // CLR=0 ; Enable Clear RAM,clear RAM to 0
+    if (isMonoMode()) {
+        displayMono(first_row, row_count);
+        return;
+    }
 
-    // 等待清除完成
-    sleep_ms(10);
-    
-    // 重新设置地址窗口，确保显示正常
-    writeCommand(0x2A); // Column Address Setting
-    writeData(0x05);
-    writeData(0x36);
+    // 行地址收窄到 [first_row, first_row + row_count)，数据是显存中连续的一段
+    st73xx::CommandBatch batch;
+    appendAddressWindow(batch, first_row, first_row + row_count - 1);
+    batch.command(0x2C); // write image data
+    writeBatch(batch, display_buffer_ + static_cast<uint32_t>(first_row) * Packing::STRIDE,
+               static_cast<size_t>(row_count) * Packing::STRIDE);
+}
+
+// 单色刷新：地址窗口和0x2C之后，整帧30000字节在同一次CS拉低中分块发送。
+// 每块由若干字节行查表展开而成，DMA/PIO传输发送当前块时CPU展开下一块。
+// 传输无法开始分块发送时，退回逐块阻塞发送（每块带各自的行地址窗口），帧不会被丢弃。
+void ST7306Driver::displayMono(uint16_t first_row, uint16_t row_count) {
+    using Expander = st73xx::ST7306MonoExpander;
+
+    st73xx::CommandBatch batch;
+    appendAddressWindow(batch, first_row, first_row + row_count - 1);
+    batch.command(0x2C); // write image data
+    if (!transport_->beginWrite(batch, static_cast<size_t>(row_count) * Packing::STRIDE)) {
+        displayMonoBlocking(first_row, row_count);
+        return;
+    }
+    ST73XX_METRIC_BUS_BYTES(batch.size() + static_cast<size_t>(row_count) * Packing::STRIDE);
 
-    writeCommand(0x2B); // Row Address Setting  
-    writeData(0x00);
-    writeData(0xC7);
+    const uint8_t* src = display_buffer_ + static_cast<uint32_t>(first_row) * MonoPacking::STRIDE;
+    const uint16_t end_row = first_row + row_count;
+    uint8_t current = 0;
+    for (uint16_t row = first_row; row < end_row; row += MONO_LINES_PER_CHUNK) {
+        uint16_t lines = end_row - row;
+        if (lines > MONO_LINES_PER_CHUNK) lines = MONO_LINES_PER_CHUNK;
 
-    hpm_mode_ = true;
-    lpm_mode_ = false;
-}
+        uint8_t* dst = line_buffers_[current];
+        Expander::expandRows(src, dst, lines);
+        src += static_cast<uint32_t>(lines) * MonoPacking::STRIDE;
 
-void ST7306Driver::writeCommand(uint8_t cmd) {
-    gpio_put(dc_pin_, 0);
-    gpio_put(cs_pin_, 0);
-    spi_write_blocking(spi0, &cmd, 1);
-    gpio_put(cs_pin_, 1);
+        transport_->writeChunk(dst, static_cast<size_t>(lines) * Packing::STRIDE);
+        current ^= 1;
+    }
+    transport_->endWrite();
 }
 
-void ST7306Driver::writeData(uint8_t data) {
-    gpio_put(dc_pin_, 1);
-    gpio_put(cs_pin_, 0);
-    spi_write_blocking(spi0, &data, 1);
-    gpio_put(cs_pin_, 1);
-}
+void ST7306Driver::displayMonoBlocking(uint16_t first_row, uint16_t row_count) {
+    using Expander = st73xx::ST7306MonoExpander;
 
-void ST7306Driver::writeData(const uint8_t* data, size_t len) {
-    gpio_put(dc_pin_, 1);
-    gpio_put(cs_pin_, 0);
-    spi_write_blocking(spi0, data, len);
-    gpio_put(cs_pin_, 1);
-}
+    const uint8_t* src = display_buffer_ + static_cast<uint32_t>(first_row) * MonoPacking::STRIDE;
+    const uint16_t end_row = first_row + row_count;
+    for (uint16_t row = first_row; row < end_row; row += MONO_LINES_PER_CHUNK) {
+        uint16_t lines = end_row - row;
+        if (lines > MONO_LINES_PER_CHUNK) lines = MONO_LINES_PER_CHUNK;
 
-void ST7306Driver::clear() {
-    memset(display_buffer_, 0x00, DISPLAY_BUFFER_LENGTH);
-}
+        uint8_t* dst = line_buffers_[0];
+        Expander::expandRows(src, dst, lines);
+        src += static_cast<uint32_t>(lines) * MonoPacking::STRIDE;
 
-void ST7306Driver::fill(uint8_t data) {
-    memset(display_buffer_, data, DISPLAY_BUFFER_LENGTH);
+        st73xx::CommandBatch batch;
+        appendAddressWindow(batch, row, row + lines - 1);
+        batch.command(0x2C); // write image data
+        writeBatch(batch, dst, static_cast<size_t>(lines) * Packing::STRIDE);
+    }
 }
 
-void ST7306Driver::writePoint(uint16_t x, uint16_t y, bool enabled) {
-    // 将布尔值转换为灰度值：true -> COLOR_BLACK (0x03), false -> COLOR_WHITE (0x00)
-    writePointGray(x, y, enabled ? COLOR_BLACK : COLOR_WHITE);
+bool ST7306Driver::isDisplayBusy() const {
+    return transport_->busy();
 }
 
-void ST7306Driver::display() {
-    setAddress();
-    
-    // 按照原厂Arduino代码的写法传输数据
-    writeData(display_buffer_, DISPLAY_BUFFER_LENGTH);
-    
-    // printf("Display buffer transmitted: %d bytes\n", DISPLAY_BUFFER_LENGTH); // 已注释，避免频繁输出
+void ST7306Driver::waitForDisplay() {
+    transport_->wait();
 }
 
-void ST7306Driver::setAddress() {
-    // 完全按照原厂驱动代码中的address函数
-    writeCommand(0x2A); // Column Address Setting S61~S182
-    writeData(0x05);    // Start column address
-    writeData(0x36);    // End column address 0x36 = 54
-
-    writeCommand(0x2B); // Row Address Setting G1~G250  
-    writeData(0x00);    // Start row address
-    writeData(0xC7);    // End row address 0xC7 = 199
-
-    writeCommand(0x2C); // write image data
+void ST7306Driver::appendAddressWindow(st73xx::CommandBatch& batch, uint16_t first_row, uint16_t last_row) {
+    // 完全按照原厂驱动代码中的address函数；整帧时行地址为 0x00~0xC7
+    batch.command(0x2A, {0x05, 0x36})  // Column Address Setting S61~S182, end column 0x36 = 54
+         .command(0x2B, {static_cast<uint8_t>(first_row), static_cast<uint8_t>(last_row)}); // Row Address Setting, end row 0xC7 = 199
 }
 
 void ST7306Driver::drawPixel(uint16_t x, uint16_t y, bool color) {
-    uint16_t tx = x, ty = y;
-    switch (rotation_) {
-        case 1:
-            tx = LCD_WIDTH - 1 - y;
-            ty = x;
-            break;
-        case 2:
-            tx = LCD_WIDTH - 1 - x;
-            ty = LCD_HEIGHT - 1 - y;
-            break;
-        case 3:
-            tx = y;
-            ty = LCD_HEIGHT - 1 - x;
-            break;
-        default:
-            break;
-    }
-    plotPixelRaw(tx, ty, color);
+    Framebuffer::rotate(rotation_, x, y);
+    plotPixelRaw(x, y, color);
 }
 
 void ST7306Driver::plotPixelRaw(uint16_t x, uint16_t y, bool color) {
@@ -301,42 +295,174 @@ void ST7306Driver::plotPixelGrayRaw(uint16_t x, uint16_t y, uint8_t gray_level)
     writePointGray(x, y, level);
 }
 
+void ST7306Driver::fillRectRaw(uint16_t x, uint16_t y, uint16_t w, uint16_t h, bool color) {
+    ST73XX_METRIC_SPAN(static_cast<uint32_t>(w) * h);
+    if (isMonoMode()) {
+        mono_framebuffer_.fillRect(x, y, w, h, color ? 1 : 0);
+        return;
+    }
+    framebuffer_.fillRect(x, y, w, h, color ? COLOR_BLACK : COLOR_WHITE);
+}
+
 void ST7306Driver::displayOn(bool enabled) {
+    BusGuard guard(*this);
     writeCommand(enabled ? 0x29 : 0x28);
 }
 
 void ST7306Driver::displaySleep(bool enabled) {
+    BusGuard guard(*this);
     if (enabled) {
         if (lpm_mode_) {
-            writeCommand(0x38); // HPM:high Power Mode ON
-            sleep_ms(300);
+            setPowerMode(false); // Sleep IN 前必须回到HPM
         }
+        // 只等待模式切换剩余的稳定时间（调节器可能早已完成切换）
+        waitForModeTransition();
         writeCommand(0x10); // Sleep IN
-        sleep_ms(100);
+        transport_->delayMs(100);
+        sleeping_ = true;
+        watchdog_hw->scratch[ST7306_WARM_BOOT_SCRATCH] = 0; // 休眠中的面板需要完整唤醒流程
     } else {
         writeCommand(0x11); // Sleep OUT
-        sleep_ms(100);
+        transport_->delayMs(100);
+        sleeping_ = false;
+        if (initialized_) {
+            watchdog_hw->scratch[ST7306_WARM_BOOT_SCRATCH] = WARM_BOOT_MAGIC;
+        }
     }
 }
 
 void ST7306Driver::displayInversion(bool enabled) {
+    BusGuard guard(*this);
     writeCommand(enabled ? 0x21 : 0x20);
 }
 
 void ST7306Driver::lowPowerMode() {
-    if (!lpm_mode_) {
-        writeCommand(0x39); // LPM:Low Power Mode ON
-        hpm_mode_ = false;
-        lpm_mode_ = true;
-    }
+    BusGuard guard(*this);
+    setPowerMode(true);
 }
 
 void ST7306Driver::highPowerMode() {
-    if (!hpm_mode_) {
+    BusGuard guard(*this);
+    setPowerMode(false);
+}
+
+void ST7306Driver::setPowerMode(bool low_power) {
+    if (low_power) {
+        if (lpm_mode_) return;
+        writeCommand(0x39); // LPM:Low Power Mode ON
+        hpm_mode_ = false;
+        lpm_mode_ = true;
+    } else {
+        if (hpm_mode_) return;
         writeCommand(0x38); // HPM:high Power Mode ON
         hpm_mode_ = true;
         lpm_mode_ = false;
     }
+    mode_switch_ms_ = to_ms_since_boot(get_absolute_time());
+}
+
+void ST7306Driver::waitForModeTransition() {
+    uint32_t elapsed = to_ms_since_boot(get_absolute_time()) - mode_switch_ms_;
+    if (elapsed < governor_config_.transition_ms) {
+        transport_->delayMs(governor_config_.transition_ms - elapsed);
+    }
+}
+
+void ST7306Driver::enablePowerGovernor(const PowerGovernorConfig& config) {
+    BusGuard guard(*this);
+    governor_config_ = config;
+    governor_enabled_ = true;
+    burst_count_ = 0;
+    last_flush_ms_ = to_ms_since_boot(get_absolute_time());
+    if (hpm_mode_) {
+        armGovernorAlarm();
+    }
+}
+
+void ST7306Driver::disablePowerGovernor() {
+    BusGuard guard(*this);
+    governor_enabled_ = false;
+    if (governor_alarm_pending_) {
+        cancel_alarm(governor_alarm_);
+        governor_alarm_pending_ = false;
+    }
+}
+
+bool ST7306Driver::isPowerGovernorEnabled() const {
+    return governor_enabled_;
+}
+
+bool ST7306Driver::isLowPowerMode() const {
+    return lpm_mode_;
+}
+
+// 每次刷新时调用（调用者持有BusGuard）
+// LPM下连续出现短间隔刷新，说明进入活动期，在发送本帧数据之前切回HPM，
+// 并像 displaySleep() 一样等过 transition_ms 的稳定时间，避免本帧在模式切换途中写入
+void ST7306Driver::governorOnFlush() {
+    if (!governor_enabled_) return;
+
+    uint32_t now = to_ms_since_boot(get_absolute_time());
+    if (now - last_flush_ms_ <= governor_config_.burst_interval_ms) {
+        if (burst_count_ < 0xFF) burst_count_ = burst_count_ + 1;
+    } else {
+        burst_count_ = 0;
+    }
+    last_flush_ms_ = now;
+
+    if (lpm_mode_ && !sleeping_ &&
+        burst_count_ + 1 >= governor_config_.burst_flushes &&
+        now - mode_switch_ms_ >= governor_config_.transition_ms) {
+        setPowerMode(false);
+        waitForModeTransition();
+    }
+
+    if (hpm_mode_) {
+        armGovernorAlarm();
+    }
+}
+
+void ST7306Driver::armGovernorAlarm() {
+    if (governor_alarm_pending_) return; // 已有告警，回调中会按最后刷新时间自行顺延
+    alarm_id_t id = add_alarm_in_ms(governor_config_.idle_timeout_ms, governorAlarmCallback, this, true);
+    if (id > 0) {
+        governor_alarm_ = id;
+        governor_alarm_pending_ = true;
+    }
+}
+
+// 定时器告警回调（中断上下文）
+// 返回值 <0 表示从现在起多少微秒后再次触发，0 表示不再触发
+int64_t ST7306Driver::governorAlarmCallback(alarm_id_t id, void* user_data) {
+    (void)id;
+    ST7306Driver* self = static_cast<ST7306Driver*>(user_data);
+
+    // 主循环正在发送命令序列或异步刷新尚未结束，稍后重试，避免把0x39插进参数中间
+    if (self->bus_busy_ || self->transport_->busy()) {
+        return -5000;
+    }
+
+    if (!self->governor_enabled_ || self->lpm_mode_ || self->sleeping_) {
+        self->governor_alarm_pending_ = false;
+        return 0;
+    }
+
+    uint32_t now = to_ms_since_boot(get_absolute_time());
+    uint32_t idle = now - self->last_flush_ms_;
+    uint32_t since_switch = now - self->mode_switch_ms_;
+    const PowerGovernorConfig& cfg = self->governor_config_;
+
+    if (idle < cfg.idle_timeout_ms) {
+        return -static_cast<int64_t>(cfg.idle_timeout_ms - idle) * 1000;
+    }
+    if (since_switch < cfg.transition_ms) {
+        return -static_cast<int64_t>(cfg.transition_ms - since_switch) * 1000;
+    }
+
+    self->setPowerMode(true);
+    self->burst_count_ = 0;
+    self->governor_alarm_pending_ = false;
+    return 0;
 }
 
 void ST7306Driver::clearDisplay() {
@@ -380,124 +506,41 @@ uint8_t ST7306Driver::getCurrentFontWidth() const {
 }
 
 void ST7306Driver::drawString(uint16_t x, uint16_t y, const char* str, bool color) {
-    while (*str) {
-        if (*str < 32 || *str > 126) {
-            str++;
-            continue;
-        }
-        
-        drawChar(x, y, *str, color);
-        
-        switch (rotation_) {
-            case 0: // 正常横排
-                x += font::FONT_WIDTH;
-                break;
-            case 1: // 90度，竖排，字头朝上
-                y += font::FONT_WIDTH;
-                break;
-            case 2: // 180度，横排反向
-                x -= font::FONT_WIDTH;
-                break;
-            case 3: // 270度，竖排反向
-                y -= font::FONT_WIDTH;
-                break;
-            default:
-                x += font::FONT_WIDTH;
-                break;
-        }
-        str++;
-    }
+    drawString(x, y, std::string_view(str), color);
 }
 
 void ST7306Driver::drawChar(uint16_t x, uint16_t y, char c, bool color) {
-    // 只支持黑白显示模式
-    const uint8_t* char_data = font::get_char_data(c);
-    if (!char_data) return;
-
-    for (int dy = 0; dy < font::FONT_HEIGHT; dy++) {
-        for (int dx = 0; dx < font::FONT_WIDTH; dx++) {
-            bool pixel = (char_data[dy] >> (7 - dx)) & 0x01;
-            drawPixel(x + dx, y + dy, color ? pixel : !pixel);
-        }
+    // 只支持黑白显示：color=false 时为黑底白字
+    auto draw_pixel = [this](uint16_t px, uint16_t py, bool black) { drawPixel(px, py, black); };
+    if (isMonoMode()) {
+        st73xx::text::drawChar(mono_framebuffer_, rotation_, x, y, c, color, !color, draw_pixel);
+    } else {
+        st73xx::text::drawChar(framebuffer_, rotation_, x, y, c, color, !color, draw_pixel);
     }
 }
 
 void ST7306Driver::writePointGray(uint16_t x, uint16_t y, uint8_t color) {
-    if(x >= LCD_WIDTH || y >= LCD_HEIGHT) return;
-    
-    // 原厂驱动中的详细注释:
-    // 像素数据结构为：
-    // P0P2 P4P6
-    // P1P3 P5P7
-    // 对应一个byte数据的：
-    // BIT7 BIT5 BIT3 BIT1
-    // BIT6 BIT4 BIT2 BIT0
-    
-    uint real_x = x/2; // 0->0, 1->0, 2->1, 3->1
-    uint real_y = y/2; // 0->0, 1->0, 2->1, 3->1
-    uint write_byte_index = real_y*LCD_DATA_WIDTH+real_x;
-    uint one_two = (y % 2 == 0)?0:1; // 0表示上行，1表示下行
-    uint line_bit_1 = (x % 2)*4;     // 0或4
-    uint line_bit_0 = (x % 2)*4 + 2; // 2或6
-    uint8_t write_bit_1 = 7-(line_bit_1+one_two); // 7, 6, 3, 2
-    uint8_t write_bit_0 = 7-(line_bit_0+one_two); // 5, 4, 1, 0
-
-    // 分解2位灰度值
-    bool data_bit0 = (color & 0x01) > 0;
-    bool data_bit1 = (color & 0x02) > 0;
-    
-    // 写入第一位
-    if (data_bit1) {
-        // 将指定位置的 bit 置为 1
-        display_buffer_[write_byte_index] |= (1 << write_bit_1);
-    } else {
-        // 将指定位置的 bit 置为 0
-        display_buffer_[write_byte_index] &= ~(1 << write_bit_1);
-    }
-
-    // 写入第二位
-    if (data_bit0) {
-        // 将指定位置的 bit 置为 1
-        display_buffer_[write_byte_index] |= (1 << write_bit_0);
-    } else {
-        // 将指定位置的 bit 置为 0
-        display_buffer_[write_byte_index] &= ~(1 << write_bit_0);
+    ST73XX_METRIC_PIXELS(1);
+    // 像素打包格式见 st73xx_packed_framebuffer.hpp（2x2像素/字节，灰度高位在前）
+    if (isMonoMode()) {
+        mono_framebuffer_.setPixel(x, y, color >= COLOR_GRAY2 ? 1 : 0);
+        return;
     }
+    framebuffer_.setPixel(x, y, color);
 }
 
 void ST7306Driver::drawPixelGray(uint16_t x, uint16_t y, uint8_t gray_level) {
-    uint16_t tx = x, ty = y;
-    switch (rotation_) {
-        case 1:
-            tx = LCD_WIDTH - 1 - y;
-            ty = x;
-            break;
-        case 2:
-            tx = LCD_WIDTH - 1 - x;
-            ty = LCD_HEIGHT - 1 - y;
-            break;
-        case 3:
-            tx = y;
-            ty = LCD_HEIGHT - 1 - x;
-            break;
-        default:
-            break;
-    }
-    plotPixelGrayRaw(tx, ty, gray_level);
+    Framebuffer::rotate(rotation_, x, y);
+    plotPixelGrayRaw(x, y, gray_level);
 }
 
 uint16_t ST7306Driver::getStringWidth(std::string_view str) const {
-    uint16_t width = 0;
-    for (char c : str) {
-        if (c >= 32 && c <= 126) {
-            width += font::FONT_WIDTH;
-        }
-    }
-    return width;
+    return st73xx::text::stringWidth(str);
 }
 
 void ST7306Driver::drawString(uint16_t x, uint16_t y, std::string_view str, bool color) {
-    drawString(x, y, str.data(), color);
+    st73xx::text::drawString(rotation_, x, y, str,
+        [this, color](uint16_t cx, uint16_t cy, char c) { drawChar(cx, cy, c, color); });
 }
 
 void ST7306Driver::setDisplayMode(DisplayMode mode) {
@@ -512,21 +555,22 @@ DisplayMode ST7306Driver::getDisplayMode() const {
 }
 
 void ST7306Driver::updateDisplayMode() {
+    BusGuard guard(*this);
+    st73xx::CommandBatch batch;
     switch (display_mode_) {
         case DisplayMode::Day:
             // 白底黑字模式
-            writeCommand(0x21); // Display Inversion On
-            writeCommand(0xB9); // Gamma Mode Setting
-            writeData(0x20);   // Mono mode
+            batch.command(0x21)          // Display Inversion On
+                 .command(0xB9, {0x20}); // Gamma Mode Setting: Mono mode
             break;
             
         case DisplayMode::Night:
             // 黑底白字模式
-            writeCommand(0x20); // Display Inversion Off
-            writeCommand(0xB9); // Gamma Mode Setting
-            writeData(0x20);   // Mono mode
+            batch.command(0x20)          // Display Inversion Off
+                 .command(0xB9, {0x20}); // Gamma Mode Setting: Mono mode
             break;
     }
+    writeBatch(batch);
     // 不自动刷新显示，让调用者决定何时刷新
 }
 
@@ -534,6 +578,10 @@ bool ST7306Driver::is_initialized() const {
     return initialized_;
 }
 
+bool ST7306Driver::wasWarmStart() const {
+    return warm_started_;
+}
+
 
 
 } // namespace st7306 
\ No newline at end of file
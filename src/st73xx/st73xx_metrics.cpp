@@ -0,0 +1,141 @@
+#include "st73xx_metrics.hpp"
+
+#if ST73XX_METRICS
+
+#include <cstdio>
+
+namespace st73xx {
+
+FrameCounters Metrics::current_ = {};
+FrameCounters Metrics::last_ = {};
+Metrics::Histogram Metrics::histograms_[Metrics::FIELD_COUNT];
+uint32_t Metrics::frames_ = 0;
+uint32_t Metrics::render_start_us_ = 0;
+uint32_t Metrics::flush_start_us_ = 0;
+uint8_t Metrics::flush_depth_ = 0;
+bool Metrics::frame_open_ = false;
+
+// 0~3 各占一个桶；之后每个2的幂区间 [2^k, 2^(k+1)) 按次高两位分4个桶
+uint8_t Metrics::Histogram::bucketOf(uint32_t value) {
+    if (value < 4) return static_cast<uint8_t>(value);
+    const uint8_t msb = static_cast<uint8_t>(31 - __builtin_clz(value));
+    return static_cast<uint8_t>((msb - 1) * 4 + ((value >> (msb - 2)) & 3));
+}
+
+uint32_t Metrics::Histogram::bucketUpper(uint8_t bucket) {
+    if (bucket < 4) return bucket;
+    const uint8_t msb = static_cast<uint8_t>(bucket / 4 + 1);
+    const uint64_t lower = static_cast<uint64_t>(4 + bucket % 4) << (msb - 2);
+    const uint64_t upper = lower + (1ull << (msb - 2)) - 1;
+    return upper > UINT32_MAX ? UINT32_MAX : static_cast<uint32_t>(upper);
+}
+
+void Metrics::Histogram::add(uint32_t value) {
+    count_++;
+    sum_ += value;
+    if (value < min_) min_ = value;
+    if (value > max_) max_ = value;
+
+    uint16_t& bucket = buckets_[bucketOf(value)];
+    if (bucket == UINT16_MAX) {
+        for (uint16_t& b : buckets_) b = static_cast<uint16_t>(b >> 1);
+    }
+    bucket++;
+}
+
+MetricSummary Metrics::Histogram::summary() const {
+    MetricSummary s{count_, 0, 0, 0, 0};
+    if (count_ == 0) return s;
+    s.min = min_;
+    s.max = max_;
+    s.avg = static_cast<uint32_t>(sum_ / count_);
+
+    uint32_t total = 0;
+    for (uint16_t b : buckets_) total += b;
+    // 第 ceil(0.99 * total) 个样本所在的桶
+    const uint32_t rank = total - total / 100;
+    uint32_t seen = 0;
+    for (uint8_t i = 0; i < BUCKETS; i++) {
+        seen += buckets_[i];
+        if (seen >= rank) {
+            const uint32_t upper = bucketUpper(i);
+            s.p99 = upper < max_ ? upper : max_;
+            break;
+        }
+    }
+    return s;
+}
+
+void Metrics::Histogram::clear() {
+    *this = Histogram();
+}
+
+void Metrics::flushBegin() {
+    if (flush_depth_++ > 0) return;
+    flush_start_us_ = time_us_32();
+    current_.render_us = frame_open_ ? flush_start_us_ - render_start_us_ : 0;
+}
+
+void Metrics::flushEnd() {
+    if (--flush_depth_ > 0) return;
+    current_.flush_us = time_us_32() - flush_start_us_;
+
+    const uint32_t values[FIELD_COUNT] = {
+        current_.pixels, current_.spans, current_.glyphs,
+        current_.bus_bytes, current_.render_us, current_.flush_us,
+    };
+    for (uint8_t i = 0; i < FIELD_COUNT; i++) {
+        histograms_[i].add(values[i]);
+    }
+    frames_++;
+    last_ = current_;
+    current_ = FrameCounters{};
+    frame_open_ = false;
+}
+
+void Metrics::snapshot(MetricsSnapshot& out) {
+    out.frames = frames_;
+    out.last = last_;
+    out.pixels = histograms_[Pixels].summary();
+    out.spans = histograms_[Spans].summary();
+    out.glyphs = histograms_[Glyphs].summary();
+    out.bus_bytes = histograms_[BusBytes].summary();
+    out.render_us = histograms_[RenderUs].summary();
+    out.flush_us = histograms_[FlushUs].summary();
+}
+
+void Metrics::reset() {
+    for (Histogram& h : histograms_) h.clear();
+    frames_ = 0;
+    last_ = FrameCounters{};
+}
+
+void Metrics::print() {
+    MetricsSnapshot s;
+    snapshot(s);
+    struct Row {
+        const char* name;
+        const MetricSummary& summary;
+        uint32_t last;
+    };
+    const Row rows[] = {
+        {"pixels", s.pixels, s.last.pixels},
+        {"spans", s.spans, s.last.spans},
+        {"glyphs", s.glyphs, s.last.glyphs},
+        {"bus bytes", s.bus_bytes, s.last.bus_bytes},
+        {"render us", s.render_us, s.last.render_us},
+        {"flush us", s.flush_us, s.last.flush_us},
+    };
+    printf("[metrics] %lu frames\n", static_cast<unsigned long>(s.frames));
+    printf("  %-10s %9s %9s %9s %9s %9s\n", "", "min", "avg", "max", "p99", "last");
+    for (const Row& r : rows) {
+        printf("  %-10s %9lu %9lu %9lu %9lu %9lu\n", r.name,
+               static_cast<unsigned long>(r.summary.min), static_cast<unsigned long>(r.summary.avg),
+               static_cast<unsigned long>(r.summary.max), static_cast<unsigned long>(r.summary.p99),
+               static_cast<unsigned long>(r.last));
+    }
+}
+
+} // namespace st73xx
+
+#endif // ST73XX_METRICS
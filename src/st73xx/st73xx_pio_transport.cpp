@@ -0,0 +1,164 @@
+#include "st73xx_pio_transport.hpp"
+#include "hardware/dma.h"
+#include "hardware/clocks.h"
+#include "hardware/gpio.h"
+#include "st73xx_tagged_spi.pio.h"
+#include "st73xx_trace.hpp"
+
+namespace st73xx {
+
+PioTransport::PioTransport(PIO pio, uint dc_pin, uint res_pin, uint cs_pin, uint mosi_pin, uint32_t baudrate) :
+    pio_(pio),
+    dc_pin_(dc_pin),
+    res_pin_(res_pin),
+    cs_pin_(cs_pin),
+    mosi_pin_(mosi_pin),
+    baudrate_(baudrate)
+{
+}
+
+PioTransport::~PioTransport() {
+    if (!started_) return;
+    wait();
+    pio_sm_set_enabled(pio_, sm_, false);
+    pio_remove_program(pio_, &st73xx_tagged_spi_program, offset_);
+    pio_sm_unclaim(pio_, sm_);
+    dma_channel_unclaim(dma_prefix_);
+    dma_channel_unclaim(dma_payload_);
+}
+
+bool PioTransport::begin() {
+    if (started_) return true;
+
+    // 复位脚由CPU控制，先设电平再设方向，避免热启动时误复位面板
+    gpio_init(res_pin_);
+    reset_was_high_ = gpio_get(res_pin_);  // 此时仍为输入，只有外部上拉能读到高电平
+    gpio_put(res_pin_, 1);
+    gpio_set_dir(res_pin_, GPIO_OUT);
+
+    if (!pio_can_add_program(pio_, &st73xx_tagged_spi_program)) {
+        return false;
+    }
+    int sm = pio_claim_unused_sm(pio_, false);
+    if (sm < 0) {
+        return false;
+    }
+    dma_prefix_ = dma_claim_unused_channel(false);
+    dma_payload_ = dma_claim_unused_channel(false);
+    if (dma_prefix_ < 0 || dma_payload_ < 0) {
+        if (dma_prefix_ >= 0) dma_channel_unclaim(dma_prefix_);
+        if (dma_payload_ >= 0) dma_channel_unclaim(dma_payload_);
+        pio_sm_unclaim(pio_, sm);
+        return false;
+    }
+
+    sm_ = static_cast<uint>(sm);
+    offset_ = pio_add_program(pio_, &st73xx_tagged_spi_program);
+
+    // 每个数据位2个状态机周期
+    float clkdiv = static_cast<float>(clock_get_hz(clk_sys)) / (2.0f * baudrate_);
+    if (clkdiv < 1.0f) clkdiv = 1.0f;
+    st73xx_tagged_spi_program_init(pio_, sm_, offset_, cs_pin_, mosi_pin_, dc_pin_, clkdiv);
+
+    started_ = true;
+    return true;
+}
+
+bool PioTransport::busy() const {
+    if (!started_) return false;
+    if (dma_channel_is_busy(dma_prefix_) || dma_channel_is_busy(dma_payload_)) return true;
+    if (!pio_sm_is_tx_fifo_empty(pio_, sm_)) return true;
+    // FIFO已空时，状态机停在start处的pull上才表示最后一个字节已移出且CS已拉高
+    return pio_sm_get_pc(pio_, sm_) != offset_ + st73xx_tagged_spi_offset_start;
+}
+
+void PioTransport::wait() {
+    while (busy()) {
+        tight_loop_contents();
+    }
+    if (traced_) {
+        traced_ = false;
+        ST73XX_TRACE_END(TraceEvent::BusDma);
+    }
+}
+
+bool PioTransport::writeAsync(const CommandBatch& batch, const uint8_t* payload, size_t len) {
+    if (!started_) return false;
+    if (!payload) len = 0;
+
+    // 前缀缓冲区被上一次传输的DMA占用，先等待其完成
+    wait();
+
+    size_t words = tagged::encodeBatch(batch, len, prefix_, MAX_PREFIX_WORDS);
+    if (words == 0) return false;
+
+    if (len > 0) {
+        traced_ = Trace::ENABLED;
+        ST73XX_TRACE_BEGIN(TraceEvent::BusDma);
+        startPayloadDma(payload, len, false); // 由前缀通道结束后链式触发
+    }
+    startPrefixDma(words, len > 0);
+    return true;
+}
+
+// 前缀通道：32位写入TXF；chain为true时结束后触发负载通道
+void PioTransport::startPrefixDma(size_t words, bool chain) {
+    dma_channel_config c = dma_channel_get_default_config(dma_prefix_);
+    channel_config_set_transfer_data_size(&c, DMA_SIZE_32);
+    channel_config_set_read_increment(&c, true);
+    channel_config_set_write_increment(&c, false);
+    channel_config_set_dreq(&c, pio_get_dreq(pio_, sm_, true));
+    channel_config_set_chain_to(&c, chain ? dma_payload_ : dma_prefix_); // 链接到自身即不链接
+    dma_channel_configure(dma_prefix_, &c, &pio_->txf[sm_], prefix_, words, true);
+}
+
+// 负载通道：8位写入TXF，字节会复制到[31:24]
+void PioTransport::startPayloadDma(const uint8_t* data, size_t len, bool trigger) {
+    dma_channel_config c = dma_channel_get_default_config(dma_payload_);
+    channel_config_set_transfer_data_size(&c, DMA_SIZE_8);
+    channel_config_set_read_increment(&c, true);
+    channel_config_set_write_increment(&c, false);
+    channel_config_set_dreq(&c, pio_get_dreq(pio_, sm_, true));
+    dma_channel_configure(dma_payload_, &c, &pio_->txf[sm_], data, len, trigger);
+}
+
+bool PioTransport::beginWrite(const CommandBatch& batch, size_t payload_len) {
+    if (!started_ || payload_len == 0) return false;
+    wait();
+
+    // 负载段头按总长度编码，状态机会一直等待直到所有块都送入FIFO
+    size_t words = tagged::encodeBatch(batch, payload_len, prefix_, MAX_PREFIX_WORDS);
+    if (words == 0) return false;
+    traced_ = Trace::ENABLED;
+    ST73XX_TRACE_BEGIN(TraceEvent::BusDma);
+    startPrefixDma(words, false);
+    return true;
+}
+
+void PioTransport::writeChunk(const uint8_t* data, size_t len) {
+    if (len == 0) return;
+    // 负载必须排在前缀之后；上一块的DMA读完后其缓冲区即可复用
+    dma_channel_wait_for_finish_blocking(dma_prefix_);
+    dma_channel_wait_for_finish_blocking(dma_payload_);
+    startPayloadDma(data, len, true);
+}
+
+void PioTransport::endWrite() {
+    wait();
+}
+
+void PioTransport::write(const CommandBatch& batch, const uint8_t* payload, size_t len) {
+    if (writeAsync(batch, payload, len)) {
+        wait();
+    }
+}
+
+void PioTransport::setReset(bool level) {
+    gpio_put(res_pin_, level);
+}
+
+void PioTransport::delayMs(uint32_t ms) {
+    sleep_ms(ms);
+}
+
+} // namespace st73xx
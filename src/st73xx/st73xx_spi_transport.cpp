@@ -0,0 +1,245 @@
+#include "st73xx_spi_transport.hpp"
+#include "hardware/gpio.h"
+#include "hardware/dma.h"
+#include "st73xx_trace.hpp"
+
+namespace st73xx {
+
+SpiTransport::BusState SpiTransport::bus_states_[2];
+
+SpiTransport::SpiTransport(spi_inst_t* spi, uint dc_pin, uint res_pin, uint cs_pin, uint sclk_pin, uint sdin_pin,
+                           uint32_t baudrate) :
+    spi_(spi),
+    dc_pin_(dc_pin),
+    res_pin_(res_pin),
+    cs_pin_(cs_pin),
+    sclk_pin_(sclk_pin),
+    sdin_pin_(sdin_pin),
+    baudrate_(baudrate)
+{
+}
+
+SpiTransport::~SpiTransport() {
+    BusState& state = bus();
+    if (state.owner == this) {
+        state.owner = nullptr;
+    }
+}
+
+SpiTransport::BusState& SpiTransport::bus() const {
+    return bus_states_[spi_get_index(spi_)];
+}
+
+bool SpiTransport::begin() {
+    if (started_) return true;
+
+    // 共用总线时DC也是共用的，可能正被其他面板的异步传输使用：先等它结束再重新配置
+    BusState& state = bus();
+    if (state.initialized) {
+        wait();
+    }
+
+    gpio_init(dc_pin_);
+    gpio_init(res_pin_);
+    gpio_init(cs_pin_);
+    reset_was_high_ = gpio_get(res_pin_);  // 此时仍为输入，只有外部上拉能读到高电平
+
+    // 先设电平再设方向：复位脚保持高电平，避免热启动时误复位面板；CS空闲为高
+    gpio_put(res_pin_, 1);
+    gpio_put(cs_pin_, 1);
+    gpio_put(dc_pin_, 1);
+    gpio_set_dir(dc_pin_, GPIO_OUT);
+    gpio_set_dir(res_pin_, GPIO_OUT);
+    gpio_set_dir(cs_pin_, GPIO_OUT);
+
+    // 共用总线时只由第一个传输初始化SPI，避免打断其他面板正在进行的传输
+    if (!state.initialized) {
+        spi_init(spi_, baudrate_);
+        spi_set_format(spi_, 8, SPI_CPOL_0, SPI_CPHA_0, SPI_MSB_FIRST);
+        gpio_set_function(sclk_pin_, GPIO_FUNC_SPI);
+        gpio_set_function(sdin_pin_, GPIO_FUNC_SPI);
+        state.initialized = true;
+    }
+
+    started_ = true;
+    return true;
+}
+
+void SpiTransport::acquireBus() {
+    BusState& state = bus();
+    state.writing = state.writing + 1;
+    wait();
+    state.owner = this;
+}
+
+void SpiTransport::releaseBus() {
+    BusState& state = bus();
+    state.writing = state.writing - 1;
+}
+
+bool SpiTransport::busy() const {
+    const BusState& state = bus();
+    if (state.writing) return true;
+    SpiTransport* owner = state.owner;
+    return owner && owner->transferPending();
+}
+
+void SpiTransport::wait() {
+    SpiTransport* owner = bus().owner;
+    if (owner) {
+        owner->finishTransfer();
+    }
+}
+
+// spi_write_blocking 返回时数据已移出，因此段之间可以安全地切换DC
+bool SpiTransport::writeRuns(const CommandBatch& batch) {
+    const uint8_t* bytes = batch.bytes();
+    bool dc = false;
+
+    gpio_put(dc_pin_, 0);
+    for (size_t i = 0; i < batch.runCount(); i++) {
+        const CommandBatch::Run& run = batch.run(i);
+        if (run.is_data != dc) {
+            dc = run.is_data;
+            gpio_put(dc_pin_, dc);
+        }
+        spi_write_blocking(spi_, bytes + run.offset, run.length);
+    }
+    return dc;
+}
+
+void SpiTransport::write(const CommandBatch& batch, const uint8_t* payload, size_t len) {
+    acquireBus();
+    gpio_put(cs_pin_, 0);
+    bool dc = writeRuns(batch);
+    if (payload && len > 0) {
+        if (!dc) {
+            gpio_put(dc_pin_, 1);
+        }
+        spi_write_blocking(spi_, payload, len);
+    }
+    gpio_put(cs_pin_, 1);
+    releaseBus();
+}
+
+bool SpiTransport::beginWrite(const CommandBatch& batch, size_t payload_len) {
+    (void)payload_len;
+    acquireBus();
+    gpio_put(cs_pin_, 0);
+    writeRuns(batch);
+    gpio_put(dc_pin_, 1);
+    return true;
+}
+
+void SpiTransport::writeChunk(const uint8_t* data, size_t len) {
+    spi_write_blocking(spi_, data, len);
+}
+
+void SpiTransport::endWrite() {
+    gpio_put(cs_pin_, 1);
+    releaseBus();
+}
+
+void SpiTransport::setReset(bool level) {
+    gpio_put(res_pin_, level);
+}
+
+void SpiTransport::delayMs(uint32_t ms) {
+    sleep_ms(ms);
+}
+
+DmaSpiTransport::~DmaSpiTransport() {
+    if (dma_channel_ >= 0) {
+        finishTransfer();
+        dma_channel_unclaim(dma_channel_);
+    }
+}
+
+bool DmaSpiTransport::begin() {
+    if (!SpiTransport::begin()) return false;
+    if (dma_channel_ < 0) {
+        dma_channel_ = dma_claim_unused_channel(false);
+    }
+    return dma_channel_ >= 0;
+}
+
+bool DmaSpiTransport::transferPending() const {
+    return pending_ && (dma_channel_is_busy(dma_channel_) || spi_is_busy(spi_));
+}
+
+void DmaSpiTransport::finishTransfer() {
+    if (!pending_) return;
+    dma_channel_wait_for_finish_blocking(dma_channel_);
+    while (spi_is_busy(spi_)) {
+        tight_loop_contents();
+    }
+    // DMA只写不读，清空接收FIFO和溢出标志，否则下一次阻塞写会读到旧数据
+    while (spi_is_readable(spi_)) {
+        (void)spi_get_hw(spi_)->dr;
+    }
+    spi_get_hw(spi_)->icr = SPI_SSPICR_RORIC_BITS;
+    gpio_put(cs_pin_, 1);
+    pending_ = false;
+    ST73XX_TRACE_END(TraceEvent::BusDma);
+}
+
+bool DmaSpiTransport::writeAsync(const CommandBatch& batch, const uint8_t* payload, size_t len) {
+    if (dma_channel_ < 0) return false;
+
+    acquireBus();
+    gpio_put(cs_pin_, 0);
+    bool dc = writeRuns(batch);
+    if (!payload || len == 0) {
+        gpio_put(cs_pin_, 1);
+        releaseBus();
+        return true;
+    }
+    if (!dc) {
+        gpio_put(dc_pin_, 1);
+    }
+
+    pending_ = true;
+    ST73XX_TRACE_BEGIN(TraceEvent::BusDma);
+    startDma(payload, len);
+    releaseBus();
+    return true;
+}
+
+void DmaSpiTransport::startDma(const uint8_t* data, size_t len) {
+    dma_channel_config c = dma_channel_get_default_config(dma_channel_);
+    channel_config_set_transfer_data_size(&c, DMA_SIZE_8);
+    channel_config_set_read_increment(&c, true);
+    channel_config_set_write_increment(&c, false);
+    channel_config_set_dreq(&c, spi_get_dreq(spi_, true));
+    dma_channel_configure(dma_channel_, &c, &spi_get_hw(spi_)->dr, data, len, true);
+}
+
+// 分块发送：等上一块的DMA读完即可启动下一块（SPI FIFO中的尾部字节会继续移出）
+void DmaSpiTransport::writeChunk(const uint8_t* data, size_t len) {
+    if (dma_channel_ < 0) {
+        SpiTransport::writeChunk(data, len);
+        return;
+    }
+    dma_channel_wait_for_finish_blocking(dma_channel_);
+    if (!pending_) {
+        ST73XX_TRACE_BEGIN(TraceEvent::BusDma);  // 分块发送整体记为一次传输，在 finishTransfer() 结束
+    }
+    pending_ = true;
+    startDma(data, len);
+}
+
+void DmaSpiTransport::endWrite() {
+    finishTransfer();
+    gpio_put(cs_pin_, 1);
+    releaseBus();
+}
+
+void DmaSpiTransport::write(const CommandBatch& batch, const uint8_t* payload, size_t len) {
+    if (!writeAsync(batch, payload, len)) {
+        SpiTransport::write(batch, payload, len); // 未申请到DMA通道时退回阻塞发送
+        return;
+    }
+    wait();
+}
+
+} // namespace st73xx
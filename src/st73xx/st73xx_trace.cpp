@@ -0,0 +1,94 @@
+#include "st73xx_trace.hpp"
+
+#if ST73XX_TRACE
+
+#include <cstdio>
+#include <cstring>
+
+namespace st73xx {
+
+Trace::Ring Trace::rings_[Trace::CORES] = {};
+volatile bool Trace::recording_ = true;
+
+const char* Trace::names_[TRACE_MAX_EVENTS] = {
+    nullptr, "render", "flush", "bus dma", "input sample", "net poll",
+};
+
+namespace {
+
+void putU8(uint8_t v) {
+    putchar_raw(v);
+}
+
+void putU16(uint16_t v) {
+    putU8(static_cast<uint8_t>(v));
+    putU8(static_cast<uint8_t>(v >> 8));
+}
+
+void putU32(uint32_t v) {
+    putU16(static_cast<uint16_t>(v));
+    putU16(static_cast<uint16_t>(v >> 16));
+}
+
+} // namespace
+
+void Trace::nameEvent(TraceEvent event, const char* name) {
+    const uint8_t id = static_cast<uint8_t>(event);
+    if (id > 0 && id < TRACE_MAX_EVENTS) names_[id] = name;
+}
+
+void Trace::clear() {
+    for (Ring& ring : rings_) ring.head = 0;
+}
+
+// 暂停记录后按格式写出；另一个核若恰好正在写一条记录，这一条可能不完整
+void Trace::dump(bool clear) {
+    const bool was_recording = recording_;
+    recording_ = false;
+
+    uint8_t name_count = 0;
+    for (const char* name : names_) {
+        if (name) name_count++;
+    }
+    const uint64_t now = time_us_64();
+
+    for (uint8_t b : TRACE_DUMP_MAGIC) putU8(b);
+    putU8(TRACE_DUMP_VERSION);
+    putU8(CORES);
+    putU8(name_count);
+    putU8(0);
+    putU32(CAPACITY);
+    putU32(static_cast<uint32_t>(now));
+    putU32(static_cast<uint32_t>(now >> 32));
+
+    for (uint8_t id = 0; id < TRACE_MAX_EVENTS; id++) {
+        if (!names_[id]) continue;
+        const size_t len = strlen(names_[id]);
+        const uint8_t n = static_cast<uint8_t>(len > 255 ? 255 : len);
+        putU8(id);
+        putU8(n);
+        for (uint8_t i = 0; i < n; i++) putU8(static_cast<uint8_t>(names_[id][i]));
+    }
+
+    for (const Ring& ring : rings_) {
+        const uint32_t head = ring.head;
+        const uint32_t count = head < CAPACITY ? head : CAPACITY;
+        putU32(count);
+        putU32(head - count);
+        for (uint32_t i = head - count; i != head; i++) {
+            const TraceRecord& r = ring.records[i & (CAPACITY - 1)];
+            putU32(r.timestamp_us);
+            putU8(r.event);
+            putU8(r.phase);
+            putU16(r.arg);
+        }
+    }
+    stdio_flush();
+
+    if (clear) Trace::clear();
+    recording_ = was_recording;
+}
+
+} // namespace st73xx
+
+#endif // ST73XX_TRACE
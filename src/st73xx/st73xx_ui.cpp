@@ -1,6 +1,7 @@
 #include "st73xx_ui.hpp"
 #include <cstdlib>
 #include "gfx_colors.hpp"
+#include "st73xx_metrics.hpp"
 
 #define ABS_DIFF(x, y) (((x) > (y))? ((x) - (y)) : ((y) - (x)))
 
@@ -8,7 +9,9 @@
 #define min(a, b) ((a) < (b) ? (a) : (b))
 #endif
 
-ST73XX_UI::ST73XX_UI(int16_t w, int16_t h) : WIDTH(w), HEIGHT(h), _width(w), _height(h), rotation_(0) {}
+ST73XX_UI::ST73XX_UI(int16_t w, int16_t h) : WIDTH(w), HEIGHT(h), _width(w), _height(h), rotation_(0) {
+    resetClip();
+}
 ST73XX_UI::~ST73XX_UI() {}
 
 void ST73XX_UI::writePoint(uint x, uint y, bool enabled) {
@@ -19,132 +22,276 @@ void ST73XX_UI::writePoint(uint x, uint y, uint16_t color) {
     // 需由子类实现
 }
 
-void ST73XX_UI::drawPixel(int16_t x, int16_t y, bool enabled) {
-    if ((x >= 0) && (x < WIDTH) && (y >= 0) && (y < HEIGHT)) {
-        int16_t tx = x, ty = y;
-        switch (rotation_) {
-        case 1:
-            tx = y;
-            ty = _width - 1 - x;
-            break;
-        case 2:
-            tx = _width - 1 - x;
-            ty = _height - 1 - y;
-            break;
-        case 3:
-            tx = _height - 1 - y;
-            ty = x;
-            break;
+void ST73XX_UI::writeRect(uint x, uint y, uint w, uint h, uint16_t color) {
+    for (uint j = 0; j < h; j++) {
+        for (uint i = 0; i < w; i++) {
+            writePoint(x + i, y + j, color);
         }
-        writePoint(static_cast<uint>(tx), static_cast<uint>(ty), enabled);
     }
 }
 
-void ST73XX_UI::drawPixel(int16_t x, int16_t y, uint16_t color) {
-    if ((x >= 0) && (x < WIDTH) && (y >= 0) && (y < HEIGHT)) {
-        int16_t tx = x, ty = y;
-        switch (rotation_) {
-        case 1:
-            tx = y;
-            ty = _width - 1 - x;
-            break;
-        case 2:
-            tx = _width - 1 - x;
-            ty = _height - 1 - y;
-            break;
-        case 3:
-            tx = _height - 1 - y;
-            ty = x;
-            break;
-        }
-        writePoint(static_cast<uint>(tx), static_cast<uint>(ty), color);
+// ===== 裁剪与视口 =====
+
+void ST73XX_UI::resetClip() {
+    clip_depth_ = 0;
+    clip_ = ClipState{0, 0, WIDTH, HEIGHT, 0, 0};
+}
+
+bool ST73XX_UI::pushClipRect(int16_t x, int16_t y, int16_t w, int16_t h) {
+    if (clip_depth_ >= CLIP_STACK_DEPTH) return false;
+    clip_stack_[clip_depth_++] = clip_;
+
+    int32_t ax0 = static_cast<int32_t>(x) + clip_.origin_x;
+    int32_t ay0 = static_cast<int32_t>(y) + clip_.origin_y;
+    int32_t ax1 = ax0 + (w > 0 ? w : 0);
+    int32_t ay1 = ay0 + (h > 0 ? h : 0);
+    if (ax0 < clip_.x0) ax0 = clip_.x0;
+    if (ay0 < clip_.y0) ay0 = clip_.y0;
+    if (ax1 > clip_.x1) ax1 = clip_.x1;
+    if (ay1 > clip_.y1) ay1 = clip_.y1;
+    // 空交集保留为零面积矩形，之后的绘制全部被拒绝
+    if (ax1 < ax0) ax1 = ax0;
+    if (ay1 < ay0) ay1 = ay0;
+    clip_.x0 = static_cast<int16_t>(ax0);
+    clip_.y0 = static_cast<int16_t>(ay0);
+    clip_.x1 = static_cast<int16_t>(ax1);
+    clip_.y1 = static_cast<int16_t>(ay1);
+    return true;
+}
+
+bool ST73XX_UI::pushViewport(int16_t x, int16_t y, int16_t w, int16_t h) {
+    if (!pushClipRect(x, y, w, h)) return false;
+    clip_.origin_x = static_cast<int16_t>(clip_.origin_x + x);
+    clip_.origin_y = static_cast<int16_t>(clip_.origin_y + y);
+    return true;
+}
+
+void ST73XX_UI::popClip() {
+    if (clip_depth_ > 0) {
+        clip_ = clip_stack_[--clip_depth_];
     }
 }
 
-void ST73XX_UI::drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color) {
-    int16_t phy_x = x, phy_y = y;
-    int16_t phy_w = w;
-    bool horizontal_after_rotation = true;
+void ST73XX_UI::setOrigin(int16_t x, int16_t y) {
+    clip_.origin_x = x;
+    clip_.origin_y = y;
+}
+
+int16_t ST73XX_UI::originX() const {
+    return clip_.origin_x;
+}
+
+int16_t ST73XX_UI::originY() const {
+    return clip_.origin_y;
+}
+
+void ST73XX_UI::getClipRect(int16_t& x, int16_t& y, int16_t& w, int16_t& h) const {
+    x = static_cast<int16_t>(clip_.x0 - clip_.origin_x);
+    y = static_cast<int16_t>(clip_.y0 - clip_.origin_y);
+    w = static_cast<int16_t>(clip_.x1 - clip_.x0);
+    h = static_cast<int16_t>(clip_.y1 - clip_.y0);
+}
 
+bool ST73XX_UI::isClippedOut(int16_t x, int16_t y, int16_t w, int16_t h) const {
+    if (w <= 0 || h <= 0) return true;
+    int32_t ax = static_cast<int32_t>(x) + clip_.origin_x;
+    int32_t ay = static_cast<int32_t>(y) + clip_.origin_y;
+    return ax >= clip_.x1 || ay >= clip_.y1 || ax + w <= clip_.x0 || ay + h <= clip_.y0;
+}
+
+// 屏幕逻辑坐标 -> 物理坐标
+void ST73XX_UI::toPhysical(int32_t x, int32_t y, int16_t& tx, int16_t& ty) const {
     switch (rotation_) {
-        case 0:
-            break;
-        case 1:
-            phy_x = y;
-            phy_y = _width - 1 - (x + w -1);
-            phy_w = w;
-            horizontal_after_rotation = false;
-            value_interchange(phy_x, phy_y);
-            phy_x = _width -1 -x;
-            drawLine(x,y, x + w -1, y, color); return;
-        case 2:
-            phy_x = _width - 1 - (x + w - 1);
-            phy_y = _height - 1 - y;
-            break;
-        case 3:
-            drawLine(x,y, x + w -1, y, color); return;
+    case 1:
+        tx = static_cast<int16_t>(y);
+        ty = static_cast<int16_t>(_height - 1 - x);
+        break;
+    case 2:
+        tx = static_cast<int16_t>(_width - 1 - x);
+        ty = static_cast<int16_t>(_height - 1 - y);
+        break;
+    case 3:
+        tx = static_cast<int16_t>(_width - 1 - y);
+        ty = static_cast<int16_t>(x);
+        break;
+    default:
+        tx = static_cast<int16_t>(x);
+        ty = static_cast<int16_t>(y);
+        break;
     }
-    if (rotation_ == 0 || rotation_ == 2) {
-        for (int16_t i = 0; i < phy_w; i++) {
-            writePoint(static_cast<uint>(phy_x + i), static_cast<uint>(phy_y), color);
-        }
-    } else {
-        drawLine(x, y, x + w - 1, y, color);
+}
+
+bool ST73XX_UI::mapPoint(int16_t x, int16_t y, int16_t& tx, int16_t& ty) const {
+    int32_t ax = static_cast<int32_t>(x) + clip_.origin_x;
+    int32_t ay = static_cast<int32_t>(y) + clip_.origin_y;
+    if (ax < clip_.x0 || ax >= clip_.x1 || ay < clip_.y0 || ay >= clip_.y1) return false;
+    toPhysical(ax, ay, tx, ty);
+    return true;
+}
+
+void ST73XX_UI::plotClipped(int32_t x, int32_t y, uint16_t color) {
+    int16_t tx, ty;
+    toPhysical(x, y, tx, ty);
+    writePoint(static_cast<uint>(tx), static_cast<uint>(ty), color);
+}
+
+// 与裁剪区求交后整块交给 writeRect；旋转后矩形仍是矩形，只需变换两个角
+void ST73XX_UI::fillClipped(int32_t x0, int32_t y0, int32_t x1, int32_t y1, uint16_t color) {
+    if (x0 < clip_.x0) x0 = clip_.x0;
+    if (y0 < clip_.y0) y0 = clip_.y0;
+    if (x1 > clip_.x1) x1 = clip_.x1;
+    if (y1 > clip_.y1) y1 = clip_.y1;
+    if (x0 >= x1 || y0 >= y1) return;
+
+    uint w = static_cast<uint>(x1 - x0);
+    uint h = static_cast<uint>(y1 - y0);
+    switch (rotation_) {
+    case 1:
+        writeRect(static_cast<uint>(y0), static_cast<uint>(_height - x1), h, w, color);
+        break;
+    case 2:
+        writeRect(static_cast<uint>(_width - x1), static_cast<uint>(_height - y1), w, h, color);
+        break;
+    case 3:
+        writeRect(static_cast<uint>(_width - y1), static_cast<uint>(x0), h, w, color);
+        break;
+    default:
+        writeRect(static_cast<uint>(x0), static_cast<uint>(y0), w, h, color);
+        break;
     }
 }
 
-void ST73XX_UI::drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color) {
-    if (rotation_ == 0 || rotation_ == 2) {
-        int16_t phy_x = x, phy_y = y;
-        if (rotation_ == 2) {
-            phy_x = _width - 1 - x;
-            phy_y = _height - 1 - (y + h - 1);
+// Cohen-Sutherland 区域码
+namespace {
+constexpr uint8_t OUT_LEFT = 1;
+constexpr uint8_t OUT_RIGHT = 2;
+constexpr uint8_t OUT_TOP = 4;
+constexpr uint8_t OUT_BOTTOM = 8;
+
+// 四舍五入的整数除法，使裁剪后的端点尽量贴近原直线（乘积可能超出int32）
+int32_t divRound(int64_t num, int32_t den) {
+    if (den < 0) { num = -num; den = -den; }
+    return static_cast<int32_t>((num >= 0) ? (num + den / 2) / den : -((-num + den / 2) / den));
+}
+} // namespace
+
+uint8_t ST73XX_UI::outCode(int32_t x, int32_t y) const {
+    uint8_t code = 0;
+    if (x < clip_.x0) code |= OUT_LEFT;
+    else if (x >= clip_.x1) code |= OUT_RIGHT;
+    if (y < clip_.y0) code |= OUT_TOP;
+    else if (y >= clip_.y1) code |= OUT_BOTTOM;
+    return code;
+}
+
+// 把线段裁剪到裁剪区内；完全不可见时返回false
+bool ST73XX_UI::clipLine(int32_t& x0, int32_t& y0, int32_t& x1, int32_t& y1) const {
+    if (clip_.x0 >= clip_.x1 || clip_.y0 >= clip_.y1) return false;
+    const int32_t xmin = clip_.x0, xmax = clip_.x1 - 1;
+    const int32_t ymin = clip_.y0, ymax = clip_.y1 - 1;
+
+    uint8_t code0 = outCode(x0, y0);
+    uint8_t code1 = outCode(x1, y1);
+    while (true) {
+        if (!(code0 | code1)) return true;   // 两端都在区域内
+        if (code0 & code1) return false;     // 两端在同一侧之外
+
+        uint8_t out = code0 ? code0 : code1;
+        int32_t x, y;
+        if (out & OUT_BOTTOM) {
+            x = x0 + divRound(static_cast<int64_t>(x1 - x0) * (ymax - y0), y1 - y0);
+            y = ymax;
+        } else if (out & OUT_TOP) {
+            x = x0 + divRound(static_cast<int64_t>(x1 - x0) * (ymin - y0), y1 - y0);
+            y = ymin;
+        } else if (out & OUT_RIGHT) {
+            y = y0 + divRound(static_cast<int64_t>(y1 - y0) * (xmax - x0), x1 - x0);
+            x = xmax;
+        } else {
+            y = y0 + divRound(static_cast<int64_t>(y1 - y0) * (xmin - x0), x1 - x0);
+            x = xmin;
         }
-         for (int16_t i = 0; i < h; i++) {
-            writePoint(static_cast<uint>(phy_x), static_cast<uint>(phy_y + i), color);
+
+        if (out == code0) {
+            x0 = x; y0 = y;
+            code0 = outCode(x0, y0);
+        } else {
+            x1 = x; y1 = y;
+            code1 = outCode(x1, y1);
         }
-    } else {
-        drawLine(x, y, x, y + h - 1, color);
     }
 }
 
-void ST73XX_UI::drawLine(int16_t x0, int16_t y0, int16_t x1, int16_t y1, uint16_t color) {
-    if ((x0 == x1) && (y0 == y1)) {
-        drawPixel(x0, y0, color);
-        return;
+// ===== 图元 =====
+
+void ST73XX_UI::drawPixel(int16_t x, int16_t y, bool enabled) {
+    int16_t tx, ty;
+    if (mapPoint(x, y, tx, ty)) {
+        writePoint(static_cast<uint>(tx), static_cast<uint>(ty), enabled);
+    }
+}
+
+void ST73XX_UI::drawPixel(int16_t x, int16_t y, uint16_t color) {
+    int16_t tx, ty;
+    if (mapPoint(x, y, tx, ty)) {
+        writePoint(static_cast<uint>(tx), static_cast<uint>(ty), color);
     }
-    if (x0 == x1) {
-        if (y0 > y1) value_interchange(y0, y1);
-        drawFastVLine(x0,y0, y1-y0+1, color);
+}
+
+void ST73XX_UI::drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color) {
+    if (w <= 0) return;
+    int32_t ax = static_cast<int32_t>(x) + clip_.origin_x;
+    int32_t ay = static_cast<int32_t>(y) + clip_.origin_y;
+    fillClipped(ax, ay, ax + w, ay + 1, color);
+}
+
+void ST73XX_UI::drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color) {
+    if (h <= 0) return;
+    int32_t ax = static_cast<int32_t>(x) + clip_.origin_x;
+    int32_t ay = static_cast<int32_t>(y) + clip_.origin_y;
+    fillClipped(ax, ay, ax + 1, ay + h, color);
+}
+
+void ST73XX_UI::drawLine(int16_t x0, int16_t y0, int16_t x1, int16_t y1, uint16_t color) {
+    int32_t ax0 = static_cast<int32_t>(x0) + clip_.origin_x;
+    int32_t ay0 = static_cast<int32_t>(y0) + clip_.origin_y;
+    int32_t ax1 = static_cast<int32_t>(x1) + clip_.origin_x;
+    int32_t ay1 = static_cast<int32_t>(y1) + clip_.origin_y;
+    if (!clipLine(ax0, ay0, ax1, ay1)) return;
+
+    if (ay0 == ay1) {
+        if (ax0 > ax1) value_interchange(ax0, ax1);
+        fillClipped(ax0, ay0, ax1 + 1, ay0 + 1, color);
         return;
     }
-    if (y0 == y1) {
-        if (x0 > x1) value_interchange(x0, x1);
-        drawFastHLine(x0,y0, x1-x0+1, color);
+    if (ax0 == ax1) {
+        if (ay0 > ay1) value_interchange(ay0, ay1);
+        fillClipped(ax0, ay0, ax0 + 1, ay1 + 1, color);
         return;
     }
 
-    bool steep = ABS_DIFF(y1, y0) > ABS_DIFF(x1, x0);
+    // 两端都已在裁剪区内，Bresenham 走过的点不会越界，无需逐点检查
+    bool steep = ABS_DIFF(ay1, ay0) > ABS_DIFF(ax1, ax0);
     if (steep) {
-        value_interchange(x0, y0);
-        value_interchange(x1, y1);
+        value_interchange(ax0, ay0);
+        value_interchange(ax1, ay1);
     }
-    if (x0 > x1) {
-        value_interchange(x0, x1);
-        value_interchange(y0, y1);
+    if (ax0 > ax1) {
+        value_interchange(ax0, ax1);
+        value_interchange(ay0, ay1);
     }
 
-    int16_t dx = x1 - x0;
-    int16_t dy = ABS_DIFF(y1, y0);
-    int16_t err = dx / 2;
-    int16_t ystep = (y0 < y1) ? 1 : -1;
-    int16_t y = y0;
+    int32_t dx = ax1 - ax0;
+    int32_t dy = ABS_DIFF(ay1, ay0);
+    int32_t err = dx / 2;
+    int32_t ystep = (ay0 < ay1) ? 1 : -1;
+    int32_t y = ay0;
 
-    for (int16_t x = x0; x <= x1; x++) {
+    for (int32_t x = ax0; x <= ax1; x++) {
         if (steep) {
-            drawPixel(y, x, color);
+            plotClipped(y, x, color);
         } else {
-            drawPixel(x, y, color);
+            plotClipped(x, y, color);
         }
         err -= dy;
         if (err < 0) {
@@ -166,6 +313,11 @@ void ST73XX_UI::drawFilledTriangle(int16_t x0, int16_t y0, int16_t x1, int16_t y
     if (y1 > y2) { value_interchange(y2, y1); value_interchange(x2, x1); }
     if (y0 > y1) { value_interchange(y0, y1); value_interchange(x0, x1); }
 
+    // 包围盒完全不可见时直接返回
+    int16_t minx = x0 < x1 ? (x0 < x2 ? x0 : x2) : (x1 < x2 ? x1 : x2);
+    int16_t maxx = x0 > x1 ? (x0 > x2 ? x0 : x2) : (x1 > x2 ? x1 : x2);
+    if (isClippedOut(minx, y0, maxx - minx + 1, y2 - y0 + 1)) return;
+
     if (y0 == y2) {
         a = b = x0;
         if (x1 < a) a = x1;
@@ -219,6 +371,45 @@ void ST73XX_UI::drawFilledRectangle(int16_t x, int16_t y, int16_t w, int16_t h,
 
 void ST73XX_UI::drawCircle(int16_t x0, int16_t y0, int16_t r, uint16_t color) {
     if (r < 0) return;
+    if (isClippedOut(x0 - r, y0 - r, 2 * r + 1, 2 * r + 1)) return;
+
+    // 整个圆都在裁剪区内时跳过逐点检查
+    int32_t cx = static_cast<int32_t>(x0) + clip_.origin_x;
+    int32_t cy = static_cast<int32_t>(y0) + clip_.origin_y;
+    bool inside = cx - r >= clip_.x0 && cx + r < clip_.x1 && cy - r >= clip_.y0 && cy + r < clip_.y1;
+    if (inside) {
+        int16_t f = 1 - r;
+        int16_t ddF_x = 1;
+        int16_t ddF_y = -2 * r;
+        int16_t x = 0;
+        int16_t y = r;
+
+        plotClipped(cx, cy + r, color);
+        plotClipped(cx, cy - r, color);
+        plotClipped(cx + r, cy, color);
+        plotClipped(cx - r, cy, color);
+
+        while (x < y) {
+            if (f >= 0) {
+                y--;
+                ddF_y += 2;
+                f += ddF_y;
+            }
+            x++;
+            ddF_x += 2;
+            f += ddF_x;
+            plotClipped(cx + x, cy + y, color);
+            plotClipped(cx - x, cy + y, color);
+            plotClipped(cx + x, cy - y, color);
+            plotClipped(cx - x, cy - y, color);
+            plotClipped(cx + y, cy + x, color);
+            plotClipped(cx - y, cy + x, color);
+            plotClipped(cx + y, cy - x, color);
+            plotClipped(cx - y, cy - x, color);
+        }
+        return;
+    }
+
     int16_t f = 1 - r;
     int16_t ddF_x = 1;
     int16_t ddF_y = -2 * r;
@@ -252,6 +443,7 @@ void ST73XX_UI::drawCircle(int16_t x0, int16_t y0, int16_t r, uint16_t color) {
 
 void ST73XX_UI::drawFilledCircle(int16_t x0, int16_t y0, int16_t r, uint16_t color) {
     if (r < 0) return;
+    if (isClippedOut(x0 - r, y0 - r, 2 * r + 1, 2 * r + 1)) return;
     drawFastVLine(x0, y0 - r, 2 * r + 1, color);
     int16_t f = 1 - r;
     int16_t ddF_x = 1;
@@ -276,6 +468,14 @@ void ST73XX_UI::drawFilledCircle(int16_t x0, int16_t y0, int16_t r, uint16_t col
     }
 }
 
+void ST73XX_UI::drawRadialLine(int16_t cx, int16_t cy, int16_t r0, int16_t r1, st73xx::Angle angle, uint16_t color) {
+    int32_t c = st73xx::cosQ15(angle);
+    int32_t s = st73xx::sinQ15(angle);
+    drawLine(static_cast<int16_t>(cx + st73xx::mulQ15(r0, c)), static_cast<int16_t>(cy + st73xx::mulQ15(r0, s)),
+             static_cast<int16_t>(cx + st73xx::mulQ15(r1, c)), static_cast<int16_t>(cy + st73xx::mulQ15(r1, s)),
+             color);
+}
+
 void ST73XX_UI::drawPolygon(const int16_t *x, const int16_t *y, uint8_t sides, uint16_t color) {
     if (sides < 3) return;
     for (uint8_t i = 0; i < sides - 1; i++) {
@@ -284,53 +484,181 @@ void ST73XX_UI::drawPolygon(const int16_t *x, const int16_t *y, uint8_t sides, u
     drawLine(x[sides-1], y[sides-1], x[0], y[0], color);
 }
 
+namespace {
+
+// 16.16定点斜率；常见的小 dx 走32位除法
+int64_t edgeSlope(int32_t dx, int32_t dy) {
+    if (dx > -32768 && dx < 32768) {
+        return (dx * 65536) / dy;
+    }
+    return (static_cast<int64_t>(dx) * 65536) / dy;
+}
+
+} // namespace
+
+// 回退路径：边数超出边表容量时，每条扫描线重新遍历全部边求交点。
+// 交点的定点取整与活动边表逐行累加的结果完全相同，只是每行都要遍历所有边。
+void ST73XX_UI::fillPolygonScanlines(const int16_t *vx, const int16_t *vy, uint8_t sides, uint16_t color) {
+    int32_t y_min = clip_.y1;
+    int32_t y_max = clip_.y0;
+    for (uint8_t i = 0; i < sides; i++) {
+        int32_t y = static_cast<int32_t>(vy[i]) + clip_.origin_y;
+        if (y < y_min) y_min = y;
+        if (y > y_max) y_max = y;
+    }
+    if (y_min < clip_.y0) y_min = clip_.y0;
+    if (y_max > clip_.y1) y_max = clip_.y1;
+
+    int32_t* xs = polygon_.crossings;
+    for (int32_t y = y_min; y < y_max; y++) {
+        uint8_t n = 0;
+        for (uint8_t i = 0, j = sides - 1; i < sides; j = i++) {
+            int32_t x0 = static_cast<int32_t>(vx[j]) + clip_.origin_x;
+            int32_t y0 = static_cast<int32_t>(vy[j]) + clip_.origin_y;
+            int32_t x1 = static_cast<int32_t>(vx[i]) + clip_.origin_x;
+            int32_t y1 = static_cast<int32_t>(vy[i]) + clip_.origin_y;
+            if (y0 == y1) continue;
+            if (y0 > y1) {
+                value_interchange(x0, x1);
+                value_interchange(y0, y1);
+            }
+            if (y < y0 || y >= y1) continue;
+            int64_t x = static_cast<int64_t>(x0) * 65536 + 0x8000 + edgeSlope(x1 - x0, y1 - y0) * (y - y0);
+            xs[n++] = static_cast<int32_t>(x >> 16);
+        }
+
+        for (uint8_t k = 1; k < n; k++) {
+            int32_t x = xs[k];
+            uint8_t m = k;
+            while (m > 0 && xs[m - 1] > x) {
+                xs[m] = xs[m - 1];
+                m--;
+            }
+            xs[m] = x;
+        }
+        for (uint8_t k = 0; k + 1 < n; k += 2) {
+            fillClipped(xs[k], y, xs[k + 1] + 1, y + 1, color);
+        }
+    }
+}
+
 void ST73XX_UI::drawFilledPolygon(const int16_t *vx, const int16_t *vy, uint8_t sides, uint16_t color) {
     if (sides < 3) return;
-    int16_t i, j, miny, maxy, x1, y1, x2, y2, ind1, ind2;
-    miny = vy[0]; maxy = vy[0];
-    for (i = 1; i < sides; i++) {
-        if (vy[i] < miny) miny = vy[i];
-        if (vy[i] > maxy) maxy = vy[i];
+    if (clip_.x0 >= clip_.x1 || clip_.y0 >= clip_.y1) return;
+
+    // 建立边表：水平边不产生交点，完全在裁剪区上方或下方的边不会被用到
+    PolygonEdge* edges = polygon_.table.edges;
+    uint8_t count = 0;
+    for (uint8_t i = 0, j = sides - 1; i < sides; j = i++) {
+        int32_t x0 = static_cast<int32_t>(vx[j]) + clip_.origin_x;
+        int32_t y0 = static_cast<int32_t>(vy[j]) + clip_.origin_y;
+        int32_t x1 = static_cast<int32_t>(vx[i]) + clip_.origin_x;
+        int32_t y1 = static_cast<int32_t>(vy[i]) + clip_.origin_y;
+        if (y0 == y1) continue;
+        if (y0 > y1) {
+            value_interchange(x0, x1);
+            value_interchange(y0, y1);
+        }
+        if (y1 <= clip_.y0 || y0 >= clip_.y1) continue;
+        if (count >= ST73XX_UI_MAX_POLYGON_EDGES) {
+            fillPolygonScanlines(vx, vy, sides, color);
+            return;
+        }
+
+        PolygonEdge& e = edges[count++];
+        e.dxdy = edgeSlope(x1 - x0, y1 - y0);
+        e.x = static_cast<int64_t>(x0) * 65536 + 0x8000;
+        e.y_top = y0;
+        e.y_end = y1;
     }
-    int16_t *nodeX = new int16_t[sides];
-    for (int16_t y = miny; y <= maxy; y++) {
-        int nodes = 0;
-        j = sides - 1;
-        for (i = 0; i < sides; i++) {
-            y1 = vy[i]; y2 = vy[j];
-            if (((y1 <= y) && (y2 > y)) || ((y2 <= y) && (y1 > y))) {
-                x1 = vx[i]; x2 = vx[j];
-                nodeX[nodes++] = (int16_t)(x1 + (float)(y - y1) / (y2 - y1) * (x2 - x1));
+    if (count < 2) return;
+
+    // 按首条扫描线排序（插入排序，边数很少）
+    for (uint8_t i = 1; i < count; i++) {
+        PolygonEdge e = edges[i];
+        uint8_t k = i;
+        while (k > 0 && edges[k - 1].y_top > e.y_top) {
+            edges[k] = edges[k - 1];
+            k--;
+        }
+        edges[k] = e;
+    }
+
+    int32_t y_last = clip_.y0;
+    for (uint8_t i = 0; i < count; i++) {
+        if (edges[i].y_end > y_last) y_last = edges[i].y_end;
+    }
+    if (y_last > clip_.y1) y_last = clip_.y1;
+
+    uint8_t* active = polygon_.table.active;
+    uint8_t active_count = 0;
+    uint8_t next = 0;
+    int32_t y = edges[0].y_top > clip_.y0 ? edges[0].y_top : clip_.y0;
+
+    for (; y < y_last; y++) {
+        // 移除已结束的边
+        uint8_t kept = 0;
+        for (uint8_t k = 0; k < active_count; k++) {
+            if (edges[active[k]].y_end > y) {
+                active[kept++] = active[k];
             }
-            j = i;
         }
-        for(i=0; i<nodes-1; ++i) {
-            for(j=0; j<nodes-i-1; ++j) {
-                if(nodeX[j] > nodeX[j+1]) {
-                    value_interchange(nodeX[j], nodeX[j+1]);
+        active_count = kept;
+
+        // 激活新边；起点在裁剪区上方的边直接前进到当前行
+        while (next < count && edges[next].y_top <= y) {
+            PolygonEdge& e = edges[next];
+            if (e.y_end > y) {
+                if (e.y_top < y) {
+                    e.x += e.dxdy * (y - e.y_top);
                 }
+                active[active_count++] = next;
             }
+            next++;
         }
-        for (i = 0; i < nodes; i += 2) {
-            if (nodeX[i] >= WIDTH) break;
-            if (nodeX[i+1] > 0) {
-                if (nodeX[i] < 0) nodeX[i] = 0;
-                if (nodeX[i+1] > WIDTH) nodeX[i+1] = WIDTH;
-                drawFastHLine(nodeX[i], y, nodeX[i+1] - nodeX[i] + 1, color);
+
+        if (active_count == 0) {
+            if (next >= count) break;
+            y = edges[next].y_top - 1; // 跳过多边形中间的空行
+            continue;
+        }
+
+        // 按交点排序：相邻扫描线的顺序几乎不变，插入排序接近线性
+        for (uint8_t k = 1; k < active_count; k++) {
+            uint8_t idx = active[k];
+            int64_t x = edges[idx].x;
+            uint8_t m = k;
+            while (m > 0 && edges[active[m - 1]].x > x) {
+                active[m] = active[m - 1];
+                m--;
             }
+            active[m] = idx;
+        }
+
+        // 奇偶规则：成对的交点之间为内部，span 直接走矩形填充路径
+        for (uint8_t k = 0; k + 1 < active_count; k += 2) {
+            int32_t xa = static_cast<int32_t>(edges[active[k]].x >> 16);
+            int32_t xb = static_cast<int32_t>(edges[active[k + 1]].x >> 16);
+            fillClipped(xa, y, xb + 1, y + 1, color);
+        }
+
+        for (uint8_t k = 0; k < active_count; k++) {
+            PolygonEdge& e = edges[active[k]];
+            e.x += e.dxdy;
         }
     }
-    delete[] nodeX;
 }
 
+// 填充当前裁剪区（未设置裁剪时即整屏）
 void ST73XX_UI::fillScreen(uint16_t color) {
-    fillRect(0, 0, WIDTH, HEIGHT, color);
+    fillClipped(clip_.x0, clip_.y0, clip_.x1, clip_.y1, color);
 }
 
 void ST73XX_UI::drawChar(int16_t x, int16_t y, unsigned char c, uint16_t color, uint16_t bg, uint8_t size_x, uint8_t size_y) {
     if (c < 32 || c > 126) return;
 
     if (size_x == 0 || size_y == 0) return;
+    ST73XX_METRIC_GLYPH();  // 像素与区块由驱动计数
 
     if (color != bg) {
         fillRect(x, y, 5 * size_x, 7 * size_y, color);
@@ -351,6 +679,7 @@ void ST73XX_UI::setRotation(uint8_t r) {
         HEIGHT = _width;
         break;
     }
+    resetClip(); // 裁剪区以旋转后的坐标保存，旋转改变后失效
 }
 
 uint8_t ST73XX_UI::getRotation(void) const {
@@ -366,7 +695,8 @@ int16_t ST73XX_UI::height() const {
 }
 
 void ST73XX_UI::fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) {
-    for (int16_t i = x; i < x + w; i++) {
-        drawFastVLine(i, y, h, color);
-    }
+    if (w <= 0 || h <= 0) return;
+    int32_t ax = static_cast<int32_t>(x) + clip_.origin_x;
+    int32_t ay = static_cast<int32_t>(y) + clip_.origin_y;
+    fillClipped(ax, ay, ax + w, ay + h, color);
 } 
\ No newline at end of file
@@ -0,0 +1,288 @@
+// 截屏工具（主机端，POSIX 串口）
+// 在PC上编译运行：
+//   g++ -std=c++17 -O2 -Iinclude/net tools/fb_capture.cpp -o fb_capture
+//   ./fb_capture /dev/ttyACM0 [输出.png] [--rotate 0-3] [--scale N] [--timeout 秒] [--wait]
+//
+// 向设备（StdioFrameCapture::listen）发送截屏请求，接收 Capture 描述与行程编码的关键行带，
+// 按描述里的打包格式（ST7305 4x2 1bit、ST7306 2x2 2bit 或单色缓冲 4x2 1bit）展开像素，
+// 按 rotation 转回逻辑方向后写出8位灰度PNG。--rotate 覆盖设备报告的方向；
+// --wait 不发请求，只等待设备自己发起的截屏（例如按键触发）。
+// 串口里夹杂的 printf 日志按魔数跳过。
+
+#include <fcntl.h>
+#include <poll.h>
+#include <termios.h>
+#include <unistd.h>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#include "fb_stream_protocol.hpp"
+
+namespace {
+
+uint64_t nowUs() {
+    using namespace std::chrono;
+    return duration_cast<microseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+// USB CDC 忽略波特率，只需要原始模式（不做换行转换、不回显）
+int openSerial(const char* path) {
+    int fd = open(path, O_RDWR | O_NOCTTY);
+    termios tio{};
+    if (fd < 0 || tcgetattr(fd, &tio) != 0) {
+        perror("open");
+        return -1;
+    }
+    cfmakeraw(&tio);
+    tio.c_cc[VMIN] = 0;
+    tio.c_cc[VTIME] = 0;
+    tcsetattr(fd, TCSANOW, &tio);
+    tcflush(fd, TCIFLUSH);
+    return fd;
+}
+
+// 打包显存 -> 物理像素灰度（0白 ~ max黑），位布局同 st73xx::PanelPacking::bitPosition
+uint8_t packedPixel(const std::vector<uint8_t>& fb, uint16_t stride, uint8_t bits, uint16_t x, uint16_t y) {
+    const uint16_t pixels_x = static_cast<uint16_t>(4 / bits);
+    const uint8_t col = static_cast<uint8_t>(x % pixels_x);
+    const uint8_t row = static_cast<uint8_t>(y & 1);
+    const uint8_t b = fb[static_cast<size_t>(y / 2) * stride + x / pixels_x];
+    uint8_t level = 0;
+    for (uint8_t plane = 0; plane < bits; plane++) {
+        level = static_cast<uint8_t>((level << 1) | ((b >> (7 - (col * 2 * bits + plane * 2 + row))) & 1));
+    }
+    return level;
+}
+
+// 逻辑坐标 -> 物理坐标，与 ST73XX_UI::toPhysical 相同
+void toPhysical(uint8_t rotation, uint16_t width, uint16_t height, uint16_t x, uint16_t y, uint16_t& px, uint16_t& py) {
+    switch (rotation & 3) {
+    case 1: px = y; py = static_cast<uint16_t>(height - 1 - x); break;
+    case 2: px = static_cast<uint16_t>(width - 1 - x); py = static_cast<uint16_t>(height - 1 - y); break;
+    case 3: px = static_cast<uint16_t>(width - 1 - y); py = x; break;
+    default: px = x; py = y; break;
+    }
+}
+
+// ---- 最小PNG写出：8位灰度，zlib 使用不压缩的 stored 块 ----
+
+uint32_t crc32(const uint8_t* data, size_t n, uint32_t crc = 0) {
+    crc = ~crc;
+    for (size_t i = 0; i < n; i++) {
+        crc ^= data[i];
+        for (int k = 0; k < 8; k++) crc = (crc >> 1) ^ (0xEDB88320u & (0u - (crc & 1)));
+    }
+    return ~crc;
+}
+
+void put32be(std::vector<uint8_t>& out, uint32_t v) {
+    for (int s = 24; s >= 0; s -= 8) out.push_back(static_cast<uint8_t>(v >> s));
+}
+
+void writeChunk(FILE* f, const char* type, const std::vector<uint8_t>& data) {
+    std::vector<uint8_t> chunk;
+    put32be(chunk, static_cast<uint32_t>(data.size()));
+    chunk.insert(chunk.end(), type, type + 4);
+    chunk.insert(chunk.end(), data.begin(), data.end());
+    put32be(chunk, crc32(chunk.data() + 4, chunk.size() - 4));
+    fwrite(chunk.data(), 1, chunk.size(), f);
+}
+
+bool writePng(const char* path, const std::vector<uint8_t>& gray, uint32_t width, uint32_t height) {
+    FILE* f = fopen(path, "wb");
+    if (!f) return false;
+    static const uint8_t signature[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+    fwrite(signature, 1, sizeof(signature), f);
+
+    std::vector<uint8_t> ihdr;
+    put32be(ihdr, width);
+    put32be(ihdr, height);
+    ihdr.insert(ihdr.end(), {8, 0, 0, 0, 0});  // 8位灰度，无隔行
+    writeChunk(f, "IHDR", ihdr);
+
+    // 每行前加过滤类型0
+    std::vector<uint8_t> raw;
+    raw.reserve((width + 1) * height);
+    for (uint32_t y = 0; y < height; y++) {
+        raw.push_back(0);
+        raw.insert(raw.end(), gray.begin() + y * width, gray.begin() + (y + 1) * width);
+    }
+    std::vector<uint8_t> z = {0x78, 0x01};
+    uint32_t a = 1, b = 0;
+    for (uint8_t v : raw) {
+        a = (a + v) % 65521;
+        b = (b + a) % 65521;
+    }
+    for (size_t pos = 0; pos < raw.size();) {
+        const size_t n = raw.size() - pos < 65535 ? raw.size() - pos : 65535;
+        z.push_back(pos + n == raw.size() ? 1 : 0);
+        z.push_back(static_cast<uint8_t>(n));
+        z.push_back(static_cast<uint8_t>(n >> 8));
+        z.push_back(static_cast<uint8_t>(~n));
+        z.push_back(static_cast<uint8_t>(~n >> 8));
+        z.insert(z.end(), raw.begin() + pos, raw.begin() + pos + n);
+        pos += n;
+    }
+    put32be(z, (b << 16) | a);
+    writeChunk(f, "IDAT", z);
+    writeChunk(f, "IEND", {});
+    return fclose(f) == 0;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        fprintf(stderr, "usage: %s <tty> [out.png] [--rotate 0-3] [--scale N] [--timeout seconds] [--wait]\n", argv[0]);
+        return 1;
+    }
+    const char* tty = argv[1];
+    const char* out_path = "capture.png";
+    int rotate_override = -1;
+    int scale = 1;
+    double timeout_s = 5.0;
+    bool send_request = true;
+    for (int i = 2; i < argc; i++) {
+        if (strcmp(argv[i], "--rotate") == 0 && i + 1 < argc) {
+            rotate_override = atoi(argv[++i]) & 3;
+        } else if (strcmp(argv[i], "--scale") == 0 && i + 1 < argc) {
+            scale = atoi(argv[++i]);
+            if (scale < 1) scale = 1;
+        } else if (strcmp(argv[i], "--timeout") == 0 && i + 1 < argc) {
+            timeout_s = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--wait") == 0) {
+            send_request = false;
+        } else {
+            out_path = argv[i];
+        }
+    }
+
+    const int fd = openSerial(tty);
+    if (fd < 0) return 1;
+    if (send_request) {
+        uint8_t req[net::FB_STREAM_HEADER_LENGTH];
+        net::fbStreamEncodeHeader(req, net::FbStreamHeader{net::FbStreamType::Capture, 0, 0, 0, 0, 0, 0});
+        if (write(fd, req, sizeof(req)) != static_cast<ssize_t>(sizeof(req))) {
+            perror("write");
+            return 1;
+        }
+    }
+
+    // 按消息切分输入：先找魔数，攒齐消息头（Delta 再加前缀与编码数据）后整条处理
+    std::vector<uint8_t> in;
+    std::vector<uint8_t> fb;
+    std::vector<bool> received_rows;
+    net::FbCaptureInfo info{};
+    uint16_t stride = 0;
+    uint16_t rows = 0;
+    uint16_t seq = 0;
+    bool have_info = false;
+    bool done = false;
+    size_t wire_bytes = 0;
+    size_t skipped = 0;
+    const uint64_t start = nowUs();
+    const uint64_t deadline = start + static_cast<uint64_t>(timeout_s * 1e6);
+
+    while (!done && nowUs() < deadline) {
+        pollfd pfd{fd, POLLIN, 0};
+        if (poll(&pfd, 1, 50) <= 0) continue;
+        uint8_t buf[4096];
+        ssize_t n = read(fd, buf, sizeof(buf));
+        if (n <= 0) continue;
+        in.insert(in.end(), buf, buf + n);
+
+        size_t pos = 0;
+        while (!done && in.size() - pos >= net::FB_STREAM_HEADER_LENGTH) {
+            net::FbStreamHeader h;
+            if (!net::fbStreamDecodeHeader(in.data() + pos, h) ||
+                (h.type != net::FbStreamType::Capture && h.type != net::FbStreamType::Delta)) {
+                pos++;
+                skipped++;
+                continue;
+            }
+            const uint8_t* msg = in.data() + pos;
+            size_t length = net::FB_STREAM_HEADER_LENGTH;
+            if (h.type == net::FbStreamType::Capture) {
+                length += net::FB_CAPTURE_INFO_LENGTH;
+            } else {
+                if (in.size() - pos < length + net::FB_STREAM_DELTA_PREFIX_LENGTH) break;
+                length += net::FB_STREAM_DELTA_PREFIX_LENGTH + net::fbStreamGet16(msg + net::FB_STREAM_HEADER_LENGTH + 4);
+            }
+            if (in.size() - pos < length) break;
+
+            if (h.type == net::FbStreamType::Capture) {
+                info = net::fbCaptureDecodeInfo(msg + net::FB_STREAM_HEADER_LENGTH);
+                const bool valid = (info.bits == 1 || info.bits == 2) && h.width > 0 && h.rows > 0 &&
+                                   static_cast<uint32_t>(h.width) * (4 / info.bits) == info.width &&
+                                   static_cast<uint32_t>(h.rows) * 2 == info.height;
+                if (!valid) {
+                    pos++;
+                    skipped++;
+                    continue;
+                }
+                stride = h.width;
+                rows = h.rows;
+                seq = h.seq;
+                fb.assign(static_cast<size_t>(stride) * rows, 0);
+                received_rows.assign(rows, false);
+                have_info = true;
+                wire_bytes = length;
+            } else if (have_info && h.seq == seq && (h.flags & net::FB_STREAM_FLAG_KEY) && h.col == 0 &&
+                       h.width == stride && h.row + h.rows <= rows) {
+                // 关键行带：用设备端同一个解析器解码
+                net::FbStreamParser parser(fb.data(), stride, rows);
+                if (parser.consume(msg, length) && parser.atMessageBoundary()) {
+                    for (uint16_t r = 0; r < h.rows; r++) received_rows[h.row + r] = true;
+                }
+                wire_bytes += length;
+                done = (h.flags & net::FB_STREAM_FLAG_FRAME_END) != 0;
+            } else {
+                skipped += length;
+            }
+            pos += length;
+        }
+        in.erase(in.begin(), in.begin() + static_cast<std::ptrdiff_t>(pos));
+    }
+    close(fd);
+
+    if (!done) {
+        fprintf(stderr, "timed out (%s)\n", have_info ? "capture incomplete" : "no capture received");
+        return 1;
+    }
+    uint16_t missing = 0;
+    for (bool r : received_rows) missing += r ? 0 : 1;
+
+    // 展开像素、转回逻辑方向、放大
+    const uint8_t rotation = static_cast<uint8_t>(rotate_override >= 0 ? rotate_override : info.rotation);
+    const uint16_t lw = (rotation & 1) ? info.height : info.width;
+    const uint16_t lh = (rotation & 1) ? info.width : info.height;
+    const uint8_t max_level = static_cast<uint8_t>((1u << info.bits) - 1);
+    const uint32_t out_w = static_cast<uint32_t>(lw) * scale;
+    const uint32_t out_h = static_cast<uint32_t>(lh) * scale;
+    std::vector<uint8_t> gray(static_cast<size_t>(out_w) * out_h);
+    for (uint16_t y = 0; y < lh; y++) {
+        for (uint16_t x = 0; x < lw; x++) {
+            uint16_t px, py;
+            toPhysical(rotation, info.width, info.height, x, y, px, py);
+            const uint8_t level = packedPixel(fb, stride, info.bits, px, py);
+            const uint8_t v = static_cast<uint8_t>(255 - level * 255 / max_level);
+            for (int sy = 0; sy < scale; sy++) {
+                memset(&gray[(static_cast<size_t>(y) * scale + sy) * out_w + static_cast<size_t>(x) * scale], v,
+                       static_cast<size_t>(scale));
+            }
+        }
+    }
+    if (!writePng(out_path, gray, out_w, out_h)) {
+        perror(out_path);
+        return 1;
+    }
+    printf("%s: %ux%u (%u bit, rotation %u), %zu bytes over the wire for %u raw (%.1fx) in %.0f ms",
+           out_path, lw, lh, info.bits, rotation, wire_bytes, static_cast<unsigned>(fb.size()),
+           static_cast<double>(fb.size()) / wire_bytes, (nowUs() - start) / 1000.0);
+    if (missing) printf(", %u byte rows missing", missing);
+    if (skipped) printf(", %zu log bytes skipped", skipped);
+    printf("\n");
+    return missing ? 2 : 0;
+}
@@ -0,0 +1,283 @@
+// 帧缓冲流客户端（主机端，POSIX socket / 串口）
+// 在PC上编译运行：
+//   g++ -std=c++17 -O2 -Iinclude/net tools/fb_stream_client.cpp -o fb_stream_client
+//   ./fb_stream_client <设备IP> [udp|tcp] [full|rect|line] [raw|delta] [秒数] [端口]
+//   ./fb_stream_client /dev/ttyACM0 serial [full|rect|line] [raw|delta] [秒数]
+//
+// 生成ST7306原生打包（2bit灰度，每字节行150字节，共200行）的动画内容，按协议发送更新区域，
+// 每帧等待设备的 Ack 后再发下一帧（停等），统计实际帧率、每次更新的字节数与Ack往返时间。
+// raw：发送 Rect 消息，UDP下丢帧（Ack超时）只计数，不重发。
+// delta：整帧交给 FbDeltaEncoder，只发送变化的行带；没有确认的行带在下一帧以关键行带补发。
+// serial：通过USB CDC（设备端 StdioFrameReceiver）发送，Ack 按魔数从设备的printf输出中分离。
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <termios.h>
+#include <unistd.h>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#include "fb_stream_protocol.hpp"
+
+namespace {
+
+constexpr uint16_t STRIDE = 150;
+constexpr uint16_t ROWS = 200;
+constexpr int ACK_TIMEOUT_MS = 500;
+
+enum class Link { Udp, Tcp, Serial };
+
+struct Update {
+    uint16_t col;
+    uint16_t row;
+    uint16_t width;
+    uint16_t rows;
+};
+
+uint64_t nowUs() {
+    using namespace std::chrono;
+    return duration_cast<microseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+// 动画内容：一条随帧号移动的竖条（灰度 0~3 循环）
+void paint(std::vector<uint8_t>& fb, const Update& u, uint32_t frame) {
+    for (uint16_t r = 0; r < u.rows; r++) {
+        uint8_t* row = fb.data() + static_cast<size_t>(u.row + r) * STRIDE + u.col;
+        for (uint16_t c = 0; c < u.width; c++) {
+            bool bar = ((c + frame) % 32) < 4;
+            row[c] = bar ? 0xFF : static_cast<uint8_t>(((r + frame) / 8 % 4) * 0x55);
+        }
+    }
+}
+
+int openSocket(const char* ip, bool tcp, uint16_t port) {
+    int fd = socket(AF_INET, tcp ? SOCK_STREAM : SOCK_DGRAM, 0);
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    if (fd < 0 || inet_pton(AF_INET, ip, &addr.sin_addr) != 1 ||
+        connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+        perror("connect");
+        return -1;
+    }
+    if (tcp) {
+        int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    }
+    return fd;
+}
+
+// USB CDC 忽略波特率，只需要原始模式（不做换行转换、不回显）
+int openSerial(const char* path) {
+    int fd = open(path, O_RDWR | O_NOCTTY);
+    termios tio{};
+    if (fd < 0 || tcgetattr(fd, &tio) != 0) {
+        perror("open");
+        return -1;
+    }
+    cfmakeraw(&tio);
+    tio.c_cc[VMIN] = 0;
+    tio.c_cc[VTIME] = 0;
+    tcsetattr(fd, TCSANOW, &tio);
+    tcflush(fd, TCIOFLUSH);
+    return fd;
+}
+
+bool sendAll(int fd, const uint8_t* data, size_t len) {
+    while (len > 0) {
+        ssize_t n = write(fd, data, len);
+        if (n <= 0) return false;
+        data += n;
+        len -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+// 从字节流中按魔数切出 Ack；UDP下每个数据报就是一条
+class AckReader {
+public:
+    AckReader(int fd, Link link) : fd_(fd), link_(link) {}
+
+    // 等待下一条 Ack；超时返回 false
+    bool next(net::FbStreamHeader& h, uint64_t deadline) {
+        while (nowUs() < deadline) {
+            if (link_ == Link::Udp) {
+                uint8_t buf[net::FB_STREAM_HEADER_LENGTH];
+                if (!waitReadable(deadline)) continue;
+                ssize_t n = recv(fd_, buf, sizeof(buf), 0);
+                if (n == static_cast<ssize_t>(sizeof(buf)) && net::fbStreamDecodeHeader(buf, h) &&
+                    h.type == net::FbStreamType::Ack) {
+                    return true;
+                }
+                continue;
+            }
+            if (take(h)) return true;
+            if (!waitReadable(deadline)) continue;
+            ssize_t n = read(fd_, buf_ + fill_, sizeof(buf_) - fill_);
+            if (n <= 0) return false;
+            fill_ += static_cast<size_t>(n);
+        }
+        return false;
+    }
+
+private:
+    bool waitReadable(uint64_t deadline) {
+        pollfd pfd{fd_, POLLIN, 0};
+        int remaining_ms = static_cast<int>((deadline - nowUs()) / 1000);
+        return poll(&pfd, 1, remaining_ms > 0 ? remaining_ms : 1) > 0;
+    }
+
+    // 丢弃魔数之前的字节（设备的printf日志），攒齐一条消息头后解码
+    bool take(net::FbStreamHeader& h) {
+        const uint8_t m0 = static_cast<uint8_t>(net::FB_STREAM_MAGIC);
+        const uint8_t m1 = static_cast<uint8_t>(net::FB_STREAM_MAGIC >> 8);
+        for (;;) {
+            size_t skip = 0;
+            while (skip < fill_ && buf_[skip] != m0) skip++;
+            if (skip + 1 < fill_ && buf_[skip + 1] != m1) skip++;
+            if (skip > 0) {
+                memmove(buf_, buf_ + skip, fill_ - skip);
+                fill_ -= skip;
+                continue;
+            }
+            if (fill_ < net::FB_STREAM_HEADER_LENGTH) return false;
+            const bool ok = net::fbStreamDecodeHeader(buf_, h) && h.type == net::FbStreamType::Ack;
+            const size_t used = ok ? net::FB_STREAM_HEADER_LENGTH : 1;
+            memmove(buf_, buf_ + used, fill_ - used);
+            fill_ -= used;
+            if (ok) return true;
+        }
+    }
+
+    int fd_;
+    Link link_;
+    uint8_t buf_[256];
+    size_t fill_ = 0;
+};
+
+} // namespace
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        fprintf(stderr, "usage: %s <ip|tty> [udp|tcp|serial] [full|rect|line] [raw|delta] [seconds] [port]\n",
+                argv[0]);
+        return 1;
+    }
+    const char* link_name = argc > 2 ? argv[2] : "udp";
+    const Link link = strcmp(link_name, "tcp") == 0      ? Link::Tcp
+                      : strcmp(link_name, "serial") == 0 ? Link::Serial
+                                                         : Link::Udp;
+    const char* mode = argc > 3 ? argv[3] : "full";
+    const bool delta = argc > 4 && strcmp(argv[4], "delta") == 0;
+    const uint32_t seconds = argc > 5 ? strtoul(argv[5], nullptr, 10) : 10;
+    const uint16_t port = static_cast<uint16_t>(argc > 6 ? strtoul(argv[6], nullptr, 10) : net::FB_STREAM_PORT);
+
+    Update update{0, 0, STRIDE, ROWS};
+    if (strcmp(mode, "rect") == 0) {
+        update = Update{25, 50, 100, 100};
+    } else if (strcmp(mode, "line") == 0) {
+        update = Update{0, 188, STRIDE, 12};
+    }
+
+    const int fd = link == Link::Serial ? openSerial(argv[1]) : openSocket(argv[1], link == Link::Tcp, port);
+    if (fd < 0) return 1;
+    AckReader acks(fd, link);
+
+    std::vector<uint8_t> fb(static_cast<size_t>(STRIDE) * ROWS, 0);
+    std::vector<uint8_t> msg(net::FB_STREAM_HEADER_LENGTH + fb.size());
+    const uint16_t band = link != Link::Udp ? update.rows : net::fbStreamRowsPerDatagram(update.width);
+    std::vector<uint8_t> reference(fb.size());
+    std::vector<uint8_t> pending(fb.size());
+    net::FbDeltaEncoder encoder(reference.data(), pending.data(), STRIDE, ROWS);
+
+    uint32_t frames = 0;
+    uint32_t lost = 0;
+    uint32_t key_bands = 0;
+    uint64_t bytes = 0;
+    uint64_t packets = 0;
+    uint64_t rtt_total_us = 0;
+    uint64_t rtt_max_us = 0;
+    const uint64_t start = nowUs();
+    const uint64_t end = start + seconds * 1000000ull;
+
+    for (uint16_t frame = 0; nowUs() < end; frame++) {
+        paint(fb, update, frame);
+        const uint64_t sent_us = nowUs();
+        bool ok = true;
+        uint16_t seq = frame;
+        if (delta) {
+            const auto& fs = encoder.encode(fb.data(), [&](const uint8_t* data, size_t len) {
+                ok = ok && sendAll(fd, data, len);
+            });
+            seq = fs.seq;
+            bytes += fs.wire_bytes;
+            packets += fs.messages;
+            key_bands += fs.key_bands;
+        } else {
+            for (uint16_t row = 0; row < update.rows && ok; row += band) {
+                uint16_t rows = static_cast<uint16_t>(update.rows - row < band ? update.rows - row : band);
+                uint8_t flags = row + rows >= update.rows ? net::FB_STREAM_FLAG_FRAME_END : 0;
+                size_t len = net::fbStreamBuildRect(msg.data(), msg.size(), fb.data(), STRIDE, update.col,
+                                                    static_cast<uint16_t>(update.row + row), update.width, rows,
+                                                    seq, flags);
+                ok = sendAll(fd, msg.data(), len);
+                bytes += len;
+                packets++;
+            }
+        }
+        if (!ok) {
+            perror("send");
+            break;
+        }
+
+        // 差分模式下设备只在整帧到齐时确认本帧，否则回复它仍停留的帧
+        bool confirmed = false;
+        bool answered = false;
+        const uint64_t deadline = nowUs() + ACK_TIMEOUT_MS * 1000ull;
+        net::FbStreamHeader ack;
+        while (!answered && acks.next(ack, deadline)) {
+            if (delta) {
+                confirmed = encoder.onAck(ack);
+                answered = confirmed || ack.seq != encoder.lastSeq();
+            } else {
+                answered = confirmed = ack.seq == seq;
+            }
+        }
+        if (delta && !answered) encoder.onTimeout();
+
+        if (confirmed) {
+            uint64_t rtt = nowUs() - sent_us;
+            rtt_total_us += rtt;
+            if (rtt > rtt_max_us) rtt_max_us = rtt;
+            frames++;
+        } else {
+            lost++;
+            if (link == Link::Tcp && !answered) break;  // TCP下超时说明连接已异常
+        }
+    }
+
+    const double elapsed = (nowUs() - start) / 1e6;
+    const uint32_t updates = frames + lost;
+    printf("%s %s %s %ux%u bytes @ (%u,%u)\n", link_name, mode, delta ? "delta" : "raw",
+           update.width, update.rows, update.col, update.row);
+    printf("  %u frames in %.2f s = %.1f fps, %u lost\n", frames, elapsed, frames / elapsed, lost);
+    if (updates > 0) {
+        printf("  %.0f bytes/update, %.1f messages/update, %.2f Mbit/s\n",
+               static_cast<double>(bytes) / updates, static_cast<double>(packets) / updates,
+               bytes * 8 / elapsed / 1e6);
+    }
+    if (delta) {
+        printf("  %u key bands (%u rows each)\n", key_bands, encoder.bandRows());
+    }
+    if (frames > 0) {
+        printf("  update->ack avg %.2f ms, max %.2f ms\n", rtt_total_us / 1000.0 / frames, rtt_max_us / 1000.0);
+    }
+    close(fd);
+    return 0;
+}
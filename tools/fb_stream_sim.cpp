@@ -0,0 +1,257 @@
+// 帧缓冲流协议的主机端仿真（不需要Pico SDK和网络）
+// 在PC上编译运行：
+//   g++ -std=c++17 -O2 -Iinclude/st73xx -Iinclude/net tools/fb_stream_sim.cpp -o fb_stream_sim
+//   ./fb_stream_sim [链路Mbit/s] [单向延迟ms] [每场景帧数] [UDP丢包率%]
+//
+// 发送端按协议把更新编成消息（UDP每个数据报一条，TCP按MSS切分字节流），接收端用设备上
+// 同一个 FbStreamParser 直接写入仿真面板显存，帧结束时只刷新脏行并回 Ack。
+//   raw   ：Rect 消息发送更新区域的原始字节
+//   delta ：FbDeltaEncoder 对整帧与已确认帧异或、按行带行程编码，只发有变化的行带
+// 每个被确认的帧都逐字节比对两端显存；UDP按给定丢包率随机丢数据报，delta 验证关键帧恢复。
+// 统计每次更新的线上字节数，以及停等（每帧等Ack）与流水线两种情况下的帧率。
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#include "fb_stream_protocol.hpp"
+#include "st73xx_panel_simulator.hpp"
+
+namespace {
+
+constexpr uint16_t STRIDE = 150;  // ST7306: 300像素 / 每字节2像素
+constexpr uint16_t ROWS = 200;    // 400像素 / 每字节2行
+constexpr size_t BUFFER_LENGTH = static_cast<size_t>(STRIDE) * ROWS;
+constexpr size_t TCP_MSS = 1024;          // 与 lwipopts.h 一致
+constexpr size_t PACKET_OVERHEAD = 66;    // 802.11 + LLC + IP + UDP/TCP 头的近似值
+constexpr uint32_t ACK_TIMEOUT_US = 100000;
+
+using Packet = std::vector<uint8_t>;
+
+struct Link {
+    double mbps;
+    uint32_t latency_us;
+    double loss;  // UDP丢包率（0~1）
+
+    uint64_t wireNs(size_t bytes) const {
+        return static_cast<uint64_t>((bytes + PACKET_OVERHEAD) * 8 * 1000.0 / mbps);
+    }
+};
+
+struct Update {
+    uint16_t col;
+    uint16_t row;
+    uint16_t width;
+    uint16_t rows;
+};
+
+enum class Content : uint8_t { Noise, Hand, Digits };
+
+struct Scenario {
+    const char* name;
+    Update rect;  // 每帧改变的区域
+    Content content;
+};
+
+uint8_t& at(std::vector<uint8_t>& fb, int col, int row) {
+    return fb[static_cast<size_t>(row) * STRIDE + col];
+}
+
+// 在源显存的矩形内画出第 frame 帧的内容
+void paint(std::vector<uint8_t>& fb, const Scenario& sc, uint32_t frame) {
+    const Update& u = sc.rect;
+    for (uint16_t r = 0; r < u.rows; r++) {
+        for (uint16_t c = 0; c < u.width; c++) {
+            uint8_t v = 0;
+            if (sc.content == Content::Noise) {
+                v = static_cast<uint8_t>((frame * 37) ^ (r * 7) ^ (c * 13));
+            } else if (sc.content == Content::Digits) {
+                // 8个"数字"，每个12字节宽；高位很少变化
+                uint32_t digit = (frame >> (4 * (7 - c / 12 % 8))) & 0xF;
+                v = ((digit * 5 + r * 3 + c % 12) % 7 == 0) ? 0xF0 : 0x00;
+            }
+            at(fb, u.col + c, u.row + r) = v;
+        }
+    }
+    if (sc.content == Content::Hand) {
+        // 从中心出发的一根粗指针，在8个方向之间插值转动
+        static const int DIRS[8][2] = {{0, -1}, {1, -1}, {1, 0}, {1, 1}, {0, 1}, {-1, 1}, {-1, 0}, {-1, -1}};
+        const int cx = u.col + u.width / 2;
+        const int cy = u.row + u.rows / 2;
+        const uint32_t step = frame % 64;
+        const int* d0 = DIRS[step / 8];
+        const int* d1 = DIRS[(step / 8 + 1) % 8];
+        const int frac = static_cast<int>(step % 8);
+        for (int t = 0; t < u.rows / 2 - 2; t++) {
+            int x = cx + (d0[0] * (8 - frac) + d1[0] * frac) * t / 8;
+            int y = cy + (d0[1] * (8 - frac) + d1[1] * frac) * t / 8;
+            for (int w = -1; w <= 1; w++) {
+                at(fb, x + w, y) = 0xFF;
+            }
+        }
+    }
+}
+
+// Rect：UDP每个数据报一条行带消息；TCP整块一条消息
+void encodeRaw(const std::vector<uint8_t>& fb, const Update& u, uint16_t seq, bool tcp, std::vector<Packet>& messages) {
+    const uint16_t band = tcp ? u.rows : net::fbStreamRowsPerDatagram(u.width);
+    for (uint16_t row = 0; row < u.rows; row += band) {
+        uint16_t rows = static_cast<uint16_t>(u.rows - row < band ? u.rows - row : band);
+        uint8_t flags = row + rows >= u.rows ? net::FB_STREAM_FLAG_FRAME_END : 0;
+        Packet msg(net::FB_STREAM_HEADER_LENGTH + static_cast<size_t>(u.width) * rows);
+        net::fbStreamBuildRect(msg.data(), msg.size(), fb.data(), STRIDE,
+                               u.col, static_cast<uint16_t>(u.row + row), u.width, rows, seq, flags);
+        messages.push_back(std::move(msg));
+    }
+}
+
+// 消息 -> 线上分组：UDP原样；TCP拼成字节流后按 segment 切分（0表示随机长度，检验任意边界）
+void packetize(std::vector<Packet>& messages, bool tcp, size_t segment, std::vector<Packet>& packets) {
+    packets.clear();
+    if (!tcp) {
+        packets.swap(messages);
+        return;
+    }
+    std::vector<uint8_t> stream;
+    for (const Packet& m : messages) stream.insert(stream.end(), m.begin(), m.end());
+    for (size_t off = 0; off < stream.size();) {
+        size_t n = segment ? segment : 1 + static_cast<size_t>(rand() % 97);
+        if (n > stream.size() - off) n = stream.size() - off;
+        packets.emplace_back(stream.begin() + off, stream.begin() + off + n);
+        off += n;
+    }
+}
+
+void runScenario(const Scenario& sc, bool delta, bool tcp, const Link& link, uint32_t frames) {
+    st73xx::SimulatedClock clock;
+    st73xx::SimulatedPanel panel(clock, BUFFER_LENGTH, st73xx::BusTiming::dmaSpi(), STRIDE);
+    net::FbStreamParser parser(panel.buffer(), STRIDE, ROWS);
+    std::vector<uint8_t> source(BUFFER_LENGTH, 0);
+    std::vector<uint8_t> reference(BUFFER_LENGTH);
+    std::vector<uint8_t> pending(BUFFER_LENGTH);
+    net::FbDeltaEncoder encoder(reference.data(), pending.data(), STRIDE, ROWS);
+    std::vector<Packet> messages;
+    std::vector<Packet> packets;
+
+    uint64_t wire_ns = 0;
+    uint64_t flush_ns = 0;
+    uint64_t timeout_ns = 0;
+    uint64_t wire_bytes = 0;
+    uint64_t packet_count = 0;
+    uint32_t confirmed = 0;
+    uint32_t timeouts = 0;
+    uint32_t key_bands = 0;
+    uint32_t mismatches = 0;
+
+    // 第0帧不计入统计、不丢包，TCP下用随机切分检验解析器
+    for (uint32_t frame = 0; frame <= frames; frame++) {
+        const bool timed = frame > 0;
+        paint(source, sc, frame + 1);
+        messages.clear();
+        if (delta) {
+            const auto& fs = encoder.encode(source.data(), [&](const uint8_t* data, size_t len) {
+                messages.emplace_back(data, data + len);
+            });
+            if (timed) key_bands += fs.key_bands;
+        } else {
+            encodeRaw(source, sc.rect, static_cast<uint16_t>(frame), tcp, messages);
+        }
+        packetize(messages, tcp, timed ? TCP_MSS : 0, packets);
+
+        for (const Packet& p : packets) {
+            if (timed) {
+                wire_ns += link.wireNs(p.size());
+                wire_bytes += p.size() + PACKET_OVERHEAD;
+                packet_count++;
+            }
+            if (!tcp && timed && rand() < link.loss * RAND_MAX) {
+                continue;  // 丢包
+            }
+            parser.consume(p.data(), p.size());
+            if (!tcp && !parser.atMessageBoundary()) {
+                parser.abortMessage();
+            }
+        }
+
+        uint16_t first_row = 0;
+        uint16_t row_count = 0;
+        const bool ready = parser.frameReady();
+        const uint16_t ack_seq = parser.frameSeq();
+        const uint8_t ack_flags = parser.ackFlags();
+        if (parser.takeDirtyRows(first_row, row_count)) {
+            uint64_t before = clock.nowNs();
+            panel.displayRows(first_row, row_count);
+            if (timed) flush_ns += clock.nowNs() - before;
+        }
+
+        bool ok = false;
+        if (!ready) {
+            // 帧结束消息丢失：发送端等到超时
+            timeouts++;
+            timeout_ns += ACK_TIMEOUT_US * 1000ull;
+            if (delta) encoder.onTimeout();
+        } else if (delta) {
+            ok = encoder.onAck(net::FbStreamHeader{net::FbStreamType::Ack, ack_flags, ack_seq,
+                                                   0, first_row, 0, row_count});
+        } else {
+            ok = ack_seq == static_cast<uint16_t>(frame);
+        }
+        if (ok) {
+            confirmed++;
+            if (memcmp(panel.buffer(), source.data(), BUFFER_LENGTH) != 0) mismatches++;
+        }
+    }
+
+    const double per_frame_wire_ms = wire_ns / 1e6 / frames;
+    const double per_frame_flush_ms = flush_ns / 1e6 / frames;
+    // 停等：请求单向延迟 + 传输 + 刷新 + Ack单向延迟（Ack本身很小，忽略其传输时间）+ 超时
+    const double stop_wait_ms = per_frame_wire_ms + per_frame_flush_ms + 2 * link.latency_us / 1000.0 +
+                                timeout_ns / 1e6 / frames;
+    // 流水线：下一帧的传输与本帧的刷新重叠，瓶颈是两者中较慢的一个
+    // （差分帧必须以已确认帧为基准，一次只能有一帧在途，不适用）
+    const double pipelined_ms = per_frame_wire_ms > per_frame_flush_ms ? per_frame_wire_ms : per_frame_flush_ms;
+
+    printf("%-12s %-5s %s %6.0f B wire %5.1f pkts  wire %6.2f ms  flush %5.2f ms  stop-and-wait %6.1f fps",
+           sc.name, delta ? "delta" : "raw", tcp ? "tcp" : "udp",
+           static_cast<double>(wire_bytes) / frames,
+           static_cast<double>(packet_count) / frames,
+           per_frame_wire_ms, per_frame_flush_ms, 1000.0 / stop_wait_ms);
+    if (delta) {
+        printf("  key bands %4u", key_bands);
+    } else {
+        printf("  pipelined %6.1f fps", 1000.0 / pipelined_ms);
+    }
+    // Rect 消息没有帧完整性：丢包时 Ack 照样回复，屏上留下旧行，这是预期的"stale"；
+    // 差分帧只在所有部分到齐后才确认，任何不一致都是编码或解析的错误
+    printf("  timeouts %3u  confirmed %3u/%u %s\n", timeouts, confirmed, frames + 1,
+           !mismatches ? "ok" : (delta ? "MISMATCH" : "stale"));
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Link link;
+    link.mbps = argc > 1 ? atof(argv[1]) : 12.0;
+    link.latency_us = static_cast<uint32_t>((argc > 2 ? atof(argv[2]) : 2.0) * 1000);
+    uint32_t frames = argc > 3 ? strtoul(argv[3], nullptr, 10) : 50;
+    link.loss = (argc > 4 ? atof(argv[4]) : 0.0) / 100.0;
+    if (link.mbps <= 0) link.mbps = 12.0;
+    if (frames == 0) frames = 50;
+
+    const Scenario scenarios[] = {
+        {"full-frame", {0, 0, STRIDE, ROWS}, Content::Noise},
+        {"clock-hands", {25, 50, 100, 100}, Content::Hand},  // 表盘中心 200x200 像素
+        {"status-line", {0, 188, STRIDE, 12}, Content::Digits},
+        {"glyph", {70, 100, 4, 8}, Content::Noise},
+    };
+
+    printf("link %.1f Mbit/s, one-way latency %.1f ms, %u frames per scenario, udp loss %.1f%%\n",
+           link.mbps, link.latency_us / 1000.0, frames, link.loss * 100);
+    for (const Scenario& sc : scenarios) {
+        runScenario(sc, false, false, link, frames);
+        runScenario(sc, false, true, link, frames);
+        runScenario(sc, true, false, link, frames);
+        runScenario(sc, true, true, link, frames);
+    }
+    return 0;
+}
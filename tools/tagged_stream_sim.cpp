@@ -0,0 +1,533 @@
+// PIO标记流编码的主机端校验
+// 在PC上编译运行（不需要Pico SDK），在仓库根目录执行：
+//   g++ -std=c++17 -O2 -Iinclude/st73xx tools/tagged_stream_sim.cpp -o tagged_stream_sim
+//   ./tagged_stream_sim [src/st73xx/st73xx_tagged_spi.pio]
+//
+// 读入 st73xx_tagged_spi.pio 并逐条指令执行（pull/out/set/mov/jmp、侧置CS/SCK、
+// .wrap），由面板端模型在SCK上升沿采样MOSI与DC、按CS边沿划分事务，还原出总线内容。
+// 初始化序列（驱动使用的同一份表）、地址窗口和整帧/局部刷新的批次经 tagged::encodeBatch()
+// 编码后送入状态机，还原结果与 RecordingTransport 记录的总线内容逐字节比对，
+// 并打印字数与状态机周期。任何一项不一致时返回非零。
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "st73xx_init_sequence.hpp"
+#include "st73xx_init_tables.hpp"
+#include "st73xx_packed_framebuffer.hpp"
+#include "st73xx_recording_transport.hpp"
+#include "st73xx_tagged_stream.hpp"
+
+namespace {
+
+using st73xx::CommandBatch;
+using st73xx::INIT_DELAY;
+using st73xx::INIT_END;
+using st73xx::RecordingTransport;
+
+// ---------------------------------------------------------------------------
+// PIO程序（只支持本程序用到的指令子集，遇到其他写法时报错）
+// ---------------------------------------------------------------------------
+
+enum class Op { Jmp, Out, Set, Mov, Pull };
+
+struct Instr {
+    Op op;
+    std::string cond;    // jmp条件："" "!x" "x--" "!y" "y--" "x!=y" "!osre"
+    std::string dest;    // out/set/mov目标
+    std::string src;     // mov源
+    uint32_t value = 0;  // out位数 / set立即数
+    std::string target;  // jmp标签
+    uint32_t target_pc = 0;
+    int side = -1;       // 侧置值，-1 表示未指定
+    uint32_t delay = 0;
+    int line = 0;
+};
+
+struct PioProgram {
+    std::vector<Instr> code;
+    uint32_t wrap_target = 0;
+    uint32_t wrap = 0;
+    uint32_t start = 0;     // public start 标签
+    uint32_t side_bits = 0;
+};
+
+bool parseNumber(const std::string& text, uint32_t& value) {
+    char* end = nullptr;
+    if (text.size() > 2 && text[0] == '0' && (text[1] == 'b' || text[1] == 'B')) {
+        value = static_cast<uint32_t>(strtoul(text.c_str() + 2, &end, 2));
+    } else {
+        value = static_cast<uint32_t>(strtoul(text.c_str(), &end, 0));
+    }
+    return end && *end == '\0';
+}
+
+bool loadProgram(const char* path, PioProgram& prog) {
+    std::ifstream file(path);
+    if (!file) {
+        printf("cannot open %s\n", path);
+        return false;
+    }
+
+    std::vector<std::pair<std::string, uint32_t>> labels;
+    bool wrap_set = false;
+    bool in_sdk_block = false;
+    std::string raw;
+    int line_no = 0;
+    while (std::getline(file, raw)) {
+        line_no++;
+        if (in_sdk_block) {
+            if (raw.rfind("%}", 0) == 0) in_sdk_block = false;
+            continue;
+        }
+        if (raw.rfind("%", 0) == 0) {
+            in_sdk_block = true;
+            continue;
+        }
+        std::string text = raw.substr(0, raw.find(';'));
+        for (char& c : text) {
+            if (c == ',' || c == '\t' || c == '\r') c = ' ';
+        }
+        std::istringstream in(text);
+        std::vector<std::string> tok;
+        for (std::string t; in >> t;) tok.push_back(t);
+        if (tok.empty()) continue;
+
+        if (tok[0] == ".program") continue;
+        if (tok[0] == ".side_set") {
+            if (tok.size() != 2 || !parseNumber(tok[1], prog.side_bits)) {
+                printf("%s:%d: unsupported .side_set\n", path, line_no);
+                return false;
+            }
+            continue;
+        }
+        if (tok[0] == ".wrap_target") {
+            prog.wrap_target = static_cast<uint32_t>(prog.code.size());
+            continue;
+        }
+        if (tok[0] == ".wrap") {
+            prog.wrap = static_cast<uint32_t>(prog.code.size()) - 1;
+            wrap_set = true;
+            continue;
+        }
+        if (tok.back().back() == ':') {
+            std::string name = tok.back().substr(0, tok.back().size() - 1);
+            labels.emplace_back(name, static_cast<uint32_t>(prog.code.size()));
+            continue;
+        }
+
+        Instr ins;
+        ins.line = line_no;
+        std::vector<std::string> args;
+        for (size_t i = 1; i < tok.size(); i++) {
+            if (tok[i] == "side" && i + 1 < tok.size()) {
+                uint32_t side = 0;
+                if (!parseNumber(tok[++i], side)) {
+                    printf("%s:%d: bad side value\n", path, line_no);
+                    return false;
+                }
+                ins.side = static_cast<int>(side);
+            } else if (tok[i].front() == '[') {
+                if (!parseNumber(tok[i].substr(1, tok[i].size() - 2), ins.delay)) {
+                    printf("%s:%d: bad delay\n", path, line_no);
+                    return false;
+                }
+            } else {
+                args.push_back(tok[i]);
+            }
+        }
+
+        bool ok = true;
+        if (tok[0] == "pull") {
+            ins.op = Op::Pull;
+            ok = args.size() == 1 && args[0] == "block";
+        } else if (tok[0] == "jmp") {
+            ins.op = Op::Jmp;
+            if (args.size() == 2) {
+                ins.cond = args[0];
+                ins.target = args[1];
+            } else if (args.size() == 1) {
+                ins.target = args[0];
+            } else {
+                ok = false;
+            }
+            ok = ok && (ins.cond.empty() || ins.cond == "!x" || ins.cond == "x--" || ins.cond == "!y" ||
+                        ins.cond == "y--" || ins.cond == "x!=y" || ins.cond == "!osre");
+        } else if (tok[0] == "out" || tok[0] == "set") {
+            ins.op = tok[0] == "out" ? Op::Out : Op::Set;
+            ok = args.size() == 2 && parseNumber(args[1], ins.value);
+            if (ok) ins.dest = args[0];
+            ok = ok && (ins.dest == "pins" || ins.dest == "x" || ins.dest == "y" ||
+                        (ins.op == Op::Out && (ins.dest == "null" || ins.dest == "isr")));
+            ok = ok && (ins.op == Op::Set ? ins.value < 32 : ins.value >= 1 && ins.value <= 32);
+        } else if (tok[0] == "mov") {
+            ins.op = Op::Mov;
+            ok = args.size() == 2;
+            if (ok) {
+                ins.dest = args[0];
+                ins.src = args[1];
+            }
+            auto reg = [](const std::string& r) { return r == "x" || r == "y" || r == "isr" || r == "osr"; };
+            ok = ok && reg(ins.dest) && (reg(ins.src) || ins.src == "null");
+        } else {
+            ok = false;
+        }
+        if (!ok) {
+            printf("%s:%d: unsupported instruction: %s\n", path, line_no, raw.c_str());
+            return false;
+        }
+        prog.code.push_back(ins);
+    }
+
+    if (prog.code.empty() || !wrap_set || prog.side_bits != 2) {
+        printf("%s: expected a program with .side_set 2 and .wrap\n", path);
+        return false;
+    }
+    auto find_label = [&](const std::string& name, uint32_t& pc) {
+        for (const auto& label : labels) {
+            if (label.first == name) {
+                pc = label.second;
+                return true;
+            }
+        }
+        return false;
+    };
+    for (Instr& ins : prog.code) {
+        if (ins.op == Op::Jmp && !find_label(ins.target, ins.target_pc)) {
+            printf("%s:%d: unknown label %s\n", path, ins.line, ins.target.c_str());
+            return false;
+        }
+        if (ins.side < 0) {
+            printf("%s:%d: side-set is not optional in this program\n", path, ins.line);
+            return false;
+        }
+    }
+    if (!find_label("start", prog.start)) {
+        printf("%s: missing start label\n", path);
+        return false;
+    }
+    return true;
+}
+
+// ---------------------------------------------------------------------------
+// 面板端：SCK上升沿采样MOSI，第8位时锁存DC（字节内DC必须保持不变），CS上升沿结束事务
+// ---------------------------------------------------------------------------
+
+struct BusByte {
+    uint8_t value;
+    bool is_data;
+    uint32_t transaction;
+};
+
+class PanelBus {
+public:
+    void observe(bool cs, bool sck, bool mosi, bool dc) {
+        if (prev_cs_ && !cs) {
+            bits_ = 0;
+        }
+        if (!prev_cs_ && cs) {
+            if (bits_ != 0) error("CS raised in the middle of a byte");
+            transactions_++;
+        }
+        if (!prev_sck_ && sck) {
+            if (cs) {
+                error("SCK edge while CS is high");
+            } else {
+                if (bits_ == 0) {
+                    byte_dc_ = dc;
+                } else if (dc != byte_dc_) {
+                    error("DC changed in the middle of a byte");
+                }
+                shift_ = static_cast<uint8_t>((shift_ << 1) | (mosi ? 1 : 0));
+                if (++bits_ == 8) {
+                    bytes_.push_back({shift_, dc, transactions_});
+                    bits_ = 0;
+                }
+            }
+        }
+        prev_cs_ = cs;
+        prev_sck_ = sck;
+    }
+
+    const std::vector<BusByte>& bytes() const { return bytes_; }
+    uint32_t transactions() const { return transactions_; }
+    uint32_t errors() const { return errors_; }
+
+private:
+    void error(const char* what) {
+        if (errors_++ == 0) printf("  bus error: %s\n", what);
+    }
+
+    bool prev_cs_ = true;
+    bool prev_sck_ = false;
+    bool byte_dc_ = false;
+    uint8_t shift_ = 0;
+    uint8_t bits_ = 0;
+    uint32_t transactions_ = 0;
+    uint32_t errors_ = 0;
+    std::vector<BusByte> bytes_;
+};
+
+// ---------------------------------------------------------------------------
+// 状态机：与 st73xx_tagged_spi_program_init() 的配置一致
+// OSR左移（MSB先出）、不自动pull；侧置 bit0 = CS，bit1 = SCK；OUT = MOSI，SET = DC
+// FIFO由DMA持续补充，这里视为无限深，只有字流耗尽时 pull 才会阻塞
+// ---------------------------------------------------------------------------
+
+class PioMachine {
+public:
+    explicit PioMachine(const PioProgram& prog) : prog_(prog), pc_(prog.start) {}
+
+    void push(uint32_t word) { fifo_.push_back(word); }
+
+    // 执行到状态机在空FIFO上阻塞为止。返回false表示超出周期上限（程序失控）
+    bool run() {
+        uint64_t limit = cycles_ + 64 + fifo_.size() * 64;
+        while (cycles_ < limit) {
+            if (!step()) return true;
+        }
+        printf("  state machine did not stall (pc=%u)\n", pc_);
+        return false;
+    }
+
+    // 空闲：阻塞在事务开头的 pull 上且CS为高
+    bool idle() const { return pc_ == prog_.start && fifo_.empty() && cs_; }
+
+    const PanelBus& bus() const { return bus_; }
+    uint64_t cycles() const { return cycles_; }
+
+private:
+    bool step() {
+        const Instr& ins = prog_.code[pc_];
+        // 侧置在指令发出时即生效，包括阻塞中的 pull
+        cs_ = (ins.side & 1) != 0;
+        sck_ = (ins.side & 2) != 0;
+
+        bool jumped = false;
+        switch (ins.op) {
+        case Op::Pull:
+            if (fifo_.empty()) {
+                bus_.observe(cs_, sck_, mosi_, dc_);
+                return false;
+            }
+            osr_ = fifo_.front();
+            fifo_.pop_front();
+            osr_count_ = 0;
+            break;
+        case Op::Out: {
+            uint32_t n = ins.value;
+            uint32_t v = n == 32 ? osr_ : osr_ >> (32 - n);
+            osr_ = n == 32 ? 0 : osr_ << n;
+            osr_count_ += n;
+            if (ins.dest == "pins") mosi_ = (v & 1) != 0;
+            else if (ins.dest == "x") x_ = v;
+            else if (ins.dest == "y") y_ = v;
+            else if (ins.dest == "isr") isr_ = v;
+            break;
+        }
+        case Op::Set:
+            if (ins.dest == "pins") dc_ = (ins.value & 1) != 0;
+            else if (ins.dest == "x") x_ = ins.value;
+            else y_ = ins.value;
+            break;
+        case Op::Mov: {
+            uint32_t v = ins.src == "x" ? x_ : ins.src == "y" ? y_ :
+                         ins.src == "isr" ? isr_ : ins.src == "osr" ? osr_ : 0;
+            if (ins.dest == "x") x_ = v;
+            else if (ins.dest == "y") y_ = v;
+            else if (ins.dest == "isr") isr_ = v;
+            else osr_ = v;
+            break;
+        }
+        case Op::Jmp:
+            if (ins.cond.empty()) jumped = true;
+            else if (ins.cond == "!x") jumped = x_ == 0;
+            else if (ins.cond == "!y") jumped = y_ == 0;
+            else if (ins.cond == "x--") jumped = x_-- != 0;
+            else if (ins.cond == "y--") jumped = y_-- != 0;
+            else if (ins.cond == "x!=y") jumped = x_ != y_;
+            else jumped = osr_count_ < 32;
+            break;
+        }
+
+        cycles_ += 1 + ins.delay;
+        bus_.observe(cs_, sck_, mosi_, dc_);
+
+        if (jumped) pc_ = ins.target_pc;
+        else if (pc_ == prog_.wrap) pc_ = prog_.wrap_target;
+        else pc_++;
+        return true;
+    }
+
+    const PioProgram& prog_;
+    std::deque<uint32_t> fifo_;
+    uint32_t pc_;
+    uint32_t osr_ = 0;
+    uint32_t osr_count_ = 32;
+    uint32_t isr_ = 0;
+    uint32_t x_ = 0;
+    uint32_t y_ = 0;
+    // 初始电平与 program_init 相同：CS高、SCK低、MOSI低、DC高
+    bool cs_ = true;
+    bool sck_ = false;
+    bool mosi_ = false;
+    bool dc_ = true;
+    uint64_t cycles_ = 0;
+    PanelBus bus_;
+};
+
+// ---------------------------------------------------------------------------
+// 校验
+// ---------------------------------------------------------------------------
+
+struct Totals {
+    uint32_t checked = 0;
+    uint32_t failed = 0;
+};
+
+// 编码一个批次+负载送入状态机，与 RecordingTransport 记录的同一次事务比对。
+// 同一个 machine 可连续承载多次事务，检验事务之间CS确实拉高。
+bool checkBatch(PioMachine& machine, const char* name, const CommandBatch& batch,
+                const uint8_t* payload, size_t payload_len, Totals& totals, bool print = true) {
+    totals.checked++;
+    std::vector<uint32_t> words(st73xx::tagged::encodedWords(batch, payload_len > 0));
+    size_t count = st73xx::tagged::encodeBatch(batch, payload_len, words.data(), words.size());
+    bool ok = count == words.size();
+
+    RecordingTransport recording;
+    recording.write(batch, payload, payload_len);
+    std::vector<BusByte> expected;
+    for (const RecordingTransport::Event& e : recording.events()) {
+        if (e.type != RecordingTransport::EventType::Run) continue;
+        for (uint32_t i = 0; i < e.length; i++) {
+            expected.push_back({recording.bytes()[e.offset + i], e.is_data, 0});
+        }
+    }
+
+    size_t first = machine.bus().bytes().size();
+    uint32_t transaction = machine.bus().transactions();
+    uint32_t errors = machine.bus().errors();
+    uint64_t start_cycles = machine.cycles();
+    for (size_t i = 0; i < count; i++) machine.push(words[i]);
+    for (size_t i = 0; i < payload_len; i++) machine.push(st73xx::tagged::byteWord(payload[i]));
+    ok = machine.run() && ok;
+
+    const std::vector<BusByte>& seen = machine.bus().bytes();
+    ok = ok && machine.idle() && machine.bus().errors() == errors &&
+         machine.bus().transactions() == transaction + 1 &&
+         seen.size() - first == expected.size();
+    for (size_t i = 0; ok && i < expected.size(); i++) {
+        const BusByte& b = seen[first + i];
+        ok = b.value == expected[i].value && b.is_data == expected[i].is_data && b.transaction == transaction;
+    }
+
+    if (!ok) totals.failed++;
+    if (print || !ok) {
+        printf("  %-24s %s  words=%zu payload=%zu pio_cycles=%llu\n", name, ok ? "ok  " : "FAIL",
+               count, payload_len, static_cast<unsigned long long>(machine.cycles() - start_cycles));
+    }
+    return ok;
+}
+
+void checkInitSequence(const PioProgram& prog, const char* name, const uint8_t* seq, bool warm,
+                       Totals& totals) {
+    printf("%s (%s):\n", name, warm ? "warm" : "cold");
+    PioMachine machine(prog);
+    uint32_t index = 0;
+    st73xx::runInitSequence(seq, warm,
+        [&](const CommandBatch& batch) {
+            char label[32];
+            snprintf(label, sizeof(label), "batch %u", index++);
+            checkBatch(machine, label, batch, nullptr, 0, totals);
+        },
+        [](uint32_t) {});
+}
+
+// 超出一个批次容量的表：检验 runInitSequence 拆分出的批次同样能正确编码
+std::vector<uint8_t> stressSequence() {
+    std::vector<uint8_t> seq;
+    for (uint8_t i = 0; i < 40; i++) {
+        seq.insert(seq.end(), {static_cast<uint8_t>(0xB0 + (i & 0x0F)), 1, i});
+    }
+    seq.insert(seq.end(), {0xE0, 62});
+    for (uint8_t i = 0; i < 62; i++) seq.push_back(i);
+    seq.insert(seq.end(), {0x11, 0 | INIT_DELAY, 5, 0x29, 0, 0x00, INIT_END});
+    return seq;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    using Packing6 = st73xx::ST7306Packing;
+    using Packing5 = st73xx::ST7305Packing;
+    const char* pio_path = argc > 1 ? argv[1] : "src/st73xx/st73xx_tagged_spi.pio";
+
+    PioProgram prog;
+    if (!loadProgram(pio_path, prog)) return 2;
+    printf("%s: %zu instructions\n", pio_path, prog.code.size());
+
+    Totals totals;
+    checkInitSequence(prog, "ST7306 init", st7306::INIT_SEQUENCE, false, totals);
+    checkInitSequence(prog, "ST7306 init", st7306::INIT_SEQUENCE, true, totals);
+    checkInitSequence(prog, "ST7305 init", st7305::INIT_SEQUENCE, false, totals);
+    checkInitSequence(prog, "ST7305 init", st7305::INIT_SEQUENCE, true, totals);
+    std::vector<uint8_t> stress = stressSequence();
+    checkInitSequence(prog, "split init", stress.data(), false, totals);
+
+    // 载荷使用不重复的图案，错位或丢字节都能被发现
+    std::vector<uint8_t> frame(Packing6::BUFFER_LENGTH);
+    for (size_t i = 0; i < frame.size(); i++) frame[i] = static_cast<uint8_t>(i * 7 + (i >> 8));
+
+    printf("frames:\n");
+    PioMachine machine(prog);
+    CommandBatch batch;
+    batch.command(0x2A, {0x05, 0x36})
+         .command(0x2B, {0x00, static_cast<uint8_t>(Packing6::ROWS - 1)})
+         .command(0x2C);
+    checkBatch(machine, "ST7306 full frame", batch, frame.data(), frame.size(), totals);
+
+    batch.clear();
+    batch.command(0x2A, {0x17, 0x24})
+         .command(0x2B, {0x00, static_cast<uint8_t>(Packing5::ROWS - 1)})
+         .command(0x2C);
+    checkBatch(machine, "ST7305 full frame", batch, frame.data(), Packing5::BUFFER_LENGTH, totals);
+
+    // 地址窗口：单独发送（无负载）与带局部刷新负载
+    batch.clear();
+    batch.command(0x2A, {0x05, 0x36}).command(0x2B, {0x00, 0xC7});
+    checkBatch(machine, "address window", batch, nullptr, 0, totals);
+
+    uint32_t bands = 0;
+    for (uint16_t first = 0; first < Packing6::ROWS; first += 13) {
+        for (uint16_t count = 1; first + count <= Packing6::ROWS; count += 17) {
+            batch.clear();
+            batch.command(0x2A, {0x05, 0x36})
+                 .command(0x2B, {static_cast<uint8_t>(first), static_cast<uint8_t>(first + count - 1)})
+                 .command(0x2C);
+            char label[32];
+            snprintf(label, sizeof(label), "rows %u+%u", first, count);
+            checkBatch(machine, label, batch, frame.data() + static_cast<size_t>(first) * Packing6::STRIDE,
+                       static_cast<size_t>(count) * Packing6::STRIDE, totals, false);
+            bands++;
+        }
+    }
+    printf("  %u row bands checked\n", bands);
+
+    // 超过段长字段的负载必须被拒绝，由调用者拆分
+    batch.clear();
+    batch.command(0x2C);
+    uint32_t words[8];
+    totals.checked++;
+    if (st73xx::tagged::encodeBatch(batch, st73xx::tagged::MAX_RUN_LENGTH + 1, words, 8) != 0) {
+        printf("  oversized payload was not rejected\n");
+        totals.failed++;
+    }
+
+    printf("%u checks, %u failed\n", totals.checked, totals.failed);
+    return totals.failed == 0 ? 0 : 1;
+}
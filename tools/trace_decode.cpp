@@ -0,0 +1,348 @@
+// 追踪解码工具（主机端，POSIX）
+// 在PC上编译运行：
+//   g++ -std=c++17 -O2 -Iinclude/st73xx tools/trace_decode.cpp -o trace_decode
+//   ./trace_decode /dev/ttyACM0 [输出.json] [--request 字符串] [--wait] [--timeout 秒]
+//   ./trace_decode trace.bin [输出.json]
+//
+// 读取 st73xx::Trace::dump() 写出的二进制追踪（串口或保存下来的文件），转成 Chrome trace 事件格式的
+// JSON，可直接拖进 ui.perfetto.dev 或 chrome://tracing 查看。每个核一条时间线，DMA 传输与CPU重叠，
+// 单独放在“core N bus dma”一条上。串口模式下先发送请求（默认 "t"，与示例约定一致），
+// --wait 不发请求，只等设备自己导出；串口里夹杂的 printf 日志按魔数跳过。
+// 标准错误输出各事件的次数与耗时统计。
+
+#include <fcntl.h>
+#include <poll.h>
+#include <termios.h>
+#include <unistd.h>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <string>
+#include <vector>
+#include "st73xx_trace.hpp"
+
+namespace {
+
+using st73xx::TracePhase;
+
+constexpr uint8_t MAX_CORES = 4;
+constexpr uint32_t MAX_CAPACITY = 1u << 20;
+constexpr int DMA_TID_BASE = 100;
+
+uint64_t nowUs() {
+    using namespace std::chrono;
+    return duration_cast<microseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+// USB CDC 忽略波特率，只需要原始模式（不做换行转换、不回显）
+int openSerial(const char* path) {
+    int fd = open(path, O_RDWR | O_NOCTTY);
+    termios tio{};
+    if (fd < 0 || tcgetattr(fd, &tio) != 0) {
+        perror("open");
+        return -1;
+    }
+    cfmakeraw(&tio);
+    tio.c_cc[VMIN] = 0;
+    tio.c_cc[VTIME] = 0;
+    tcsetattr(fd, TCSANOW, &tio);
+    tcflush(fd, TCIFLUSH);
+    return fd;
+}
+
+uint16_t get16(const uint8_t* p) {
+    return static_cast<uint16_t>(p[0] | (p[1] << 8));
+}
+
+uint32_t get32(const uint8_t* p) {
+    return get16(p) | (static_cast<uint32_t>(get16(p + 2)) << 16);
+}
+
+struct Core {
+    uint32_t dropped = 0;
+    std::vector<st73xx::TraceRecord> records;
+};
+
+struct Dump {
+    uint32_t capacity = 0;
+    uint64_t now_us = 0;
+    std::map<uint8_t, std::string> names;
+    std::vector<Core> cores;
+};
+
+enum class Parse { Ok, NeedMore, Bad };
+
+// 从 p 开始（已对齐魔数）解析一份完整的导出
+Parse parseDump(const uint8_t* p, size_t n, Dump& out, size_t& used) {
+    if (n < st73xx::TRACE_DUMP_HEADER_LENGTH) return Parse::NeedMore;
+    const uint8_t version = p[4];
+    const uint8_t cores = p[5];
+    const uint8_t name_count = p[6];
+    out.capacity = get32(p + 8);
+    out.now_us = get32(p + 12) | (static_cast<uint64_t>(get32(p + 16)) << 32);
+    if (version != st73xx::TRACE_DUMP_VERSION || cores == 0 || cores > MAX_CORES || out.capacity == 0 ||
+        out.capacity > MAX_CAPACITY || (out.capacity & (out.capacity - 1)) != 0 ||
+        name_count >= st73xx::TRACE_MAX_EVENTS) {
+        return Parse::Bad;
+    }
+
+    size_t pos = st73xx::TRACE_DUMP_HEADER_LENGTH;
+    out.names.clear();
+    for (uint8_t i = 0; i < name_count; i++) {
+        if (n - pos < 2) return Parse::NeedMore;
+        const uint8_t id = p[pos];
+        const uint8_t len = p[pos + 1];
+        if (n - pos - 2 < len) return Parse::NeedMore;
+        if (id == 0 || id >= st73xx::TRACE_MAX_EVENTS) return Parse::Bad;
+        out.names[id] = std::string(reinterpret_cast<const char*>(p + pos + 2), len);
+        pos += 2 + len;
+    }
+
+    out.cores.assign(cores, Core{});
+    for (Core& core : out.cores) {
+        if (n - pos < 8) return Parse::NeedMore;
+        const uint32_t count = get32(p + pos);
+        core.dropped = get32(p + pos + 4);
+        if (count > out.capacity) return Parse::Bad;
+        pos += 8;
+        if (n - pos < static_cast<size_t>(count) * st73xx::TRACE_RECORD_LENGTH) return Parse::NeedMore;
+        core.records.resize(count);
+        for (st73xx::TraceRecord& r : core.records) {
+            r.timestamp_us = get32(p + pos);
+            r.event = p[pos + 4];
+            r.phase = p[pos + 5];
+            r.arg = get16(p + pos + 6);
+            pos += st73xx::TRACE_RECORD_LENGTH;
+        }
+    }
+    used = pos;
+    return Parse::Ok;
+}
+
+// 在输入中找魔数并解析；日志文本等无关字节丢弃
+Parse findDump(std::vector<uint8_t>& in, Dump& out, size_t& skipped) {
+    const uint8_t* magic = st73xx::TRACE_DUMP_MAGIC;
+    size_t pos = 0;
+    while (in.size() - pos >= sizeof(st73xx::TRACE_DUMP_MAGIC)) {
+        if (memcmp(in.data() + pos, magic, sizeof(st73xx::TRACE_DUMP_MAGIC)) != 0) {
+            pos++;
+            continue;
+        }
+        size_t used = 0;
+        const Parse r = parseDump(in.data() + pos, in.size() - pos, out, used);
+        if (r == Parse::Ok) {
+            skipped += pos;
+            in.erase(in.begin(), in.begin() + static_cast<std::ptrdiff_t>(pos + used));
+            return Parse::Ok;
+        }
+        if (r == Parse::NeedMore) break;
+        pos++;
+    }
+    skipped += pos;
+    in.erase(in.begin(), in.begin() + static_cast<std::ptrdiff_t>(pos));
+    return Parse::NeedMore;
+}
+
+std::string eventName(const Dump& dump, uint8_t id) {
+    auto it = dump.names.find(id);
+    if (it != dump.names.end()) return it->second;
+    return "event " + std::to_string(id);
+}
+
+std::string jsonEscape(const std::string& s) {
+    std::string out;
+    for (char c : s) {
+        if (c == '"' || c == '\\') {
+            out += '\\';
+            out += c;
+        } else if (static_cast<unsigned char>(c) < 0x20) {
+            char buf[8];
+            snprintf(buf, sizeof(buf), "\\u%04x", c);
+            out += buf;
+        } else {
+            out += c;
+        }
+    }
+    return out;
+}
+
+struct Span {
+    uint32_t count = 0;
+    uint64_t total_us = 0;
+    uint64_t max_us = 0;
+};
+
+bool writeJson(const char* path, const Dump& dump) {
+    FILE* f = fopen(path, "w");
+    if (!f) return false;
+
+    // 32位时间戳以导出时刻展开为64位（记录距导出不超过约71分钟）
+    const uint32_t now32 = static_cast<uint32_t>(dump.now_us);
+    auto unwrap = [&](uint32_t ts) { return dump.now_us - static_cast<uint32_t>(now32 - ts); };
+    uint64_t origin = dump.now_us;
+    for (const Core& core : dump.cores) {
+        if (!core.records.empty()) {
+            const uint64_t t = unwrap(core.records.front().timestamp_us);
+            if (t < origin) origin = t;
+        }
+    }
+
+    fprintf(f, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    fprintf(f, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":0,\"args\":{\"name\":\"st73xx\"}}");
+    for (size_t c = 0; c < dump.cores.size(); c++) {
+        fprintf(f, ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":%zu,\"args\":{\"name\":\"core %zu\"}}", c, c);
+        fprintf(f, ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":%zu,\"args\":{\"name\":\"core %zu bus dma\"}}",
+                DMA_TID_BASE + c, c);
+    }
+
+    std::map<uint8_t, Span> spans;
+    uint32_t unmatched = 0;
+    for (size_t c = 0; c < dump.cores.size(); c++) {
+        // 每条时间线上按事件配对 Begin/End；开头被覆盖掉 Begin 的 End 丢弃
+        std::map<std::pair<int, uint8_t>, std::vector<uint64_t>> open;
+        for (const st73xx::TraceRecord& r : dump.cores[c].records) {
+            const int tid = static_cast<int>(c) +
+                            (r.event == static_cast<uint8_t>(st73xx::TraceEvent::BusDma) ? DMA_TID_BASE : 0);
+            const uint64_t ts = unwrap(r.timestamp_us) - origin;
+            const std::string name = jsonEscape(eventName(dump, r.event));
+            std::vector<uint64_t>& stack = open[{tid, r.event}];
+
+            switch (static_cast<TracePhase>(r.phase)) {
+            case TracePhase::Begin:
+                stack.push_back(ts);
+                fprintf(f, ",\n{\"name\":\"%s\",\"ph\":\"B\",\"ts\":%llu,\"pid\":0,\"tid\":%d", name.c_str(),
+                        static_cast<unsigned long long>(ts), tid);
+                if (r.arg) fprintf(f, ",\"args\":{\"arg\":%u}", r.arg);
+                fprintf(f, "}");
+                break;
+            case TracePhase::End: {
+                if (stack.empty()) {
+                    unmatched++;
+                    break;
+                }
+                Span& s = spans[r.event];
+                const uint64_t d = ts - stack.back();
+                stack.pop_back();
+                s.count++;
+                s.total_us += d;
+                if (d > s.max_us) s.max_us = d;
+                fprintf(f, ",\n{\"name\":\"%s\",\"ph\":\"E\",\"ts\":%llu,\"pid\":0,\"tid\":%d}", name.c_str(),
+                        static_cast<unsigned long long>(ts), tid);
+                break;
+            }
+            case TracePhase::Instant:
+                spans[r.event].count++;
+                fprintf(f, ",\n{\"name\":\"%s\",\"ph\":\"i\",\"s\":\"t\",\"ts\":%llu,\"pid\":0,\"tid\":%d,\"args\":{\"arg\":%u}}",
+                        name.c_str(), static_cast<unsigned long long>(ts), tid, r.arg);
+                break;
+            case TracePhase::Counter:
+                spans[r.event].count++;
+                fprintf(f, ",\n{\"name\":\"%s\",\"ph\":\"C\",\"ts\":%llu,\"pid\":0,\"tid\":%d,\"args\":{\"value\":%u}}",
+                        name.c_str(), static_cast<unsigned long long>(ts), tid, r.arg);
+                break;
+            default:
+                unmatched++;
+                break;
+            }
+        }
+    }
+    fprintf(f, "\n]}\n");
+
+    for (size_t c = 0; c < dump.cores.size(); c++) {
+        const Core& core = dump.cores[c];
+        fprintf(stderr, "core %zu: %zu records, %u dropped", c, core.records.size(), core.dropped);
+        if (!core.records.empty()) {
+            fprintf(stderr, ", %.1f ms",
+                    (unwrap(core.records.back().timestamp_us) - unwrap(core.records.front().timestamp_us)) / 1000.0);
+        }
+        fprintf(stderr, "\n");
+    }
+    for (const auto& [id, s] : spans) {
+        fprintf(stderr, "  %-20s %7u", eventName(dump, id).c_str(), s.count);
+        if (s.total_us > 0 || s.max_us > 0) {
+            fprintf(stderr, "  avg %8.1f us  max %8llu us", static_cast<double>(s.total_us) / s.count,
+                    static_cast<unsigned long long>(s.max_us));
+        }
+        fprintf(stderr, "\n");
+    }
+    if (unmatched) fprintf(stderr, "  %u unmatched or unknown records skipped\n", unmatched);
+    return fclose(f) == 0;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        fprintf(stderr, "usage: %s <tty|dump file> [out.json] [--request chars] [--wait] [--timeout seconds]\n", argv[0]);
+        return 1;
+    }
+    const char* in_path = argv[1];
+    const char* out_path = "trace.json";
+    const char* request = "t";
+    double timeout_s = 5.0;
+    for (int i = 2; i < argc; i++) {
+        if (strcmp(argv[i], "--request") == 0 && i + 1 < argc) {
+            request = argv[++i];
+        } else if (strcmp(argv[i], "--wait") == 0) {
+            request = "";
+        } else if (strcmp(argv[i], "--timeout") == 0 && i + 1 < argc) {
+            timeout_s = atof(argv[++i]);
+        } else {
+            out_path = argv[i];
+        }
+    }
+
+    int fd = open(in_path, O_RDONLY);
+    if (fd < 0) {
+        perror("open");
+        return 1;
+    }
+    const bool serial = isatty(fd);
+    if (serial) {
+        close(fd);
+        fd = openSerial(in_path);
+        if (fd < 0) return 1;
+        const size_t len = strlen(request);
+        if (len > 0 && write(fd, request, len) != static_cast<ssize_t>(len)) {
+            perror("write");
+            return 1;
+        }
+    }
+
+    std::vector<uint8_t> in;
+    Dump dump;
+    size_t skipped = 0;
+    bool done = false;
+    bool eof = false;
+    const uint64_t deadline = nowUs() + static_cast<uint64_t>(timeout_s * 1e6);
+    while (!done && !eof && (!serial || nowUs() < deadline)) {
+        if (serial) {
+            pollfd pfd{fd, POLLIN, 0};
+            if (poll(&pfd, 1, 50) <= 0) continue;
+        }
+        uint8_t buf[4096];
+        const ssize_t n = read(fd, buf, sizeof(buf));
+        if (n < 0 || (n == 0 && !serial)) {
+            eof = true;
+        } else {
+            in.insert(in.end(), buf, buf + n);
+        }
+        done = findDump(in, dump, skipped) == Parse::Ok;
+    }
+    close(fd);
+
+    if (!done) {
+        fprintf(stderr, "%s (no complete trace dump; was the firmware built with -DST73XX_TRACE=ON?)\n",
+                eof ? "end of input" : "timed out");
+        return 1;
+    }
+    if (skipped) fprintf(stderr, "skipped %zu bytes of other output\n", skipped);
+    if (!writeJson(out_path, dump)) {
+        perror(out_path);
+        return 1;
+    }
+    fprintf(stderr, "wrote %s\n", out_path);
+    return 0;
+}